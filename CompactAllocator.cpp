@@ -0,0 +1,386 @@
+#include "CompactAllocator.h"
+#include "PadKernels.h"
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+
+namespace
+{
+  // the end of a free list in 16-bit links
+  const uint16_t NO_INDEX16 = 0xFFFF;
+}
+
+/*****************************************************************************/
+/*!
+  \brief
+    Creates the allocator and its first page
+    Throws an exception if the construction fails.
+    (Memory allocation problem)
+
+  \param ObjectSize
+    Size of the objects that are in the blocks (any size, even 1)
+
+  \param config
+    the configuration of the pages (see the class)
+*/
+/*****************************************************************************/
+CompactAllocator::CompactAllocator(size_t ObjectSize, const OAConfig& config) : clientConfig(config)
+{
+  if (!clientConfig.PageSource_)
+  {
+    clientConfig.PageSource_ = &PageSource::Heap();
+  }
+  if (!clientConfig.ObjectsPerPage_)
+  {
+    clientConfig.ObjectsPerPage_ = 1;
+  }
+
+  // a 16-bit link can name every block but one, which ends the list
+  indexBytes = clientConfig.ObjectsPerPage_ < NO_INDEX16 ? 2 : 4;
+  blockSize = std::max(ObjectSize, static_cast<size_t>(indexBytes));
+
+  stats.ObjectSize_ = ObjectSize;
+  stats.PageCapacity_ = clientConfig.ObjectsPerPage_;
+  stats.PageSize_ = blockSize * clientConfig.ObjectsPerPage_;
+  allocate_new_page();
+}
+
+/*****************************************************************************/
+/*!
+  \brief
+    Destroys the allocator and gives back every page (never throws)
+*/
+/*****************************************************************************/
+CompactAllocator::~CompactAllocator()
+{
+  for (size_t i = 0; i < pages.size(); i++)
+  {
+    release_page(pages[i]);
+  }
+}
+
+/*****************************************************************************/
+/*!
+  \brief
+    Takes a block from the page that was freed into last (or the newest
+    page), off its free list or, once that's empty, the next block that
+    hasn't been carved yet
+    Throws an exception if the object can't be allocated.
+    (Memory allocation problem)
+
+  \return
+    a pointer to the data allocated
+*/
+/*****************************************************************************/
+void *CompactAllocator::Allocate(void)
+{
+  if (partial.empty())
+  {
+    allocate_new_page();
+  }
+
+  CompactPage *page = partial.back();
+  unsigned index = page->freeHead;
+  if (index != NO_INDEX)
+  {
+    page->freeHead = read_index(page->blocks + index * blockSize);
+  }
+  else
+  {
+    index = page->carved++;
+  }
+
+  // a full page leaves the list until something on it is freed
+  if (--page->freeCount == 0)
+  {
+    page->partial = false;
+    partial.pop_back();
+  }
+
+  char *block = page->blocks + index * blockSize;
+  if (clientConfig.DebugOn_)
+  {
+    page->freeMap[index / 64] &= ~(1ULL << (index % 64));
+    PadKernels::Fill(block, stats.ObjectSize_, ObjectAllocator::ALLOCATED_PATTERN);
+  }
+
+  stats.FreeObjects_--;
+  stats.ObjectsInUse_++;
+  stats.Allocations_++;
+  if (stats.ObjectsInUse_ > stats.MostObjects_)
+  {
+    stats.MostObjects_ = stats.ObjectsInUse_;
+  }
+  return block;
+}
+
+/*****************************************************************************/
+/*!
+  \brief
+    Returns an object to its page's free list. A page that was full goes
+    back on the list of pages to allocate from, at the end, so the next
+    Allocate reuses the block while it's still in cache.
+    Throws an exception if the object can't be freed. (Invalid object: not
+    on a page, and with DebugOn_ not on a block boundary or already free)
+
+  \param Object
+    Indicates which object to free
+*/
+/*****************************************************************************/
+void CompactAllocator::Free(void *Object)
+{
+  char *block = static_cast<char *>(Object);
+  CompactPage *page = find_page(block);
+
+  if (!page)
+  {
+    throw OAException(OAException::E_BAD_BOUNDARY, "Not freed inside a page");
+  }
+
+  size_t offset = static_cast<size_t>(block - page->blocks);
+  unsigned index = static_cast<unsigned>(offset / blockSize);
+  if (clientConfig.DebugOn_)
+  {
+    if (offset % blockSize)
+    {
+      throw OAException(OAException::E_BAD_BOUNDARY, "Not freed on a block boundary");
+    }
+
+    unsigned long long &word = page->freeMap[index / 64];
+    unsigned long long bit = 1ULL << (index % 64);
+    if (word & bit)
+    {
+      throw OAException(OAException::E_MULTIPLE_FREE, "Freed multiple times");
+    }
+    word |= bit;
+    PadKernels::Fill(block, stats.ObjectSize_, ObjectAllocator::FREED_PATTERN);
+  }
+
+  write_index(block, page->freeHead);
+  page->freeHead = index;
+  if (page->freeCount++ == 0)
+  {
+    page->partial = true;
+    partial.push_back(page);
+  }
+
+  stats.FreeObjects_++;
+  stats.ObjectsInUse_--;
+  stats.Deallocations_++;
+}
+
+/*****************************************************************************/
+/*!
+  \brief
+    Calls the callback fn for each block still in use. With no headers to
+    read, each page's free list is walked to find the blocks that aren't
+    in use.
+
+  \param fn
+    the function to call
+
+  \return
+    how many blocks are still in use
+*/
+/*****************************************************************************/
+unsigned CompactAllocator::DumpMemoryInUse(ObjectAllocator::DUMPCALLBACK fn) const
+{
+  unsigned inUse = 0;
+  std::vector<bool> isFree;
+
+  for (size_t i = 0; i < pages.size(); i++)
+  {
+    const CompactPage *page = pages[i];
+    isFree.assign(page->carved, false);
+    for (unsigned index = page->freeHead; index != NO_INDEX; index = read_index(page->blocks + index * blockSize))
+    {
+      isFree[index] = true;
+    }
+
+    for (unsigned index = 0; index < page->carved; index++)
+    {
+      if (!isFree[index])
+      {
+        fn(page->blocks + index * blockSize, stats.ObjectSize_);
+        inUse++;
+      }
+    }
+  }
+  return inUse;
+}
+
+/*****************************************************************************/
+/*!
+  \brief
+    Frees all empty pages
+
+  \return
+    how many pages were freed
+*/
+/*****************************************************************************/
+unsigned CompactAllocator::FreeEmptyPages(void)
+{
+  unsigned freed = 0;
+  std::vector<CompactPage *>::iterator kept = pages.begin();
+
+  for (size_t i = 0; i < pages.size(); i++)
+  {
+    CompactPage *page = pages[i];
+    if (page->freeCount == clientConfig.ObjectsPerPage_)
+    {
+      if (page->partial)
+      {
+        partial.erase(std::find(partial.begin(), partial.end(), page));
+      }
+      release_page(page);
+      stats.FreeObjects_ -= clientConfig.ObjectsPerPage_;
+      stats.PagesInUse_--;
+      freed++;
+    }
+    else
+    {
+      *kept++ = page;
+    }
+  }
+  pages.erase(kept, pages.end());
+  return freed;
+}
+
+  // bytes between blocks (the object size, or the index width)
+size_t CompactAllocator::BlockSize(void) const
+{
+  return blockSize;
+}
+
+  // bytes of the free list links (2 or 4)
+unsigned CompactAllocator::IndexBytes(void) const
+{
+  return indexBytes;
+}
+
+  // returns the configuration parameters
+OAConfig CompactAllocator::GetConfig(void) const
+{
+  return clientConfig;
+}
+
+  // returns the statistics for the allocator
+OAStats CompactAllocator::GetStats(void) const
+{
+  return stats;
+}
+
+/*****************************************************************************/
+/*
+  HELPER FUNCTIONS
+*/
+/*****************************************************************************/
+void CompactAllocator::allocate_new_page(void)
+{
+  if (clientConfig.MaxPages_ && stats.PagesInUse_ >= clientConfig.MaxPages_)
+  {
+    throw OAException(OAException::E_NO_PAGES, "Out of pages");
+  }
+
+  size_t size = blockSize * clientConfig.ObjectsPerPage_;
+  char *memory = static_cast<char *>(clientConfig.PageSource_->AllocatePage(size));
+  if (!memory)
+  {
+    throw OAException(OAException::E_NO_MEMORY, "out of memory");
+  }
+
+  CompactPage *page;
+  try
+  {
+    page = new CompactPage;
+    page->blocks = memory;
+    page->size = size;
+    page->freeHead = NO_INDEX;
+    page->freeCount = clientConfig.ObjectsPerPage_;
+    page->carved = 0;
+    page->partial = true;
+    if (clientConfig.DebugOn_)
+    {
+      // every block starts out free, the bits past the last block are never read
+      page->freeMap.assign((clientConfig.ObjectsPerPage_ + 63) / 64, ~0ULL);
+      PadKernels::Fill(memory, size, ObjectAllocator::UNALLOCATED_PATTERN);
+    }
+
+    partial.push_back(page);
+    try
+    {
+      pages.insert(std::upper_bound(pages.begin(), pages.end(), memory, page_starts_after), page);
+    }
+    catch (std::bad_alloc &)
+    {
+      partial.pop_back();
+      delete page;
+      throw;
+    }
+  }
+  catch (std::bad_alloc &)
+  {
+    clientConfig.PageSource_->FreePage(memory, size);
+    throw OAException(OAException::E_NO_MEMORY, "out of memory");
+  }
+
+  stats.PagesInUse_++;
+  stats.FreeObjects_ += clientConfig.ObjectsPerPage_;
+}
+
+CompactPage *CompactAllocator::find_page(const char *block) const
+{
+  // the page before the first one that starts after the block
+  std::vector<CompactPage *>::const_iterator next =
+    std::upper_bound(pages.begin(), pages.end(), block, page_starts_after);
+
+  if (next == pages.begin())
+  {
+    return 0;
+  }
+
+  CompactPage *page = *(next - 1);
+  if (block < page->blocks + page->size)
+  {
+    return page;
+  }
+  return 0;
+}
+
+unsigned CompactAllocator::read_index(const char *block) const
+{
+  if (indexBytes == 2)
+  {
+    uint16_t index;
+    std::memcpy(&index, block, sizeof(index));
+    return index == NO_INDEX16 ? NO_INDEX : index;
+  }
+
+  uint32_t index;
+  std::memcpy(&index, block, sizeof(index));
+  return index;
+}
+
+void CompactAllocator::write_index(char *block, unsigned index) const
+{
+  if (indexBytes == 2)
+  {
+    uint16_t narrow = index == NO_INDEX ? NO_INDEX16 : static_cast<uint16_t>(index);
+    std::memcpy(block, &narrow, sizeof(narrow));
+    return;
+  }
+
+  uint32_t wide = index;
+  std::memcpy(block, &wide, sizeof(wide));
+}
+
+void CompactAllocator::release_page(CompactPage *page)
+{
+  clientConfig.PageSource_->FreePage(page->blocks, page->size);
+  delete page;
+}
+
+bool CompactAllocator::page_starts_after(const char *block, const CompactPage *page)
+{
+  return block < page->blocks;
+}
@@ -0,0 +1,89 @@
+//---------------------------------------------------------------------------
+#ifndef COMPACTALLOCATORH
+#define COMPACTALLOCATORH
+//---------------------------------------------------------------------------
+
+#include "ObjectAllocator.h"
+#include "PageSource.h"
+#include <vector>
+
+// A page of a CompactAllocator, kept in the side table rather than on the page
+struct CompactPage
+{
+  char *blocks;            // the first block (the page has nothing else on it)
+  size_t size;             // how many bytes were asked of the page source
+  unsigned freeHead;       // index of the first block on the page's free list (NO_INDEX=none)
+  unsigned freeCount;      // free blocks, counting the ones not carved yet
+  unsigned carved;         // blocks handed out at least once, the rest are free in order
+  bool partial;            // in the list of pages Allocate takes blocks from
+  std::vector<unsigned long long> freeMap; // one bit per block, set while it's free (DebugOn_)
+};
+
+// An allocator for objects too small to carry a pointer (handles, ids,
+// small structs). A free block holds the in-page index of the next free
+// block, 16 bits wide when a page has fewer than 65535 blocks and 32 bits
+// otherwise, so a block only has to be as big as that index. Pages are
+// nothing but blocks, their next links, free lists and counts live in a
+// side table of CompactPage, sorted by address for Free to search.
+//
+// The config's ObjectsPerPage_, MaxPages_ (0=unlimited), DebugOn_ and
+// PageSource_ are used; there are no headers, pads or alignment bytes. A
+// page's blocks are carved off in order as they are first needed, so a
+// fresh page isn't touched until it's used. With DebugOn_ each page keeps
+// a free bit per block so Free can catch double frees.
+class CompactAllocator
+{
+  public:
+    static const unsigned NO_INDEX = ~0u;
+
+      // Creates the allocator and its first page
+      // Throws an exception if the construction fails. (Memory allocation problem)
+    CompactAllocator(size_t ObjectSize, const OAConfig& config);
+
+      // Destroys the allocator and gives back every page (never throws)
+    ~CompactAllocator();
+
+      // Takes a block from the page that was freed into last
+      // Throws an exception if the object can't be allocated. (Memory allocation problem)
+    void *Allocate(void);
+
+      // Returns an object to its page's free list
+      // Throws an exception if the the object can't be freed. (Invalid object, DebugOn_)
+    void Free(void *Object);
+
+      // Calls the callback fn for each block still in use
+    unsigned DumpMemoryInUse(ObjectAllocator::DUMPCALLBACK fn) const;
+
+      // Frees all empty pages
+    unsigned FreeEmptyPages(void);
+
+      // Testing/Debugging/Statistic methods
+    size_t BlockSize(void) const;     // bytes between blocks (the object size, or the index width)
+    unsigned IndexBytes(void) const;  // bytes of the free list links (2 or 4)
+    OAConfig GetConfig(void) const;   // returns the configuration parameters
+    OAStats GetStats(void) const;     // returns the statistics for the allocator
+
+  private:
+    void allocate_new_page(void);       //!< adds a page and makes it the one to allocate from
+    CompactPage *find_page              //!< finds the page a block lives on (0 if none)
+    (const char *block) const;
+    unsigned read_index                 //!< reads the free list link of a block
+    (const char *block) const;
+    void write_index                    //!< writes the free list link of a block
+    (char *block, unsigned index) const;
+    void release_page(CompactPage *page); //!< gives a page back to the page source
+    static bool page_starts_after       //!< orders the side table by address
+    (const char *block, const CompactPage *page);
+    std::vector<CompactPage *> pages;   // every page, sorted by address
+    std::vector<CompactPage *> partial; // pages with free blocks, the last is allocated from
+    OAConfig clientConfig;              // the configuration (PageSource_ always set)
+    OAStats stats;                      // stats for debug purposes
+    size_t blockSize;                   // see BlockSize
+    unsigned indexBytes;                // see IndexBytes
+
+      // Make private to prevent copy construction and assignment
+    CompactAllocator(const CompactAllocator &ca);
+    CompactAllocator &operator=(const CompactAllocator &ca);
+};
+
+#endif
@@ -0,0 +1,328 @@
+#include "NumaAllocator.h"
+
+namespace
+{
+  // threads seldom move between sockets, so the node is only asked for
+  // again after this many calls
+  const unsigned NODE_REFRESH = 256;
+
+  // the calling thread's node, as last asked for
+  struct LocalNodeCache
+  {
+    LocalNodeCache(void) : node(0), calls(0) {};
+
+    unsigned node;
+    unsigned calls;
+  };
+
+  thread_local LocalNodeCache localNode;
+}
+
+/*****************************************************************************/
+/*!
+  \brief
+    Creates an ObjectAllocator for each node, each getting its pages from
+    a NumaPageSource bound to the node
+    Throws an exception if the construction fails.
+    (Memory allocation problem)
+
+  \param ObjectSize
+    Size of the objects that are in the blocks
+
+  \param config
+    the configuration of the blocks for every node (PageSource_ is ignored)
+
+  \param Nodes
+    how many page pools to make (0=NumaPageSource::NodeCount())
+*/
+/*****************************************************************************/
+NumaAllocator::NumaAllocator(size_t ObjectSize, const OAConfig& config, unsigned Nodes)
+  : remoteFrees(0), cppMemManager(config.UseCPPMemManager_),
+    deferRemote(!config.DebugOn_ && !config.UseCPPMemManager_)
+{
+  unsigned count = Nodes ? Nodes : NumaPageSource::NodeCount();
+
+  try
+  {
+    for (unsigned i = 0; i < count; i++)
+    {
+      nodes.push_back(0);
+      nodes.back() = new NumaNode(i);
+
+      OAConfig nodeConfig = config;
+      nodeConfig.PageSource_ = &nodes.back()->source;
+      nodes.back()->allocator = new ObjectAllocator(ObjectSize, nodeConfig);
+    }
+  }
+  catch (...)
+  {
+    // the destructor won't run, so give back the nodes made so far
+    for (size_t i = 0; i < nodes.size(); i++)
+    {
+      delete nodes[i]->allocator;
+      delete nodes[i];
+    }
+    throw;
+  }
+}
+
+/*****************************************************************************/
+/*!
+  \brief
+    Destroys every node's ObjectAllocator (never throws)
+*/
+/*****************************************************************************/
+NumaAllocator::~NumaAllocator()
+{
+  for (size_t i = 0; i < nodes.size(); i++)
+  {
+    delete nodes[i]->allocator;
+    delete nodes[i];
+  }
+}
+
+/*****************************************************************************/
+/*!
+  \brief
+    Allocates from the calling thread's node
+    Throws an exception if the object can't be allocated.
+    (Memory allocation problem)
+
+  \param label
+    the label for the header-block, if any
+
+  \return
+    a pointer to the data allocated
+*/
+/*****************************************************************************/
+void *NumaAllocator::Allocate(const char *label)
+{
+  return AllocateOn(LocalNode(), label);
+}
+
+/*****************************************************************************/
+/*!
+  \brief
+    Allocates from a particular node's pool
+    Throws an exception if the object can't be allocated.
+    (Memory allocation problem)
+
+  \param Node
+    which node's pool to take the block from
+
+  \param label
+    the label for the header-block, if any
+
+  \return
+    a pointer to the data allocated
+*/
+/*****************************************************************************/
+void *NumaAllocator::AllocateOn(unsigned Node, const char *label)
+{
+  NumaNode *node = nodes[Node % nodes.size()];
+  std::lock_guard<std::mutex> guard(node->lock);
+  return node->allocator->Allocate(label);
+}
+
+/*****************************************************************************/
+/*!
+  \brief
+    Returns an object to the node it was allocated from. A block from
+    another node is queued on that node's allocator with FreeDeferred, so
+    its lock isn't taken and the owner frees the blocks in bulk on its next
+    Allocate. With DebugOn_ every block is freed under its node's lock so a
+    bad free throws from here; the local node is tried first then.
+    Throws an exception if the the object can't be freed. (Invalid object)
+
+  \param Object
+    Indicates which object to free
+*/
+/*****************************************************************************/
+void NumaAllocator::Free(void *Object)
+{
+  unsigned local = LocalNode();
+  unsigned owner = NumaPageSource::NodeOf(Object);
+
+  if (owner < nodes.size() && owner != local)
+  {
+    remoteFrees++;
+    if (deferRemote)
+    {
+      nodes[owner]->allocator->FreeDeferred(Object);
+      return;
+    }
+  }
+
+  if (!cppMemManager)
+  {
+    // the map only misses blocks on pages that didn't come from mmap
+    unsigned first = owner < nodes.size() ? owner : local;
+    for (unsigned i = 0; i < nodes.size(); i++)
+    {
+      unsigned index = static_cast<unsigned>((first + i) % nodes.size());
+      NumaNode *node = nodes[index];
+      std::lock_guard<std::mutex> guard(node->lock);
+
+      if (node->allocator->Owns(Object))
+      {
+        if (index != local && index != owner)
+        {
+          remoteFrees++;
+        }
+        node->allocator->Free(Object);
+        return;
+      }
+    }
+  }
+
+  // no node owns it, so the local allocator decides what's wrong with it
+  NumaNode *node = nodes[local];
+  std::lock_guard<std::mutex> guard(node->lock);
+  node->allocator->Free(Object);
+}
+
+/*****************************************************************************/
+/*!
+  \brief
+    Calls the callback fn for each block still in use on every node
+
+  \param fn
+    the function to call
+
+  \return
+    how many blocks are still in use
+*/
+/*****************************************************************************/
+unsigned NumaAllocator::DumpMemoryInUse(ObjectAllocator::DUMPCALLBACK fn) const
+{
+  unsigned inUse = 0;
+  for (size_t i = 0; i < nodes.size(); i++)
+  {
+    std::lock_guard<std::mutex> guard(nodes[i]->lock);
+    inUse += nodes[i]->allocator->DumpMemoryInUse(fn);
+  }
+  return inUse;
+}
+
+/*****************************************************************************/
+/*!
+  \brief
+    Calls the callback fn for each block that is potentially corrupted on
+    every node
+
+  \param fn
+    the function to call
+
+  \return
+    how many blocks are corrupted
+*/
+/*****************************************************************************/
+unsigned NumaAllocator::ValidatePages(ObjectAllocator::VALIDATECALLBACK fn) const
+{
+  unsigned corrupted = 0;
+  for (size_t i = 0; i < nodes.size(); i++)
+  {
+    std::lock_guard<std::mutex> guard(nodes[i]->lock);
+    corrupted += nodes[i]->allocator->ValidatePages(fn);
+  }
+  return corrupted;
+}
+
+/*****************************************************************************/
+/*!
+  \brief
+    Frees all empty pages of every node
+
+  \return
+    how many pages were freed
+*/
+/*****************************************************************************/
+unsigned NumaAllocator::FreeEmptyPages(void)
+{
+  unsigned freed = 0;
+  for (size_t i = 0; i < nodes.size(); i++)
+  {
+    std::lock_guard<std::mutex> guard(nodes[i]->lock);
+    freed += nodes[i]->allocator->FreeEmptyPages();
+  }
+  return freed;
+}
+
+  // number of nodes (page pools)
+unsigned NumaAllocator::NodeCount(void) const
+{
+  return static_cast<unsigned>(nodes.size());
+}
+
+  // the calling thread's node (pools past the last one wrap around)
+unsigned NumaAllocator::LocalNode(void) const
+{
+  if (localNode.calls++ % NODE_REFRESH == 0)
+  {
+    localNode.node = NumaPageSource::CurrentNode();
+  }
+  return static_cast<unsigned>(localNode.node % nodes.size());
+}
+
+  // the node a block is on (NodeCount if none)
+unsigned NumaAllocator::NodeOf(const void *Object) const
+{
+  for (size_t i = 0; i < nodes.size(); i++)
+  {
+    std::lock_guard<std::mutex> guard(nodes[i]->lock);
+    if (nodes[i]->allocator->Owns(Object))
+    {
+      return static_cast<unsigned>(i);
+    }
+  }
+  return NodeCount();
+}
+
+  // frees that went to another node's pool
+unsigned NumaAllocator::RemoteFrees(void) const
+{
+  return remoteFrees.load();
+}
+
+  // the allocator of a node
+const ObjectAllocator *NumaAllocator::GetNodeAllocator(unsigned Node) const
+{
+  return nodes[Node]->allocator;
+}
+
+  // returns the configuration parameters (of the first node)
+OAConfig NumaAllocator::GetConfig(void) const
+{
+  return nodes[0]->allocator->GetConfig();
+}
+
+/*****************************************************************************/
+/*!
+  \brief
+    Sums the statistics of every node. ObjectSize_, PageSize_ and
+    PageCapacity_ are the same for every node and are not summed.
+
+  \return
+    the combined statistics
+*/
+/*****************************************************************************/
+OAStats NumaAllocator::GetStats(void) const
+{
+  OAStats total;
+
+  for (size_t i = 0; i < nodes.size(); i++)
+  {
+    std::lock_guard<std::mutex> guard(nodes[i]->lock);
+    OAStats stats = nodes[i]->allocator->GetStats();
+    total.ObjectSize_ = stats.ObjectSize_;
+    total.PageSize_ = stats.PageSize_;
+    total.PageCapacity_ = stats.PageCapacity_;
+    total.FreeObjects_ += stats.FreeObjects_;
+    total.ObjectsInUse_ += stats.ObjectsInUse_;
+    total.PagesInUse_ += stats.PagesInUse_;
+    total.MostObjects_ += stats.MostObjects_;
+    total.Allocations_ += stats.Allocations_;
+    total.Deallocations_ += stats.Deallocations_;
+  }
+  return total;
+}
@@ -0,0 +1,84 @@
+//---------------------------------------------------------------------------
+#ifndef NUMAALLOCATORH
+#define NUMAALLOCATORH
+//---------------------------------------------------------------------------
+
+#include "ObjectAllocator.h"
+#include "PageSource.h"
+#include <atomic>
+#include <mutex>
+#include <vector>
+
+// One node's page pool: an ObjectAllocator whose pages are bound to the node
+struct NumaNode
+{
+  NumaNode(unsigned node) : source(node), allocator(0) {};
+
+  NumaPageSource source;      // maps the pages bound to the node
+  ObjectAllocator *allocator; // the blocks on those pages (guarded by lock)
+  std::mutex lock;            // guards allocator
+};
+
+// A thread-safe allocator with one page pool per NUMA node, so the blocks
+// a thread allocates, and the free list links it walks, are in the memory
+// next to the socket it runs on. Allocate serves the calling thread from
+// its node's pool. Free gives a block back to the pool it came from, which
+// is the local one unless the block was handed across sockets. Such a
+// remote block is queued on its owner (see ObjectAllocator::FreeDeferred)
+// rather than freed under the owner's lock, unless DebugOn_ is set.
+//
+// Every node's allocator gets the same config except PageSource_, which is
+// always the node's NumaPageSource, so MaxPages_ limits each node rather
+// than the whole allocator.
+class NumaAllocator
+{
+  public:
+      // Creates an ObjectAllocator for each node (0=as many as the machine has)
+      // Throws an exception if the construction fails. (Memory allocation problem)
+    NumaAllocator(size_t ObjectSize, const OAConfig& config, unsigned Nodes = 0);
+
+      // Destroys every node's ObjectAllocator (never throws)
+    ~NumaAllocator();
+
+      // Allocates from the calling thread's node
+      // Throws an exception if the object can't be allocated. (Memory allocation problem)
+    void *Allocate(const char *label = 0);
+
+      // Allocates from a particular node
+      // Throws an exception if the object can't be allocated. (Memory allocation problem)
+    void *AllocateOn(unsigned Node, const char *label = 0);
+
+      // Returns an object to the node it was allocated from
+      // Throws an exception if the the object can't be freed. (Invalid object)
+    void Free(void *Object);
+
+      // Calls the callback fn for each block still in use on every node
+    unsigned DumpMemoryInUse(ObjectAllocator::DUMPCALLBACK fn) const;
+
+      // Calls the callback fn for each block that is potentially corrupted on every node
+    unsigned ValidatePages(ObjectAllocator::VALIDATECALLBACK fn) const;
+
+      // Frees all empty pages of every node
+    unsigned FreeEmptyPages(void);
+
+      // Testing/Debugging/Statistic methods
+    unsigned NodeCount(void) const;                 // number of nodes (page pools)
+    unsigned LocalNode(void) const;                 // the calling thread's node
+    unsigned NodeOf(const void *Object) const;      // the node a block is on (NodeCount if none)
+    unsigned RemoteFrees(void) const;               // frees that went to another node's pool
+    const ObjectAllocator *GetNodeAllocator(unsigned Node) const; // the allocator of a node
+    OAConfig GetConfig(void) const;                 // returns the configuration parameters
+    OAStats GetStats(void) const;                   // the statistics summed over every node
+
+  private:
+    std::vector<NumaNode *> nodes;       // every node's pool
+    std::atomic<unsigned> remoteFrees;   // see RemoteFrees
+    bool cppMemManager;                  // blocks come from new, so no node owns them
+    bool deferRemote;                    // queue remote frees instead of taking the owner's lock
+
+      // Make private to prevent copy construction and assignment
+    NumaAllocator(const NumaAllocator &na);
+    NumaAllocator &operator=(const NumaAllocator &na);
+};
+
+#endif
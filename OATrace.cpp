@@ -0,0 +1,307 @@
+#include "OATrace.h"
+#include <cstring>
+
+namespace
+{
+  const char TRACE_MAGIC[] = "OATRACE1";
+  const size_t MAGIC_LENGTH = 8;
+
+  // the buffer is written out once it holds this much
+  const size_t FLUSH_SIZE = 64 * 1024;
+
+  // set in an Allocate's type when a label number follows
+  const unsigned char HAS_LABEL = 0x80;
+}
+
+/*****************************************************************************/
+/*
+  OATraceWriter
+*/
+/*****************************************************************************/
+OATraceWriter::OATraceWriter(const char *Path)
+  : file(std::fopen(Path, "wb")), nextId(0), events(0), begun(false)
+{
+  buffer.reserve(FLUSH_SIZE + 64);
+}
+
+OATraceWriter::~OATraceWriter()
+{
+  Flush();
+  if (file)
+  {
+    std::fclose(file);
+  }
+}
+
+  // false if the file couldn't be created or written
+bool OATraceWriter::IsOpen(void) const
+{
+  std::lock_guard<std::mutex> guard(lock);
+  return file != 0;
+}
+
+  // writes the header (only the first call counts)
+void OATraceWriter::Begin(size_t ObjectSize)
+{
+  std::lock_guard<std::mutex> guard(lock);
+  if (begun)
+  {
+    return;
+  }
+  begun = true;
+  buffer.insert(buffer.end(), TRACE_MAGIC, TRACE_MAGIC + MAGIC_LENGTH);
+  put_varint(ObjectSize);
+}
+
+  // records that block was handed out (with label, if not 0)
+void OATraceWriter::RecordAllocate(const void *block, const char *label)
+{
+  std::lock_guard<std::mutex> guard(lock);
+
+  unsigned id = nextId;
+  if (freeIds.empty())
+  {
+    nextId++;
+  }
+  else
+  {
+    id = freeIds.back();
+    freeIds.pop_back();
+  }
+  ids[block] = id;
+
+  // a label's text goes in the trace the first time, its number after that
+  unsigned number = 0;
+  if (label)
+  {
+    std::unordered_map<std::string, unsigned>::iterator known = labels.find(label);
+    if (known == labels.end())
+    {
+      size_t length = std::strlen(label);
+      number = static_cast<unsigned>(labels.size());
+      labels[label] = number;
+      buffer.push_back(teLabel);
+      put_varint(length);
+      buffer.insert(buffer.end(), label, label + length);
+    }
+    else
+    {
+      number = known->second;
+    }
+  }
+
+  buffer.push_back(static_cast<unsigned char>(label ? teAllocate | HAS_LABEL : teAllocate));
+  put_varint(id);
+  if (label)
+  {
+    put_varint(number);
+  }
+
+  events++;
+  if (buffer.size() >= FLUSH_SIZE)
+  {
+    write_out();
+  }
+}
+
+  // records that block is being freed (blocks it never saw allocated are skipped)
+void OATraceWriter::RecordFree(const void *block)
+{
+  std::lock_guard<std::mutex> guard(lock);
+
+  std::unordered_map<const void *, unsigned>::iterator live = ids.find(block);
+  if (live == ids.end())
+  {
+    return;
+  }
+
+  buffer.push_back(teFree);
+  put_varint(live->second);
+  freeIds.push_back(live->second);
+  ids.erase(live);
+
+  events++;
+  if (buffer.size() >= FLUSH_SIZE)
+  {
+    write_out();
+  }
+}
+
+  // records that every block was taken back at once
+void OATraceWriter::RecordReleaseAll(void)
+{
+  std::lock_guard<std::mutex> guard(lock);
+
+  buffer.push_back(teReleaseAll);
+  ids.clear();
+  freeIds.clear();
+  nextId = 0;
+  events++;
+}
+
+  // writes the buffer to the file
+void OATraceWriter::Flush(void)
+{
+  std::lock_guard<std::mutex> guard(lock);
+  write_out();
+  if (file)
+  {
+    std::fflush(file);
+  }
+}
+
+  // number of events written (not counting labels)
+unsigned long long OATraceWriter::Events(void) const
+{
+  std::lock_guard<std::mutex> guard(lock);
+  return events;
+}
+
+void OATraceWriter::put_varint(unsigned long long value)
+{
+  while (value >= 0x80)
+  {
+    buffer.push_back(static_cast<unsigned char>(value | 0x80));
+    value >>= 7;
+  }
+  buffer.push_back(static_cast<unsigned char>(value));
+}
+
+void OATraceWriter::write_out(void)
+{
+  if (file && !buffer.empty() && std::fwrite(&buffer[0], 1, buffer.size(), file) != buffer.size())
+  {
+    // a trace with a hole in it can't be replayed, so stop writing
+    std::fclose(file);
+    file = 0;
+  }
+  buffer.clear();
+}
+
+/*****************************************************************************/
+/*
+  OATraceReader
+*/
+/*****************************************************************************/
+OATraceReader::OATraceReader(const char *Path)
+  : file(std::fopen(Path, "rb")), objectSize(0), idCount(0)
+{
+  char magic[MAGIC_LENGTH];
+  unsigned long long size = 0;
+
+  if (file && (std::fread(magic, 1, MAGIC_LENGTH, file) != MAGIC_LENGTH ||
+               std::memcmp(magic, TRACE_MAGIC, MAGIC_LENGTH) != 0 || !get_varint(size)))
+  {
+    std::fclose(file);
+    file = 0;
+  }
+  objectSize = static_cast<size_t>(size);
+}
+
+OATraceReader::~OATraceReader()
+{
+  if (file)
+  {
+    std::fclose(file);
+  }
+}
+
+  // false if the file couldn't be opened or isn't a trace
+bool OATraceReader::IsOpen(void) const
+{
+  return file != 0;
+}
+
+  // the object size of the allocator that was traced
+size_t OATraceReader::ObjectSize(void) const
+{
+  return objectSize;
+}
+
+  // the next Allocate, Free or ReleaseAll (false at the end, or if the trace is cut short)
+bool OATraceReader::Next(OATraceEvent &event)
+{
+  if (!file)
+  {
+    return false;
+  }
+
+  for (int type = std::fgetc(file); type != EOF; type = std::fgetc(file))
+  {
+    unsigned long long id, number;
+
+    switch (type & ~HAS_LABEL)
+    {
+      case teLabel:
+      {
+        unsigned long long length;
+        if (!get_varint(length))
+        {
+          return false;
+        }
+        std::string text(static_cast<size_t>(length), '\0');
+        if (length && std::fread(&text[0], 1, text.size(), file) != text.size())
+        {
+          return false;
+        }
+        labels.push_back(text);
+        continue;
+      }
+      case teReleaseAll:
+        event.type = teReleaseAll;
+        event.id = 0;
+        event.label = 0;
+        return true;
+      case teAllocate:
+      case teFree:
+        if (!get_varint(id))
+        {
+          return false;
+        }
+        event.type = static_cast<OATRACE_EVENT>(type & ~HAS_LABEL);
+        event.id = static_cast<unsigned>(id);
+        event.label = 0;
+        if (type & HAS_LABEL)
+        {
+          if (!get_varint(number) || number >= labels.size())
+          {
+            return false;
+          }
+          event.label = labels[static_cast<size_t>(number)].c_str();
+        }
+        if (event.id >= idCount)
+        {
+          idCount = event.id + 1;
+        }
+        return true;
+      default:
+        return false;
+    }
+  }
+  return false;
+}
+
+  // how many ids the trace uses at once at most (so far)
+unsigned OATraceReader::IdCount(void) const
+{
+  return idCount;
+}
+
+bool OATraceReader::get_varint(unsigned long long &value)
+{
+  value = 0;
+  for (unsigned shift = 0; shift < 64; shift += 7)
+  {
+    int byte = std::fgetc(file);
+    if (byte == EOF)
+    {
+      return false;
+    }
+    value |= static_cast<unsigned long long>(byte & 0x7F) << shift;
+    if (!(byte & 0x80))
+    {
+      return true;
+    }
+  }
+  return false;
+}
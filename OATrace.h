@@ -0,0 +1,119 @@
+//---------------------------------------------------------------------------
+#ifndef OATRACEH
+#define OATRACEH
+//---------------------------------------------------------------------------
+
+#include <cstddef>
+#include <cstdio>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// A trace is a binary log of one allocator's Allocate and Free calls:
+//
+//   "OATRACE1", the object size (varint), then events, each a type byte and
+//   varints (LEB128):  Allocate  id [label]    (the type has 0x80 set if
+//                      Free      id             a label follows)
+//                      Label     label length bytes
+//                      ReleaseAll               (every block is freed)
+//
+// Blocks are named by small ids handed out on Allocate and reused after
+// Free, so a replay can keep its live blocks in a vector. A label's text
+// is written once, the first time it's used.
+enum OATRACE_EVENT {teAllocate = 1, teFree = 2, teLabel = 3, teReleaseAll = 4};
+
+struct OATraceEvent
+{
+  OATRACE_EVENT type; // teAllocate, teFree or teReleaseAll (the reader handles the labels)
+  unsigned id;        // the block (not for teReleaseAll)
+  const char *label;  // the label it was allocated with, if any (owned by the reader)
+};
+
+// Writes a trace for ObjectAllocator::SetTrace. Every event is appended
+// under a lock (LockFree_ allocators record from many threads) to a
+// buffer that's written out every 64 KB and when the writer is destroyed.
+class OATraceWriter
+{
+  public:
+      // Creates (or truncates) the trace file
+    explicit OATraceWriter(const char *Path);
+
+      // Writes out whatever is buffered and closes the file (never throws)
+    ~OATraceWriter();
+
+      // false if the file couldn't be created or written
+    bool IsOpen(void) const;
+
+      // writes the header (done by SetTrace, only the first call counts)
+    void Begin(size_t ObjectSize);
+
+      // records that block was handed out (with label, if not 0)
+    void RecordAllocate(const void *block, const char *label);
+
+      // records that block is being freed (blocks it never saw allocated are skipped)
+    void RecordFree(const void *block);
+
+      // records that every block was taken back at once
+    void RecordReleaseAll(void);
+
+      // writes the buffer to the file
+    void Flush(void);
+
+      // number of events written (not counting labels)
+    unsigned long long Events(void) const;
+
+  private:
+    void put_varint(unsigned long long value); //!< appends a LEB128 value
+    void write_out(void);                      //!< writes the buffer (lock held)
+    std::FILE *file;                           // the trace (0 if it couldn't be opened)
+    std::vector<unsigned char> buffer;         // events not written yet
+    std::unordered_map<const void *, unsigned> ids; // live blocks by address
+    std::vector<unsigned> freeIds;             // ids of freed blocks, to reuse
+    unsigned nextId;                           // the next id never handed out
+    std::unordered_map<std::string, unsigned> labels; // labels written so far
+    unsigned long long events;                 // see Events
+    bool begun;                                // the header has been written
+    mutable std::mutex lock;                   // guards everything above
+
+      // Make private to prevent copy construction and assignment
+    OATraceWriter(const OATraceWriter &writer);
+    OATraceWriter &operator=(const OATraceWriter &writer);
+};
+
+// Reads a trace back, an event at a time
+class OATraceReader
+{
+  public:
+      // Opens the trace and reads its header
+    explicit OATraceReader(const char *Path);
+
+      // Closes the file (never throws)
+    ~OATraceReader();
+
+      // false if the file couldn't be opened or isn't a trace
+    bool IsOpen(void) const;
+
+      // the object size of the allocator that was traced
+    size_t ObjectSize(void) const;
+
+      // the next Allocate, Free or ReleaseAll (false at the end, or if the trace is cut short)
+    bool Next(OATraceEvent &event);
+
+      // how many ids the trace uses at once at most (so far)
+    unsigned IdCount(void) const;
+
+  private:
+    bool get_varint(unsigned long long &value); //!< reads a LEB128 value
+    std::FILE *file;                 // the trace (0 if it couldn't be opened)
+    size_t objectSize;               // from the header
+    std::deque<std::string> labels;  // every label defined so far, by number
+    unsigned idCount;                // see IdCount
+
+      // Make private to prevent copy construction and assignment
+    OATraceReader(const OATraceReader &reader);
+    OATraceReader &operator=(const OATraceReader &reader);
+};
+
+#endif
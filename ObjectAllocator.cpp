@@ -1,629 +1,2960 @@
-#include "ObjectAllocator.h"
-#include <string.h>
-#include <cstring>
-  
-/*****************************************************************************/
-/*!
-  \brief 
-    Creates the ObjectManager per the specified values
-    Throws an exception if the construction fails. 
-    (Memory allocation problem)
-
-  \param ObjectSize
-    Size of the objects that are in the blocks
-
-  \param config
-    the configuration of the blocks
-*/
-/*****************************************************************************/
-ObjectAllocator::ObjectAllocator(size_t ObjectSize, const OAConfig& config)
-{
-  clientConfig = config;
-  stats.ObjectSize_ = ObjectSize;
-  stats.PageSize_ = calculate_page_size();
-  PageList_ = nullptr;
-  FreeList_ = nullptr;
-  if (config.UseCPPMemManager_ == false)
-  {
-    allocate_new_page();
-  }
-}
-
-/*****************************************************************************/
-/*!
-  \brief
-    Destroys the ObjectManager (never throws)
-*/
-/*****************************************************************************/
-ObjectAllocator::~ObjectAllocator()
-{
-  while (PageList_)
-  {
-    GenericObject *toDelete = PageList_;
-    PageList_ = PageList_->Next;
-    delete[] toDelete;
-  }
-}
-
-/*****************************************************************************/
-/*!
-  \brief
-    Take an object from the free list and give it to the client (simulates new)
-    Throws an exception if the object can't be allocated. 
-    (Memory allocation problem)
-
-  \param label
-    Label that could be stored in a header
-
-  \return 
-    a pointer to the data allocated
-*/
-/*****************************************************************************/
-void *ObjectAllocator::Allocate(const char *label)
-{
-  if (clientConfig.UseCPPMemManager_ == false)
-  {
-    if (!FreeList_)
-    {
-      allocate_new_page();
-    }
-
-    return take_off_freelist(label);
-  }
-  
-  else
-  {
-    stats.Allocations_++;
-    stats.MostObjects_++;
-    try
-    {
-      return new char[stats.ObjectSize_];
-    }
-    catch (std::bad_alloc)
-    {
-      throw OAException(OAException::E_NO_MEMORY, "No Memory");
-    }
-  }
-}
-
-  
-/*****************************************************************************/
-/*!
-  \brief
-    Returns an object to the free list for the client (simulates delete)
-    Throws an exception if the the object can't be freed. (Invalid object)
-
-  \param Object 
-    Indicates which object to free
-*/
-/*****************************************************************************/
-void ObjectAllocator::Free(void *Object)
-{
-  if (clientConfig.UseCPPMemManager_ == false)
-  {
-    put_on_freelist(Object);
-  }
-  else
-  {
-    stats.Deallocations_++;
-    delete[] reinterpret_cast<char *>(Object);
-  }
-}
-
-/*****************************************************************************/
-/*!
-  \brief
-    Calls the callback fn for each block still in use
-
-  \param fn
-    function to dump the data in use
-
-  \return 
-    amount of objects in use
-*/
-/*****************************************************************************/
-unsigned ObjectAllocator::DumpMemoryInUse(DUMPCALLBACK fn) const
-{
-  GenericObject *pageListCopy = (PageList_);
-
-  int numObjects = 0;
-  
-  while (pageListCopy)
-  {
-    char *freeListCopy = create_offset(reinterpret_cast<char *>(pageListCopy));
-
-    for (unsigned i = 0; i < clientConfig.ObjectsPerPage_; i++)
-    {
-      if (clientConfig.HBlockInfo_.size_)
-      {
-        if (check_leak_in_header(freeListCopy))
-        {
-          fn(freeListCopy + clientConfig.HBlockInfo_.size_, stats.ObjectSize_);
-          numObjects++;
-        }
-      }
-      else
-      {
-
-      }
-      freeListCopy += calculate_block_size();
-    }
-
-    pageListCopy = pageListCopy->Next;
-  }
-  
-
-  return numObjects;
-}
-
-/*****************************************************************************/
-/*!
-  \brief
-    Calls the callback fn for each block that is potentially corrupted
-
-  \param fn
-    dumps the objects with corrupted memory
-
-  \return
-    amount of objects corrupted
-*/
-/*****************************************************************************/
-unsigned ObjectAllocator::ValidatePages(VALIDATECALLBACK fn) const
-{
-  GenericObject *pageListCopy = (PageList_);
-
-  int numObjects = 0;
-
-  while (pageListCopy)
-  {
-    char *freeListCopy = create_offset(reinterpret_cast<char *>(pageListCopy))
-                   + (clientConfig.HBlockInfo_.size_ + clientConfig.PadBytes_);
-
-    for (unsigned i = 0; i < clientConfig.ObjectsPerPage_; i++)
-    {
-      if (clientConfig.HBlockInfo_.size_)
-      {
-        if (check_corruption(freeListCopy))
-        {
-          fn(freeListCopy + clientConfig.HBlockInfo_.size_, stats.ObjectSize_);
-          numObjects++;
-        }
-      }
-      else
-      {
-
-      }
-      freeListCopy += calculate_block_size();
-    }
-
-    pageListCopy = pageListCopy->Next;
-  }
-
-
-  return numObjects;
-}
-
-  // Frees all empty pages (extra credit)
-unsigned ObjectAllocator::FreeEmptyPages(void)
-{
-  return 0;
-}
-
-  // Returns true if FreeEmptyPages and alignments are implemented
-bool ObjectAllocator::ImplementedExtraCredit(void)
-{
-  return false;
-}
-
-  // true=enable, false=disable
-void ObjectAllocator::SetDebugState(bool State)
-{
-  clientConfig.DebugOn_ = State;
-}
-
-  // returns a pointer to the internal free list
-const void *ObjectAllocator::GetFreeList(void) const
-{
-  return FreeList_;
-}
-
-  // returns a pointer to the internal page list
-const void *ObjectAllocator::GetPageList(void) const
-{
-  return PageList_;
-}
-
-  // returns the configuration parameters
-OAConfig ObjectAllocator::GetConfig(void) const
-{
-  return clientConfig;
-}
-
-// returns the statistics for the allocator
-OAStats ObjectAllocator::GetStats(void) const
-{
-  return stats;
-}
-
-  // allocates another page of objects
-void ObjectAllocator::allocate_new_page(void)
-{
-  allocate_empty_page();
-  segment_page();
-}
-
-/*****************************************************************************/
-/*
-  HELPER FUNCTIONS
-*/
-/*****************************************************************************/
-void ObjectAllocator::allocate_empty_page(void)
-{
-  // checks to see if the user allocated more pages than allowed in the config
-  if (stats.PagesInUse_ >= clientConfig.MaxPages_)
-  {
-    throw OAException(OAException::E_NO_PAGES, "Out of pages");
-  }
-
-  GenericObject *newPage;
-  try // makes sure there is enough memory
-  {
-    newPage = reinterpret_cast<GenericObject *>(new char[stats.PageSize_]);
-    if (clientConfig.DebugOn_)
-    {
-      std::memset(newPage, UNALLOCATED_PATTERN, stats.PageSize_);
-    }
-  }
-  catch (std::bad_alloc &)
-  {
-    throw OAException(OAException::E_NO_MEMORY, "out of memory");
-  }
-
-  // creates the first page
-  if (!PageList_)
-  {
-    PageList_ = newPage;
-    PageList_->Next = nullptr;
-  }
-  else // links the new page to the previous ones
-  {
-    newPage->Next = PageList_;
-    PageList_ = newPage;
-  }
-}
-
-void ObjectAllocator::segment_page(void)
-{
-  blockIter = 0;
-
-  // segments the page into its blocks
-  for (unsigned i = 0; i < clientConfig.ObjectsPerPage_; i++)
-  {
-    add_to_page();
-  }
-  stats.PagesInUse_++;
-}
-
-void ObjectAllocator::add_to_page(void)
-{ 
-  char* block = make_block(false);
-                         
-  // creates the next block to link to
-  if(blockIter != 0)
-  {
-    char* prevBlock = make_block(true);
-
-    FreeList_ = reinterpret_cast<GenericObject *>(block);
-    FreeList_->Next = reinterpret_cast<GenericObject *>(prevBlock);
-  }
-  else // creates the first block
-  {
-    if (clientConfig.DebugOn_)
-    {
-      std::memset(block - clientConfig.PadBytes_, PAD_PATTERN, clientConfig.PadBytes_);
-    }
-    FreeList_ = reinterpret_cast<GenericObject *>(block);
-    reinterpret_cast<GenericObject *>(block)->Next = nullptr;
-  }
-  stats.FreeObjects_++;
-  blockIter++;
-  configure_header(block, false, false);
-}
-
-char * ObjectAllocator::make_block(bool makePrev)
-{
-  // creates a new block
-  char *newBlock = create_offset(reinterpret_cast<char *>(PageList_)) + (calculate_block_size() * (blockIter - makePrev));
-  newBlock += clientConfig.HBlockInfo_.size_ + clientConfig.PadBytes_;
-
-  if (clientConfig.DebugOn_)
-  {
-    std::memset(newBlock - clientConfig.PadBytes_, PAD_PATTERN, clientConfig.PadBytes_);
-    std::memset(newBlock + stats.ObjectSize_, PAD_PATTERN, clientConfig.PadBytes_);
-  }
-
-  return newBlock;
-}
-
-void ObjectAllocator::configure_header(char * block, bool allocated, bool freed, const char *label)
-{
-  char *headerLocation = block - (clientConfig.PadBytes_ + clientConfig.HBlockInfo_.size_);
-
-  switch (clientConfig.HBlockInfo_.type_)
-  {
-  case OAConfig::hbBasic: // sets the memory to follow the basic header pattern
-    std::memset(headerLocation, 0, clientConfig.HBlockInfo_.size_);
-
-    if (allocated) 
-    {
-      int *headerInt = reinterpret_cast<int *>(headerLocation);
-      *headerInt = stats.Allocations_;
-      headerLocation += sizeof(int);
-      *headerLocation = true;
-    }
-    break;
-
-  case OAConfig::hbExtended: // sets the memory to follow the extended header pattern
-    if (!allocated && !freed) // initializes the bytes for first use
-    {
-      std::memset(headerLocation, 0, clientConfig.HBlockInfo_.size_);
-    }
-    else if (allocated) // updates the bytes once something is allocated
-    {
-      std::memset(headerLocation, 0, clientConfig.HBlockInfo_.additional_);
-      short *headerShort = reinterpret_cast<short *>(headerLocation + clientConfig.HBlockInfo_.additional_);
-      (*headerShort)++;
-      int *headerInt = reinterpret_cast<int *>(headerShort + 1);
-      *headerInt = stats.Allocations_;
-      char *headerFlag = reinterpret_cast<char *>(headerInt + 1);
-      *headerFlag = true;
-    }
-    else // makes sure the use counter does not get reset once something is freed
-    {
-      std::memset(headerLocation + clientConfig.HBlockInfo_.additional_ + sizeof(short), 0, sizeof(int) + sizeof(char));
-    }
-    break;
-
-  case OAConfig::hbExternal: // sets the pointer to the external header
-    if (!allocated && !freed) // initailizes the bytes for the first time
-    {
-      std::memset(headerLocation, 0, clientConfig.HBlockInfo_.size_);
-    }
-    else if (allocated) // allocates the memblockinfo struct
-    {
-      MemBlockInfo *info;
-      try
-      {
-        info = new MemBlockInfo();
-      }
-      catch (std::bad_alloc &)
-      {
-        throw OAException(OAException::E_NO_MEMORY, "could not allocate the memblock info");
-      }
-      if (label)
-      {
-        try
-        {
-          info->label = new char[strlen(label) + 1];
-        }
-        catch (std::bad_alloc)
-        {
-          throw OAException(OAException::E_NO_MEMORY, "could not allocate the label");
-        }
-        strcpy(info->label, label);
-      }
-      info->alloc_num = stats.Allocations_;
-      info->in_use = true;
-      *(reinterpret_cast<MemBlockInfo **>(headerLocation)) = info;
-    }
-    else // deletes the struct once it's done
-    {
-      MemBlockInfo *toDelete = reinterpret_cast<MemBlockInfo *>(*(reinterpret_cast<MemBlockInfo **>(headerLocation)));
-      if (toDelete->label)
-      {
-        delete[] toDelete->label;
-      }
-      delete toDelete;
-      memset(headerLocation, 0, clientConfig.HBlockInfo_.size_);
-    }
-    break;
-
-  default:
-    break;
-  }
-}
-
-  // takes Object off the free list
-GenericObject* ObjectAllocator::take_off_freelist(const char *label)
-{
-  stats.FreeObjects_--;
-  stats.ObjectsInUse_++;
-  stats.MostObjects_++;
-  stats.Allocations_++;
-  configure_header(reinterpret_cast<char *>(FreeList_), true, false, label);
-  GenericObject* block = FreeList_; // stores the block to give to the client
-  FreeList_ = FreeList_->Next; 
-  if (clientConfig.DebugOn_)
-  {
-    std::memset(block, ALLOCATED_PATTERN, stats.ObjectSize_);
-  }
-  
-  return block;
-}
-
-  // puts object back on freelist
-void ObjectAllocator::put_on_freelist(void *Object)
-{
-  stats.Deallocations_++;
-  stats.ObjectsInUse_--;
-  stats.FreeObjects_++;
-
-  GenericObject *newFreeNode = reinterpret_cast<GenericObject *>(Object);
-  if (clientConfig.DebugOn_)
-  {
-    check_freelist(newFreeNode);
-  }
-  configure_header(reinterpret_cast<char *>(newFreeNode), false, true);
-
-  if (clientConfig.DebugOn_)
-  {
-    std::memset(newFreeNode, FREED_PATTERN, stats.ObjectSize_);
-  }
-
-  // Sets the freelist back up if all memory was taken
-  if (!FreeList_)
-  {
-    FreeList_ = newFreeNode;
-    FreeList_->Next = nullptr;
-  }
-  else // attaches the list if it's not null
-  {
-    newFreeNode->Next = FreeList_;
-    FreeList_ = newFreeNode;
-  }
-}
-
-void ObjectAllocator::check_freelist(GenericObject *node)
-{
-  char *freeListCopy = reinterpret_cast<char *>(FreeList_);
-  char *pageListCopy = reinterpret_cast<char *>(PageList_);
-  char *nodeCopy     = reinterpret_cast<char *>(node);
-
-  if (clientConfig.PadBytes_ != 0)
-  {
-    if (check_corruption(nodeCopy))
-    {
-      throw OAException(OAException::E_CORRUPTED_BLOCK, "Overrote padding");
-    }
-  }
-  check_multiple_free(nodeCopy, freeListCopy);
-  check_bad_location(nodeCopy, pageListCopy);
-}
-
-void ObjectAllocator::check_bad_location(char * toCheck, char * pageList)
-{
-  bool toThrow = false;
-  
-  // if one of these checks goes wrong, it will store that, and then
-  // check the other pages unless both return false
-  while (pageList)
-  { 
-    if (check_out_of_page(toCheck, pageList) || check_wrong_offset(toCheck, pageList))
-    {
-      toThrow = true;
-    }
-    else
-    {
-      toThrow = false;
-      break;
-    }
-
-    pageList = reinterpret_cast<char *>
-      (reinterpret_cast<GenericObject *>
-      (pageList)->Next);
-  }
-  if (toThrow)
-  {
-    throw OAException(OAException::E_BAD_BOUNDARY, "Not freed inside a page");
-  }
-}
-
-void ObjectAllocator::check_multiple_free(char * toCheck, char * freeList)
-{
-  // checks the whole freelist to see the data is on the freelist
-  while (freeList)
-  {
-    if (freeList == toCheck)
-    {
-      throw OAException(OAException::E_MULTIPLE_FREE, "Freed multiple times");
-    }
-    freeList = reinterpret_cast<char *>
-      (reinterpret_cast<GenericObject *>
-      (freeList)->Next);
-  }
-}
-
-bool ObjectAllocator::check_out_of_page(char * toCheck, char * pageList)
-{
-  // checks to see if the data is under or over where the page it
-  if (toCheck < pageList || toCheck > (pageList + calculate_page_size()) - sizeof(void *))
-  {
-    return true;
-  }
-  else
-  {
-    return false;
-  }
-}
-
-bool ObjectAllocator::check_wrong_offset(char * toCheck, char * pageList)
-{ 
-  // calculates the differece between where the first block starts and the block in question
-  long long locationDifference = toCheck - (create_offset(pageList) + clientConfig.HBlockInfo_.size_ + clientConfig.PadBytes_);
-
-  // sees if the difference is divisable by the block size
-  if (locationDifference % calculate_block_size())
-  {
-    return true;
-  }
-  else
-  {
-    return false;
-  }
-}
-
-bool ObjectAllocator::check_leak_in_header(char *node) const
-{
-  // checks the external struct's in use variable
-  if (clientConfig.HBlockInfo_.type_ == OAConfig::hbExternal)
-  {
-    MemBlockInfo *info = reinterpret_cast<MemBlockInfo *>(node);
-    return info->in_use;
-  }
-  else // checks the header's in use variable
-  {
-    node += (clientConfig.HBlockInfo_.size_ - 1);
-    return *node;
-  }
-  return false;
-}
-
-bool ObjectAllocator::check_corruption(char * toCheck) const
-{
-  // points to the padding before and after the data
-  char *firstPad  = toCheck - clientConfig.PadBytes_;
-  char *secondPad = toCheck + stats.ObjectSize_;
-
-  for (unsigned i = 0; i < clientConfig.PadBytes_; i++)
-  {
-    // tests to see if the padding has its correct pattern
-    if (static_cast<unsigned char>(*(firstPad + i)) != PAD_PATTERN 
-     || static_cast<unsigned char>(*(secondPad + i)) != PAD_PATTERN)
-    {
-      return true;
-    }
-  }
-  return false;
-}
-
-// calculates where blocks start
-char * ObjectAllocator::create_offset(char * page) const
-{
-  return page + sizeof(void *);
-}
-
-// calculates the size of a page
-size_t ObjectAllocator::calculate_page_size(void)
-{
-  return sizeof(void *) + (calculate_block_size() * clientConfig.ObjectsPerPage_);
-}
-
-// calculates the size of a block
-size_t ObjectAllocator::calculate_block_size() const
-{
-  size_t headerSize = clientConfig.HBlockInfo_.size_;;
-  size_t padding = clientConfig.PadBytes_ * 2;
-
-  return stats.ObjectSize_ + padding + headerSize;
-}
-
+#include "ObjectAllocator.h"
+#include "PageSource.h"
+#include "PadKernels.h"
+#include "OATrace.h"
+#include <string.h>
+#include <cstring>
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <thread>
+#include <functional>
+#include <exception>
+#include <system_error>
+#ifdef OA_INSTRUMENT
+#include <chrono>
+#include <utility>
+#endif
+
+namespace
+{
+#ifdef OA_INSTRUMENT
+  // adds the time until the end of the scope to a histogram
+  class ScopeTimer
+  {
+    public:
+      explicit ScopeTimer(OAHistogramCounters &Counters) 
+        : counters(Counters), start(std::chrono::steady_clock::now()) {}
+
+      ~ScopeTimer()
+      {
+        std::chrono::steady_clock::duration elapsed = std::chrono::steady_clock::now() - start;
+        counters.record(static_cast<unsigned long long>(
+          std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count()));
+      }
+
+    private:
+      OAHistogramCounters &counters;
+      std::chrono::steady_clock::time_point start;
+  };
+#define OA_TIME(counters) ScopeTimer scopeTimer(counters)
+#else
+#define OA_TIME(counters)
+#endif
+
+  // pointers only use the low 48 bits on 64-bit targets, so the rest of the
+  // word is left for the ABA tag (32-bit targets get a whole 32-bit tag)
+  const unsigned TAG_SHIFT = sizeof(void *) == 8 ? 48 : 32;
+  const unsigned long long POINTER_MASK = (1ull << TAG_SHIFT) - 1;
+
+  const unsigned STAT_STRIPES = 16;
+
+  // any nonzero xorshift seed will do; a fixed one keeps runs repeatable
+  const unsigned SAMPLE_SEED = 2463534242u;
+  std::atomic<unsigned> nextStripe(0);
+
+  GenericObject *untag(unsigned long long word)
+  {
+    return reinterpret_cast<GenericObject *>(static_cast<uintptr_t>(word & POINTER_MASK));
+  }
+
+  unsigned long long retag(GenericObject *node, unsigned long long previous)
+  {
+    unsigned long long tag = (previous >> TAG_SHIFT) + 1;
+    return (tag << TAG_SHIFT) | reinterpret_cast<uintptr_t>(node);
+  }
+}
+  
+/*****************************************************************************/
+/*!
+  \brief 
+    Creates the ObjectManager per the specified values
+    Throws an exception if the construction fails. 
+    (Memory allocation problem)
+
+  \param ObjectSize
+    Size of the objects that are in the blocks
+
+  \param config
+    the configuration of the blocks
+*/
+/*****************************************************************************/
+ObjectAllocator::ObjectAllocator(size_t ObjectSize, const OAConfig& config)
+{
+  clientConfig = config;
+  if (!clientConfig.PageSource_)
+  {
+    clientConfig.PageSource_ = &PageSource::Heap();
+  }
+  stats.ObjectSize_ = ObjectSize;
+  calculate_alignment();
+  calculate_layout();
+  PageList_ = nullptr;
+  FreeList_ = nullptr;
+  ChunkShift_ = 0;
+  BumpPage_ = nullptr;
+  BumpNext_ = 0;
+  ValidateCursor_ = nullptr;
+  ValidateBlock_ = 0;
+  SampleState_ = SAMPLE_SEED;
+  SampleCountdown_ = sampling() ? next_sample_gap() : 0;
+  FullestBin_ = 1;
+  if (clientConfig.LockFree_)
+  {
+    clientConfig.LazyPages_ = false; // pages are handed over whole in that mode
+    clientConfig.PageAffine_ = false;
+  }
+  else if (clientConfig.BitmapBlocks_)
+  {
+    clientConfig.PageAffine_ = true; // the bins find the page, its bitmap the block
+  }
+  if (clientConfig.LockFree_)
+  {
+    clientConfig.BitmapBlocks_ = false;
+  }
+  else if (clientConfig.PageAffine_)
+  {
+    clientConfig.LazyPages_ = false; // each page's list is built when it's segmented
+  }
+  stats.PageCapacity_ = next_page_capacity();
+  stats.PageSize_ = calculate_page_size(stats.PageCapacity_);
+  SharedFreeList_ = 0;
+  DeferredFrees_ = nullptr;
+  Trace_ = nullptr;
+  Plain_ = plain();
+  StatStripes_ = nullptr;
+  AllocNumber_ = 0;
+  InfoRecords_ = 0;
+  InfoSlab_ = 0;
+  InfoNext_ = 0;
+  InfoUnused_ = 0;
+  if (config.LockFree_)
+  {
+    try
+    {
+      StatStripes_ = new StatStripe[STAT_STRIPES];
+    }
+    catch (std::bad_alloc &)
+    {
+      throw OAException(OAException::E_NO_MEMORY, "could not allocate the counters");
+    }
+  }
+  if (config.UseCPPMemManager_ == false)
+  {
+    if (config.LockFree_)
+    {
+      grow_shared();
+    }
+    else
+    {
+      allocate_new_page();
+    }
+  }
+}
+
+/*****************************************************************************/
+/*!
+  \brief
+    Destroys the ObjectManager (never throws)
+*/
+/*****************************************************************************/
+ObjectAllocator::~ObjectAllocator()
+{
+  release_memory();
+}
+
+/*****************************************************************************/
+/*!
+  \brief
+    Takes over another allocator's pages, blocks and counters (never
+    throws). The mutexes aren't moved, this allocator has its own. The
+    other allocator is left with no pages; it can only be destroyed or
+    assigned to. Neither may be in use by another thread.
+
+  \param oa
+    the allocator to move from
+*/
+/*****************************************************************************/
+ObjectAllocator::ObjectAllocator(ObjectAllocator &&oa)
+{
+  take_over(oa);
+}
+
+/*****************************************************************************/
+/*!
+  \brief
+    Gives back this allocator's pages, then takes over another's (never
+    throws). Any blocks still allocated from this allocator are gone.
+
+  \param oa
+    the allocator to move from
+
+  \return
+    this allocator
+*/
+/*****************************************************************************/
+ObjectAllocator &ObjectAllocator::operator=(ObjectAllocator &&oa)
+{
+  if (this != &oa)
+  {
+    release_memory();
+    take_over(oa);
+  }
+  return *this;
+}
+
+/*****************************************************************************/
+/*!
+  \brief
+    Take an object from the free list and give it to the client (simulates new)
+    Throws an exception if the object can't be allocated. 
+    (Memory allocation problem)
+
+  \param label
+    Label that could be stored in a header
+
+  \return 
+    a pointer to the data allocated
+*/
+/*****************************************************************************/
+void *ObjectAllocator::Allocate(const char *label)
+{
+  // with nothing to check, count or record, the block just comes off the list
+  if (Plain_ && FreeList_ && !DeferredFrees_.load(std::memory_order_relaxed))
+  {
+    stats.FreeObjects_--;
+    stats.ObjectsInUse_++;
+    stats.MostObjects_++;
+    stats.Allocations_++;
+    GenericObject *block = FreeList_;
+    FreeList_ = block->Next;
+    if (clientConfig.HBlockInfo_.type_ != OAConfig::hbNone)
+    {
+      configure_header(reinterpret_cast<char *>(block), true, false, label, stats.Allocations_);
+    }
+    return block;
+  }
+
+  void *block = allocate_block(label);
+  if (Trace_)
+  {
+    Trace_->RecordAllocate(block, label);
+  }
+  return block;
+}
+
+  // Allocate, without the trace
+void *ObjectAllocator::allocate_block(const char *label)
+{
+  OA_TIME(AllocateTimes_);
+#ifdef OA_INSTRUMENT
+  if (label)
+  {
+    std::lock_guard<std::mutex> guard(LabelLock_);
+    LabelCounts_[label]++;
+  }
+#endif
+
+  if (clientConfig.LockFree_)
+  {
+    return allocate_shared(label);
+  }
+
+  // blocks other threads handed back go on the free list before it's looked at
+  if (DeferredFrees_.load(std::memory_order_relaxed))
+  {
+    drain_deferred();
+  }
+
+  if (clientConfig.UseCPPMemManager_ == false)
+  {
+    if (clientConfig.PageAffine_)
+    {
+      if (!stats.FreeObjects_)
+      {
+        allocate_new_page();
+      }
+    }
+    else if (!FreeList_ && carving())
+    {
+      carve_block();
+    }
+    else if (!FreeList_)
+    {
+      allocate_new_page();
+    }
+
+    return take_off_freelist(label);
+  }
+  
+  else
+  {
+    stats.Allocations_++;
+    stats.MostObjects_++;
+    try
+    {
+      return new char[stats.ObjectSize_];
+    }
+    catch (std::bad_alloc &)
+    {
+      throw OAException(OAException::E_NO_MEMORY, "No Memory");
+    }
+  }
+}
+
+  
+/*****************************************************************************/
+/*!
+  \brief
+    Returns an object to the free list for the client (simulates delete)
+    Throws an exception if the the object can't be freed. (Invalid object)
+
+  \param Object 
+    Indicates which object to free
+*/
+/*****************************************************************************/
+void ObjectAllocator::Free(void *Object)
+{
+  // with nothing to check, count or record, the block just goes on the list
+  if (Plain_)
+  {
+    stats.Deallocations_++;
+    stats.ObjectsInUse_--;
+    stats.FreeObjects_++;
+    if (clientConfig.HBlockInfo_.type_ != OAConfig::hbNone)
+    {
+      configure_header(reinterpret_cast<char *>(Object), false, true);
+    }
+    GenericObject *node = reinterpret_cast<GenericObject *>(Object);
+    node->Next = FreeList_;
+    FreeList_ = node;
+    return;
+  }
+
+  OA_TIME(FreeTimes_);
+
+  // only a free that worked is recorded (free_shared records its own, 
+  // before another thread can allocate the block again)
+  if (clientConfig.LockFree_)
+  {
+    free_shared(Object);
+  }
+  else if (clientConfig.UseCPPMemManager_ == false)
+  {
+    put_on_freelist(Object);
+    if (Trace_)
+    {
+      Trace_->RecordFree(Object);
+    }
+  }
+  else
+  {
+    if (Trace_)
+    {
+      Trace_->RecordFree(Object);
+    }
+    stats.Deallocations_++;
+    delete[] reinterpret_cast<char *>(Object);
+  }
+}
+
+/*****************************************************************************/
+/*!
+  \brief
+    Queues an object for the thread that owns the allocator to free. It's
+    pushed on a lock-free list (linked through the object's first word)
+    which the next Allocate, AllocateBatch, Reserve or FreeEmptyPages takes
+    in one exchange and frees. Any thread may call it at any time; the
+    debug checks are made when the queue is drained, so an exception for a
+    bad object is thrown from the call that drains it. In LockFree_ mode
+    the object is simply freed.
+
+  \param Object
+    Indicates which object to free
+*/
+/*****************************************************************************/
+void ObjectAllocator::FreeDeferred(void *Object)
+{
+  if (clientConfig.LockFree_)
+  {
+    free_shared(Object);
+    return;
+  }
+
+  GenericObject *node = reinterpret_cast<GenericObject *>(Object);
+  push_deferred(node, node);
+}
+
+/*****************************************************************************/
+/*!
+  \brief
+    Takes n objects off the free list at once and stores them in out
+    Throws an exception if all n can't be allocated (none are allocated then)
+
+  \param out
+    where the n objects are stored
+
+  \param n
+    how many objects to allocate
+
+  \param label
+    Label that could be stored in the headers
+*/
+/*****************************************************************************/
+void ObjectAllocator::AllocateBatch(void **out, size_t n, const char *label)
+{
+  // lazy (or released) pages can't grow ahead of time without stranding the
+  // rest of the page being carved, and page-affine blocks come off many
+  // lists, so they go a block at a time too
+  if (clientConfig.LockFree_ || clientConfig.UseCPPMemManager_ || carving() ||
+      clientConfig.PageAffine_)
+  {
+    size_t allocated = 0;
+    try
+    {
+      for (; allocated < n; allocated++)
+      {
+        out[allocated] = Allocate(label);
+      }
+    }
+    catch (const OAException &)
+    {
+      FreeBatch(out, allocated);
+      throw;
+    }
+    return;
+  }
+
+  // grows first so the whole run can come off the free list in one go,
+  // after making sure MaxPages_ leaves room for every page it takes
+  if (DeferredFrees_.load(std::memory_order_relaxed))
+  {
+    drain_deferred();
+  }
+  size_t available = stats.FreeObjects_;
+  unsigned pages = 0;
+  unsigned capacity = stats.PageCapacity_;
+  for (bool first = !PageList_; available < n; first = false)
+  {
+    capacity = page_capacity(capacity, first);
+    pages++;
+    if (!capacity || (clientConfig.MaxPages_ && stats.PagesInUse_ + pages > clientConfig.MaxPages_))
+    {
+      throw OAException(OAException::E_NO_PAGES, "Out of pages");
+    }
+    available += capacity;
+  }
+
+  // external headers get their records and label up front, so nothing in
+  // the loop below can throw once the first block is handed out
+  if (clientConfig.HBlockInfo_.type_ == OAConfig::hbExternal)
+  {
+    while (FreeInfos_.size() + InfoUnused_ < n)
+    {
+      add_info_slab();
+    }
+    if (label)
+    {
+      intern_label(label);
+    }
+  }
+  for (; pages > 0; pages--)
+  {
+    allocate_new_page();
+  }
+
+  GenericObject *block = FreeList_;
+  PageInfo *page = nullptr;
+  for (size_t i = 0; i < n; i++)
+  {
+    char *blockCopy = reinterpret_cast<char *>(block);
+    configure_header(blockCopy, true, false, label, static_cast<unsigned>(stats.Allocations_ + i + 1));
+    out[i] = block;
+    block = block->Next;
+
+    if (counting())
+    {
+      page = page_of(blockCopy, page);
+      page->inUse++;
+      set_block_free(blockCopy, page, false);
+    }
+
+    if (guard_block(blockCopy, page))
+    {
+      PadKernels::Fill(blockCopy, stats.ObjectSize_, ALLOCATED_PATTERN);
+    }
+  }
+  FreeList_ = block;
+
+  unsigned count = static_cast<unsigned>(n);
+  stats.FreeObjects_ -= count;
+  stats.ObjectsInUse_ += count;
+  stats.MostObjects_ += count;
+  stats.Allocations_ += count;
+
+  for (size_t i = 0; Trace_ && i < n; i++)
+  {
+    Trace_->RecordAllocate(out[i], label);
+  }
+}
+
+/*****************************************************************************/
+/*!
+  \brief
+    Returns n objects to the free list at once
+    Throws an exception if an object can't be freed (the ones before it are)
+
+  \param in
+    the objects to free
+
+  \param n
+    how many objects to free
+*/
+/*****************************************************************************/
+void ObjectAllocator::FreeBatch(void **in, size_t n)
+{
+  if (clientConfig.UseCPPMemManager_ && !clientConfig.LockFree_)
+  {
+    for (size_t i = 0; Trace_ && i < n; i++)
+    {
+      Trace_->RecordFree(in[i]);
+    }
+    for (size_t i = 0; i < n; i++)
+    {
+      delete[] reinterpret_cast<char *>(in[i]);
+    }
+    stats.Deallocations_ += static_cast<unsigned>(n);
+    return;
+  }
+
+  if (clientConfig.LockFree_)
+  {
+    if (clientConfig.UseCPPMemManager_ || !n)
+    {
+      for (size_t i = 0; i < n; i++)
+      {
+        free_shared(in[i]);
+      }
+      return;
+    }
+
+    // checks and links the run, then publishes it with a single exchange
+    // (the debug checks hold the page lock once for the whole run)
+    size_t freed = 0;
+    try
+    {
+      std::unique_lock<std::mutex> guard(PageLock_, std::defer_lock);
+      if (clientConfig.DebugOn_)
+      {
+        guard.lock();
+      }
+
+      for (; freed < n; freed++)
+      {
+        char *block = reinterpret_cast<char *>(in[freed]);
+        if (clientConfig.DebugOn_)
+        {
+          set_block_free(block, check_freelist(reinterpret_cast<GenericObject *>(block)), true);
+        }
+
+        configure_header(block, false, true);
+        if (clientConfig.DebugOn_)
+        {
+          PadKernels::Fill(block, stats.ObjectSize_, FREED_PATTERN);
+        }
+        if (freed)
+        {
+          reinterpret_cast<GenericObject *>(block)->Next = reinterpret_cast<GenericObject *>(in[freed - 1]);
+        }
+      }
+    }
+    catch (const OAException &)
+    {
+      // keeps the blocks that were freed and counts the request that failed
+      for (size_t i = 0; Trace_ && i < freed; i++)
+      {
+        Trace_->RecordFree(in[i]);
+      }
+      if (freed)
+      {
+        push_shared(reinterpret_cast<GenericObject *>(in[freed - 1]), reinterpret_cast<GenericObject *>(in[0]));
+      }
+      local_stripe().Deallocations_.fetch_add(static_cast<unsigned>(freed + 1), std::memory_order_relaxed);
+      throw;
+    }
+
+    for (size_t i = 0; Trace_ && i < n; i++)
+    {
+      Trace_->RecordFree(in[i]);
+    }
+    push_shared(reinterpret_cast<GenericObject *>(in[n - 1]), reinterpret_cast<GenericObject *>(in[0]));
+    local_stripe().Deallocations_.fetch_add(static_cast<unsigned>(n), std::memory_order_relaxed);
+    return;
+  }
+
+  // each block goes back on its own page's list
+  if (clientConfig.PageAffine_)
+  {
+    for (size_t i = 0; i < n; i++)
+    {
+      put_on_freelist(in[i]);
+      if (Trace_)
+      {
+        Trace_->RecordFree(in[i]);
+      }
+    }
+    return;
+  }
+
+  // links each block in front of the last so the run ends up in the same
+  // order as n calls to Free
+  GenericObject *chain = FreeList_;
+  PageInfo *page = nullptr;
+  size_t freed = 0;
+  try
+  {
+    for (; freed < n; freed++)
+    {
+      GenericObject *node = reinterpret_cast<GenericObject *>(in[freed]);
+      char *block = reinterpret_cast<char *>(node);
+
+      bool guarded = false;
+      if (counting())
+      {
+        page = check_guarded_free(node, page, &guarded);
+      }
+      configure_header(block, false, true);
+
+      if (guarded)
+      {
+        PadKernels::Fill(block, stats.ObjectSize_, FREED_PATTERN);
+      }
+      if (page)
+      {
+        page->inUse--;
+        set_block_free(block, page, true);
+      }
+
+      node->Next = chain;
+      chain = node;
+    }
+  }
+  catch (const OAException &)
+  {
+    // keeps the blocks that were freed and counts the request that failed
+    FreeList_ = chain;
+    stats.Deallocations_ += static_cast<unsigned>(freed + 1);
+    stats.ObjectsInUse_ -= static_cast<unsigned>(freed);
+    stats.FreeObjects_ += static_cast<unsigned>(freed);
+    for (size_t i = 0; Trace_ && i < freed; i++)
+    {
+      Trace_->RecordFree(in[i]);
+    }
+    throw;
+  }
+  FreeList_ = chain;
+  for (size_t i = 0; Trace_ && i < n; i++)
+  {
+    Trace_->RecordFree(in[i]);
+  }
+
+  unsigned count = static_cast<unsigned>(n);
+  stats.Deallocations_ += count;
+  stats.ObjectsInUse_ -= count;
+  stats.FreeObjects_ += count;
+}
+
+/*****************************************************************************/
+/*!
+  \brief
+    Calls the callback fn for each block still in use
+
+  \param fn
+    function to dump the data in use
+
+  \return 
+    amount of objects in use
+*/
+/*****************************************************************************/
+unsigned ObjectAllocator::DumpMemoryInUse(DUMPCALLBACK fn) const
+{
+  GenericObject *pageListCopy = (PageList_);
+
+  int numObjects = 0;
+
+  // only the headers (or the bitmaps) know which blocks are in use
+  if (!clientConfig.HBlockInfo_.size_ && !clientConfig.BitmapBlocks_)
+  {
+    return 0;
+  }
+
+  while (pageListCopy)
+  {
+    numObjects += sweep_page(reinterpret_cast<char *>(pageListCopy), swLeaks, fn, 0);
+    pageListCopy = pageListCopy->Next;
+  }
+
+  return numObjects;
+}
+
+/*****************************************************************************/
+/*!
+  \brief
+    Calls the callback fn for each block that is potentially corrupted
+
+  \param fn
+    dumps the objects with corrupted memory
+
+  \return
+    amount of objects corrupted
+*/
+/*****************************************************************************/
+unsigned ObjectAllocator::ValidatePages(VALIDATECALLBACK fn) const
+{
+  GenericObject *pageListCopy = (PageList_);
+
+  int numObjects = 0;
+
+  // without pad bytes there's nothing to validate
+  if (!clientConfig.PadBytes_)
+  {
+    return 0;
+  }
+
+  while (pageListCopy)
+  {
+    numObjects += sweep_page(reinterpret_cast<char *>(pageListCopy), swCorruption, fn, 0);
+    pageListCopy = pageListCopy->Next;
+  }
+
+  return numObjects;
+}
+
+/*****************************************************************************/
+/*!
+  \brief
+    Checks the pad bytes of at most maxBlocks blocks, starting where the
+    previous call left off, so the pages can be validated a little at a
+    time. A call that reaches the oldest page stops there and the next one
+    starts over from the newest page. Pages added between calls are
+    checked on the next pass; if FreeEmptyPages frees the page the cursor
+    is on, the cursor moves on to the next page that's left.
+
+  \param fn
+    dumps the objects with corrupted memory
+
+  \param maxBlocks
+    the most blocks to check in this call
+
+  \return
+    amount of objects found corrupted in this call
+*/
+/*****************************************************************************/
+unsigned ObjectAllocator::ValidatePagesIncremental(VALIDATECALLBACK fn, unsigned maxBlocks)
+{
+  unsigned numObjects = 0;
+
+  if (!clientConfig.PadBytes_ || !PageList_)
+  {
+    return 0;
+  }
+
+  if (!ValidateCursor_)
+  {
+    ValidateCursor_ = PageList_;
+    ValidateBlock_ = 0;
+  }
+
+  while (maxBlocks && ValidateCursor_)
+  {
+    char *page = reinterpret_cast<char *>(ValidateCursor_);
+    unsigned capacity = carved_blocks(find_page(page));
+    char *block = page + clientConfig.FirstBlockOffset_ + ValidateBlock_ * clientConfig.BlockSize_;
+
+    for (; ValidateBlock_ < capacity && maxBlocks; ValidateBlock_++, maxBlocks--)
+    {
+      if (check_corruption(block))
+      {
+        fn(block, stats.ObjectSize_);
+        numObjects++;
+      }
+      block += clientConfig.BlockSize_;
+    }
+
+    if (ValidateBlock_ < capacity)
+    {
+      break;
+    }
+
+    // the last page ends the pass (a null cursor starts the next one over)
+    ValidateCursor_ = ValidateCursor_->Next;
+    ValidateBlock_ = 0;
+  }
+
+  return numObjects;
+}
+
+/*****************************************************************************/
+/*!
+  \brief
+    DumpMemoryInUse with the pages split between threads. No other call
+    may run on the allocator meanwhile.
+
+  \param fn
+    function to dump the data in use
+
+  \param threads
+    how many threads to use (0=one per core)
+
+  \param order
+    coPageOrder calls fn on this thread, in the order DumpMemoryInUse
+    would; coConcurrent calls it from the workers, so fn must be thread safe
+
+  \return 
+    amount of objects in use
+*/
+/*****************************************************************************/
+unsigned ObjectAllocator::DumpMemoryInUseParallel(DUMPCALLBACK fn, unsigned threads,
+                                                  CALLBACK_ORDER order) const
+{
+  if (!clientConfig.HBlockInfo_.size_ && !clientConfig.BitmapBlocks_)
+  {
+    return 0;
+  }
+  return sweep_parallel(swLeaks, fn, threads, order);
+}
+
+/*****************************************************************************/
+/*!
+  \brief
+    ValidatePages with the pages split between threads. No other call may
+    run on the allocator meanwhile.
+
+  \param fn
+    dumps the objects with corrupted memory
+
+  \param threads
+    how many threads to use (0=one per core)
+
+  \param order
+    coPageOrder calls fn on this thread, in the order ValidatePages would;
+    coConcurrent calls it from the workers, so fn must be thread safe
+
+  \return
+    amount of objects corrupted
+*/
+/*****************************************************************************/
+unsigned ObjectAllocator::ValidatePagesParallel(VALIDATECALLBACK fn, unsigned threads,
+                                                CALLBACK_ORDER order) const
+{
+  if (!clientConfig.PadBytes_)
+  {
+    return 0;
+  }
+  return sweep_parallel(swCorruption, fn, threads, order);
+}
+
+/*****************************************************************************/
+/*!
+  \brief
+    Reports how full each page is from the per-page counts, without looking
+    at any headers. The free list is walked once to see the order its
+    blocks come off the pages in.
+
+  \return
+    the occupancy of every page (none in LockFree_ mode, which doesn't
+    count blocks per page)
+*/
+/*****************************************************************************/
+OAOccupancy ObjectAllocator::GetOccupancy(void) const
+{
+  OAOccupancy report;
+
+  if (clientConfig.LockFree_)
+  {
+    return report;
+  }
+
+  recount_pages();
+  std::map<const PageInfo *, size_t> positions;
+  for (GenericObject *pageList = PageList_; pageList; pageList = pageList->Next)
+  {
+    const PageInfo *page = find_page(reinterpret_cast<char *>(pageList));
+    OAPageOccupancy occupancy;
+    occupancy.Page_ = page->page;
+    occupancy.Capacity_ = page->capacity;
+    occupancy.InUse_ = page->inUse;
+    occupancy.FreeListRank_ = OAOccupancy::NOT_ON_FREE_LIST;
+    positions[page] = report.Pages_.size();
+    report.Pages_.push_back(occupancy);
+
+    unsigned bucket = static_cast<unsigned>(static_cast<unsigned long long>(page->inUse) *
+                                            OAOccupancy::BUCKETS / page->capacity);
+    report.Histogram_[std::min(bucket, OAOccupancy::BUCKETS - 1)]++;
+    if (page->inUse == 0)
+    {
+      report.EmptyPages_++;
+      report.ReclaimableBytes_ += page->size;
+    }
+    if (page->inUse == page->capacity)
+    {
+      report.FullPages_++;
+    }
+  }
+
+  // page-affine allocations take the pages in bin order, one run each
+  if (clientConfig.PageAffine_)
+  {
+    unsigned rank = 0;
+    for (size_t bin = 1; bin < FreeBins_.size(); bin++)
+    {
+      for (PageInfo *page = FreeBins_[bin]; page; page = page->binNext)
+      {
+        report.Pages_[positions[page]].FreeListRank_ = rank++;
+        report.FreeListRuns_++;
+      }
+    }
+    return report;
+  }
+
+  // ranks the pages by where their first free block is on the list
+  PageInfo *current = nullptr;
+  unsigned rank = 0;
+  for (GenericObject *node = FreeList_; node; node = node->Next)
+  {
+    PageInfo *page = page_of(reinterpret_cast<char *>(node), current);
+    if (page == current)
+    {
+      continue;
+    }
+    current = page;
+    report.FreeListRuns_++;
+
+    OAPageOccupancy &occupancy = report.Pages_[positions[page]];
+    if (occupancy.FreeListRank_ == OAOccupancy::NOT_ON_FREE_LIST)
+    {
+      occupancy.FreeListRank_ = rank++;
+    }
+  }
+
+  return report;
+}
+
+/*****************************************************************************/
+/*!
+  \brief
+    Frees all empty pages (extra credit)
+
+  \return
+    amount of pages freed
+*/
+/*****************************************************************************/
+unsigned ObjectAllocator::FreeEmptyPages(void)
+{
+  unsigned emptyPages = 0;
+  unsigned emptyBlocks = 0;
+
+  // other threads could still be reading the pages' free blocks
+  if (clientConfig.LockFree_)
+  {
+    return 0;
+  }
+
+  // queued blocks may be all that keeps a page from being empty
+  if (DeferredFrees_.load(std::memory_order_relaxed))
+  {
+    drain_deferred();
+  }
+
+  // the live counts tell us which pages are empty without looking at blocks
+  recount_pages();
+  for (size_t i = 0; i < PageIndex_.size(); i++)
+  {
+    if (PageIndex_[i]->inUse == 0)
+    {
+      emptyPages++;
+      emptyBlocks += PageIndex_[i]->capacity;
+    }
+  }
+
+  if (!emptyPages)
+  {
+    return 0;
+  }
+
+  // unlinks every block that lives on an empty page in one pass
+  GenericObject **freeLink = &FreeList_;
+  while (*freeLink)
+  {
+    if (find_page(reinterpret_cast<char *>(*freeLink))->inUse == 0)
+    {
+      *freeLink = (*freeLink)->Next;
+    }
+    else
+    {
+      freeLink = &(*freeLink)->Next;
+    }
+  }
+
+  // unlinks the empty pages from the page list
+  GenericObject **pageLink = &PageList_;
+  while (*pageLink)
+  {
+    if (find_page(reinterpret_cast<char *>(*pageLink))->inUse == 0)
+    {
+      // an incremental validation on this page resumes on the next one
+      if (*pageLink == ValidateCursor_)
+      {
+        ValidateCursor_ = (*pageLink)->Next;
+        ValidateBlock_ = 0;
+      }
+      *pageLink = (*pageLink)->Next;
+    }
+    else
+    {
+      pageLink = &(*pageLink)->Next;
+    }
+  }
+
+  // gives the memory back and drops the bookkeeping for the freed pages
+  std::vector<PageInfo *>::iterator kept = PageIndex_.begin();
+  for (size_t i = 0; i < PageIndex_.size(); i++)
+  {
+    if (PageIndex_[i]->inUse == 0)
+    {
+      if (PageIndex_[i] == BumpPage_)
+      {
+        BumpPage_ = nullptr;
+      }
+      unbin_page(PageIndex_[i]);
+      unindex_page(PageIndex_[i]);
+      clientConfig.PageSource_->FreePage(PageIndex_[i]->memory, PageIndex_[i]->size);
+      delete PageIndex_[i];
+    }
+    else
+    {
+      *kept++ = PageIndex_[i];
+    }
+  }
+  PageIndex_.erase(kept, PageIndex_.end());
+
+  // pages waiting to be carved are all empty, so they're all gone
+  ReleasedPages_.clear();
+
+  stats.PagesInUse_ -= emptyPages;
+  stats.FreeObjects_ -= emptyBlocks;
+
+  return emptyPages;
+}
+
+/*****************************************************************************/
+/*!
+  \brief
+    Takes back every block at once, as if each had been freed, without
+    walking them: every page is marked empty, the free list is dropped and
+    the external header records' cursor goes back to the first slab, so 
+    the cost is per page, not per block (besides resetting the free maps,
+    a bit per block, while debugging or PageAffine_ keeps them). The pages
+    are then carved again, a block at a time, as Allocate needs them, which
+    is when their headers and debug patterns are refreshed (a bitmap page
+    needs neither). Nothing is released in LockFree_ mode or with 
+    UseCPPMemManager_.
+
+  \return
+    how many blocks were released
+*/
+/*****************************************************************************/
+unsigned ObjectAllocator::ReleaseAll(void)
+{
+  if (clientConfig.LockFree_ || clientConfig.UseCPPMemManager_)
+  {
+    return 0;
+  }
+
+  unsigned released = stats.ObjectsInUse_;
+  if (Trace_)
+  {
+    Trace_->RecordReleaseAll();
+  }
+
+  // every external header record goes back to the slabs in one go (a
+  // record is filled in whenever it's handed out, so it isn't cleared)
+  FreeInfos_.clear();
+  InfoSlab_ = 0;
+  InfoNext_ = 0;
+  InfoUnused_ = InfoRecords_;
+
+  FreeList_ = nullptr;
+  DeferredFrees_.store(nullptr, std::memory_order_relaxed);
+  BumpPage_ = nullptr;
+  BumpNext_ = 0;
+  ReleasedPages_.clear();
+  FreeBins_.assign(FreeBins_.size(), nullptr);
+  FullestBin_ = 1;
+
+  // the lowest page ends up at the back, so it's carved first
+  for (size_t i = PageIndex_.size(); i > 0; i--)
+  {
+    PageInfo *page = PageIndex_[i - 1];
+    page->inUse = 0;
+    page->bin = 0;
+    if (counting()) // (recount_pages works the maps out otherwise)
+    {
+      mark_all_free(page);
+    }
+
+    if (clientConfig.PageAffine_)
+    {
+      // a bitmap page has nothing to set up, the others carve from the start
+      page->freeList = nullptr;
+      page->carved = clientConfig.BitmapBlocks_ ? page->capacity : 0;
+      bin_page(page);
+    }
+    else
+    {
+      page->uncarved = true;
+      ReleasedPages_.push_back(page);
+    }
+  }
+
+  // the statistics look as if every block had been freed
+  stats.Deallocations_ += released;
+  stats.ObjectsInUse_ = 0;
+  stats.FreeObjects_ += released;
+  return released;
+}
+
+/*****************************************************************************/
+/*!
+  \brief
+    Adds pages until at least Objects blocks are free, touching every OS
+    page of each new page before anything else can see it, so the first
+    burst of allocations neither grows the allocator nor takes page 
+    faults. MaxPages_ still applies.
+    Throws an exception if a page can't be added. 
+    (the pages added before it are kept)
+
+  \param Objects
+    how many blocks should be ready to allocate
+
+  \return
+    how many blocks are free now (0 with UseCPPMemManager_)
+*/
+/*****************************************************************************/
+unsigned ObjectAllocator::Reserve(unsigned Objects)
+{
+  if (clientConfig.UseCPPMemManager_)
+  {
+    return 0;
+  }
+
+  if (DeferredFrees_.load(std::memory_order_relaxed))
+  {
+    drain_deferred();
+  }
+
+  // the free count in lock-free mode has to be worked out from the stripes
+  while (GetStats().FreeObjects_ < Objects)
+  {
+    if (clientConfig.LockFree_)
+    {
+      grow_shared(true);
+    }
+    else
+    {
+      allocate_new_page(true);
+    }
+  }
+  return GetStats().FreeObjects_;
+}
+
+/*****************************************************************************/
+/*!
+  \brief
+    Starts recording every Allocate, Free and ReleaseAll into a trace, for
+    the replay tool (replay.cpp). Batches are recorded a block at a time
+    and deferred frees when they're drained. Without a trace the only cost
+    is a test of the pointer per call.
+
+  \param trace
+    where to record (0 stops recording). It must outlive the recording,
+    and record only this allocator.
+*/
+/*****************************************************************************/
+void ObjectAllocator::SetTrace(OATraceWriter *trace)
+{
+  if (trace)
+  {
+    trace->Begin(stats.ObjectSize_);
+  }
+  Trace_ = trace;
+  Plain_ = plain();
+}
+
+  // true if Object lies on one of this allocator's pages (never with UseCPPMemManager_)
+bool ObjectAllocator::Owns(const void *Object) const
+{
+  return find_page(static_cast<char *>(const_cast<void *>(Object))) != nullptr;
+}
+
+  // Returns true if FreeEmptyPages and alignments are implemented
+bool ObjectAllocator::ImplementedExtraCredit(void)
+{
+  return true;
+}
+
+  // true=enable, false=disable
+void ObjectAllocator::SetDebugState(bool State)
+{
+  // the debug checks read the free maps, which may not have been kept
+  if (State && !clientConfig.LockFree_)
+  {
+    recount_pages();
+  }
+  clientConfig.DebugOn_ = State;
+  Plain_ = plain();
+}
+
+  // returns a pointer to the internal free list
+const void *ObjectAllocator::GetFreeList(void) const
+{
+  if (clientConfig.LockFree_)
+  {
+    return untag(SharedFreeList_.load(std::memory_order_acquire));
+  }
+  if (clientConfig.PageAffine_)
+  {
+    // the list of the page the next allocation comes from
+    PageInfo *page = fullest_page();
+    return page ? page->freeList : nullptr;
+  }
+  return FreeList_;
+}
+
+  // returns a pointer to the internal page list
+const void *ObjectAllocator::GetPageList(void) const
+{
+  return PageList_;
+}
+
+  // returns the configuration parameters
+OAConfig ObjectAllocator::GetConfig(void) const
+{
+  return clientConfig;
+}
+
+// returns the statistics for the allocator
+OAStats ObjectAllocator::GetStats(void) const
+{
+  if (!clientConfig.LockFree_)
+  {
+    return stats;
+  }
+
+  // the page counts change under the page lock as other threads grow
+  std::unique_lock<std::mutex> guard(PageLock_);
+  OAStats snapshot = stats;
+  guard.unlock();
+  snapshot.Allocations_ = 0;
+  snapshot.Deallocations_ = 0;
+  for (unsigned i = 0; i < STAT_STRIPES; i++)
+  {
+    snapshot.Allocations_ += StatStripes_[i].Allocations_.load(std::memory_order_relaxed);
+    snapshot.Deallocations_ += StatStripes_[i].Deallocations_.load(std::memory_order_relaxed);
+  }
+
+  // everything else follows from the two counts (MostObjects_ counts every
+  // allocation, the same as the single threaded path). FreeObjects_ only
+  // goes up in this mode, as pages are segmented, so it's every block.
+  snapshot.ObjectsInUse_ = snapshot.Allocations_ - snapshot.Deallocations_;
+  snapshot.MostObjects_ = snapshot.Allocations_;
+  if (!clientConfig.UseCPPMemManager_)
+  {
+    snapshot.FreeObjects_ -= snapshot.ObjectsInUse_;
+  }
+  return snapshot;
+}
+
+// returns the timings and label counts (empty unless built with OA_INSTRUMENT)
+OAInstrumentation ObjectAllocator::GetInstrumentation(void) const
+{
+  OAInstrumentation snapshot;
+#ifdef OA_INSTRUMENT
+  snapshot.Enabled_ = true;
+  AllocateTimes_.copy_to(snapshot.Allocate_);
+  FreeTimes_.copy_to(snapshot.Free_);
+  GrowthTimes_.copy_to(snapshot.PageGrowth_);
+  ValidationTimes_.copy_to(snapshot.Validation_);
+  HeaderTimes_.copy_to(snapshot.HeaderSetup_);
+
+  std::lock_guard<std::mutex> guard(LabelLock_);
+  snapshot.LabelCounts_ = LabelCounts_;
+#endif
+  return snapshot;
+}
+
+#ifdef OA_INSTRUMENT
+OAHistogramCounters::OAHistogramCounters(void) : calls(0), totalNs(0)
+{
+  for (unsigned i = 0; i < OAHistogram::BUCKETS; i++)
+  {
+    buckets[i].store(0, std::memory_order_relaxed);
+  }
+}
+
+  // adds one call that took ns nanoseconds
+void OAHistogramCounters::record(unsigned long long ns)
+{
+  unsigned bucket = 0;
+  for (unsigned long long rest = ns >> 1; rest && bucket < OAHistogram::BUCKETS - 1; rest >>= 1)
+  {
+    bucket++;
+  }
+
+  buckets[bucket].fetch_add(1, std::memory_order_relaxed);
+  calls.fetch_add(1, std::memory_order_relaxed);
+  totalNs.fetch_add(ns, std::memory_order_relaxed);
+}
+
+  // takes a snapshot of the counters
+void OAHistogramCounters::copy_to(OAHistogram &histogram) const
+{
+  for (unsigned i = 0; i < OAHistogram::BUCKETS; i++)
+  {
+    histogram.Buckets_[i] = buckets[i].load(std::memory_order_relaxed);
+  }
+  histogram.Calls_ = calls.load(std::memory_order_relaxed);
+  histogram.TotalNs_ = totalNs.load(std::memory_order_relaxed);
+}
+
+  // moves other's counts here, leaving it with none
+void OAHistogramCounters::take(OAHistogramCounters &other)
+{
+  for (unsigned i = 0; i < OAHistogram::BUCKETS; i++)
+  {
+    buckets[i].store(other.buckets[i].exchange(0, std::memory_order_relaxed), std::memory_order_relaxed);
+  }
+  calls.store(other.calls.exchange(0, std::memory_order_relaxed), std::memory_order_relaxed);
+  totalNs.store(other.totalNs.exchange(0, std::memory_order_relaxed), std::memory_order_relaxed);
+}
+#endif
+
+  // gives back the pages, and the records and labels of blocks still in use
+void ObjectAllocator::release_memory(void)
+{
+  // the index remembers the memory behind every page (which may start
+  // before the page itself when the page had to be aligned)
+  for (size_t i = 0; i < PageIndex_.size(); i++)
+  {
+    clientConfig.PageSource_->FreePage(PageIndex_[i]->memory, PageIndex_[i]->size);
+    delete PageIndex_[i];
+  }
+  delete[] StatStripes_;
+
+  for (size_t i = 0; i < InfoSlabs_.size(); i++)
+  {
+    delete[] InfoSlabs_[i];
+  }
+  for (std::set<const char *, LabelLess>::iterator it = Labels_.begin(); it != Labels_.end(); ++it)
+  {
+    delete[] *it;
+  }
+}
+
+  // moves everything oa owns here, and leaves oa owning nothing
+void ObjectAllocator::take_over(ObjectAllocator &oa)
+{
+  clientConfig = oa.clientConfig;
+  stats = oa.stats;
+  info = oa.info;
+  blockIter = oa.blockIter;
+
+  PageList_ = oa.PageList_;
+  FreeList_ = oa.FreeList_;
+  PageIndex_ = std::move(oa.PageIndex_);
+  oa.PageIndex_.clear();
+  PageChunks_ = std::move(oa.PageChunks_);
+  oa.PageChunks_.clear();
+  ChunkShift_ = oa.ChunkShift_;
+  SharedFreeList_.store(oa.SharedFreeList_.exchange(0));
+  DeferredFrees_.store(oa.DeferredFrees_.exchange(nullptr));
+  InfoSlabs_ = std::move(oa.InfoSlabs_);
+  oa.InfoSlabs_.clear();
+  FreeInfos_ = std::move(oa.FreeInfos_);
+  oa.FreeInfos_.clear();
+  InfoSlabSizes_ = std::move(oa.InfoSlabSizes_);
+  oa.InfoSlabSizes_.clear();
+  InfoRecords_ = oa.InfoRecords_;
+  InfoSlab_ = oa.InfoSlab_;
+  InfoNext_ = oa.InfoNext_;
+  InfoUnused_ = oa.InfoUnused_;
+  Labels_ = std::move(oa.Labels_);
+  oa.Labels_.clear();
+  StatStripes_ = oa.StatStripes_;
+  AllocNumber_.store(oa.AllocNumber_.load());
+  ValidateCursor_ = oa.ValidateCursor_;
+  ValidateBlock_ = oa.ValidateBlock_;
+  FreeBins_ = oa.FreeBins_;
+  FullestBin_ = oa.FullestBin_;
+  BumpPage_ = oa.BumpPage_;
+  BumpNext_ = oa.BumpNext_;
+  SampleCountdown_ = oa.SampleCountdown_;
+  SampleState_ = oa.SampleState_;
+  ReleasedPages_ = std::move(oa.ReleasedPages_);
+  oa.ReleasedPages_.clear();
+  Trace_ = oa.Trace_;
+  Plain_ = oa.Plain_;
+#ifdef OA_INSTRUMENT
+  AllocateTimes_.take(oa.AllocateTimes_);
+  FreeTimes_.take(oa.FreeTimes_);
+  GrowthTimes_.take(oa.GrowthTimes_);
+  ValidationTimes_.take(oa.ValidationTimes_);
+  HeaderTimes_.take(oa.HeaderTimes_);
+  {
+    std::lock_guard<std::mutex> guard(oa.LabelLock_);
+    LabelCounts_ = std::move(oa.LabelCounts_);
+    oa.LabelCounts_.clear();
+  }
+#endif
+
+  // what's left looks like an allocator that never had a page (the
+  // containers were moved, so they're cleared to be sure they're empty)
+  oa.PageList_ = nullptr;
+  oa.FreeList_ = nullptr;
+  oa.StatStripes_ = nullptr;
+  oa.InfoRecords_ = 0;
+  oa.InfoSlab_ = 0;
+  oa.InfoNext_ = 0;
+  oa.InfoUnused_ = 0;
+  oa.ValidateCursor_ = nullptr;
+  oa.ValidateBlock_ = 0;
+  oa.FreeBins_.assign(FreeBins_.size(), nullptr);
+  oa.FullestBin_ = 1;
+  oa.BumpPage_ = nullptr;
+  oa.BumpNext_ = 0;
+  oa.Trace_ = nullptr;
+  oa.stats.FreeObjects_ = 0;
+  oa.stats.ObjectsInUse_ = 0;
+  oa.stats.PagesInUse_ = 0;
+}
+
+  // allocates another page of objects (faulted in first for Reserve)
+void ObjectAllocator::allocate_new_page(bool reserve)
+{
+  OA_TIME(GrowthTimes_);
+  allocate_empty_page(reserve);
+
+  if (!clientConfig.LazyPages_)
+  {
+    segment_page();
+    return;
+  }
+
+  // the blocks count as free now but are only set up as carve_block reaches them
+  PageInfo *page = find_page(reinterpret_cast<char *>(PageList_));
+  mark_all_free(page);
+  stats.PagesInUse_++;
+  stats.FreeObjects_ += page->capacity;
+
+  // a page added ahead of time (Reserve) waits until the one being carved is used up
+  if (BumpPage_ && BumpNext_ < BumpPage_->capacity)
+  {
+    page->uncarved = true;
+    ReleasedPages_.push_back(page);
+    return;
+  }
+  BumpPage_ = page;
+  BumpNext_ = 0;
+}
+
+  // sets up the next block of the page being carved and puts it on the free list
+void ObjectAllocator::carve_block(void)
+{
+  // released pages are carved again before the allocator grows
+  if (!BumpPage_ || BumpNext_ == BumpPage_->capacity)
+  {
+    if (!ReleasedPages_.empty())
+    {
+      BumpPage_ = ReleasedPages_.back();
+      ReleasedPages_.pop_back();
+      BumpPage_->uncarved = false;
+      BumpNext_ = 0;
+    }
+    else if (clientConfig.LazyPages_)
+    {
+      allocate_new_page();
+    }
+    else // a new page is segmented whole
+    {
+      BumpPage_ = nullptr;
+      allocate_new_page();
+      return;
+    }
+  }
+
+  char *block = BumpPage_->page + clientConfig.FirstBlockOffset_ + clientConfig.BlockSize_ * BumpNext_;
+  char *header = block - clientConfig.HBlockInfo_.size_ - clientConfig.PadBytes_;
+
+  if (clientConfig.DebugOn_)
+  {
+    if (BumpNext_ == 0)
+    {
+      PadKernels::Fill(BumpPage_->page + sizeof(void *), clientConfig.LeftAlignSize_, ALIGN_PATTERN);
+    }
+    else
+    {
+      PadKernels::Fill(header - clientConfig.InterAlignSize_, clientConfig.InterAlignSize_, ALIGN_PATTERN);
+    }
+    PadKernels::Fill(block - clientConfig.PadBytes_, clientConfig.PadBytes_, PAD_PATTERN);
+    PadKernels::Fill(block, stats.ObjectSize_, UNALLOCATED_PATTERN);
+    PadKernels::Fill(block + stats.ObjectSize_, clientConfig.PadBytes_, PAD_PATTERN);
+  }
+  configure_header(block, false, false);
+  BumpNext_++;
+
+  GenericObject *node = reinterpret_cast<GenericObject *>(block);
+  node->Next = FreeList_;
+  FreeList_ = node;
+}
+
+  // the blocks of a page that have been set up (all but the page being carved)
+unsigned ObjectAllocator::carved_blocks(const PageInfo *page) const
+{
+  if (clientConfig.PageAffine_)
+  {
+    return page->carved;
+  }
+  if (page == BumpPage_)
+  {
+    return BumpNext_;
+  }
+  return page->uncarved ? 0 : page->capacity;
+}
+
+  // blocks come from carve_block while pages are lazy or left by ReleaseAll
+bool ObjectAllocator::carving(void) const
+{
+  return clientConfig.LazyPages_ || BumpPage_ || !ReleasedPages_.empty();
+}
+
+  // sets up the next uncarved block of a page-affine page, lowest address first
+char *ObjectAllocator::carve_page_block(PageInfo *page)
+{
+  char *block = page->page + clientConfig.FirstBlockOffset_ + clientConfig.BlockSize_ * page->carved;
+  if (clientConfig.DebugOn_)
+  {
+    PadKernels::Fill(block, stats.ObjectSize_, UNALLOCATED_PATTERN);
+  }
+  configure_header(block, false, false);
+  page->carved++;
+  return block;
+}
+
+/*****************************************************************************/
+/*
+  HELPER FUNCTIONS
+*/
+/*****************************************************************************/
+unsigned ObjectAllocator::sweep_page(char *page, SWEEP_TYPE type, DUMPCALLBACK fn,
+                                     std::vector<char *> *found) const
+{
+  unsigned numObjects = 0;
+  size_t headerOffset = clientConfig.HBlockInfo_.size_ + clientConfig.PadBytes_;
+  char *block = page + clientConfig.FirstBlockOffset_;
+  const PageInfo *info = find_page(page);
+  unsigned capacity = carved_blocks(info);
+
+  for (unsigned i = 0; i < capacity; i++, block += clientConfig.BlockSize_)
+  {
+    bool hit;
+    if (type == swCorruption)
+    {
+      hit = check_corruption(block);
+    }
+    else if (clientConfig.BitmapBlocks_) // a clear bit is a block in use
+    {
+      hit = !((info->freeMap[i / 8] >> (i % 8)) & 1);
+    }
+    else
+    {
+      hit = check_leak_in_header(block - headerOffset);
+    }
+    if (!hit)
+    {
+      continue;
+    }
+
+    // collected blocks are called back later, in page order
+    if (found)
+    {
+      found->push_back(block);
+    }
+    else
+    {
+      fn(block, stats.ObjectSize_);
+    }
+    numObjects++;
+  }
+  return numObjects;
+}
+
+unsigned ObjectAllocator::sweep_parallel(SWEEP_TYPE type, DUMPCALLBACK fn, unsigned threads,
+                                         CALLBACK_ORDER order) const
+{
+  std::vector<char *> pages;
+  for (GenericObject *pageList = PageList_; pageList; pageList = pageList->Next)
+  {
+    pages.push_back(reinterpret_cast<char *>(pageList));
+  }
+
+  if (!threads)
+  {
+    threads = std::max(std::thread::hardware_concurrency(), 1u);
+  }
+  threads = static_cast<unsigned>(std::min<size_t>(threads, pages.size()));
+  if (!threads)
+  {
+    return 0;
+  }
+
+  // each worker takes a contiguous run of pages so the results stay in page order
+  std::vector<unsigned> counts(threads, 0);
+  std::vector<std::vector<char *> > found(order == coPageOrder ? threads : 0);
+  std::vector<std::exception_ptr> errors(threads);
+  std::vector<std::thread> workers;
+
+  std::function<void(unsigned)> sweep = [&](unsigned worker)
+  {
+    try
+    {
+      size_t first = pages.size() * worker / threads;
+      size_t last = pages.size() * (worker + 1) / threads;
+      for (size_t i = first; i < last; i++)
+      {
+        counts[worker] += sweep_page(pages[i], type, fn, found.empty() ? 0 : &found[worker]);
+      }
+    }
+    catch (...)
+    {
+      errors[worker] = std::current_exception();
+    }
+  };
+
+  // the calling thread takes the first share, and any share a thread can't be started for
+  for (unsigned worker = 1; worker < threads; worker++)
+  {
+    try
+    {
+      workers.push_back(std::thread(sweep, worker));
+    }
+    catch (std::system_error &)
+    {
+      sweep(worker);
+    }
+  }
+  sweep(0);
+  for (size_t i = 0; i < workers.size(); i++)
+  {
+    workers[i].join();
+  }
+
+  for (unsigned worker = 0; worker < threads; worker++)
+  {
+    if (errors[worker])
+    {
+      std::rethrow_exception(errors[worker]);
+    }
+  }
+
+  unsigned numObjects = 0;
+  for (unsigned worker = 0; worker < threads; worker++)
+  {
+    numObjects += counts[worker];
+  }
+  for (size_t worker = 0; worker < found.size(); worker++)
+  {
+    for (size_t i = 0; i < found[worker].size(); i++)
+    {
+      fn(found[worker][i], stats.ObjectSize_);
+    }
+  }
+  return numObjects;
+}
+
+void ObjectAllocator::allocate_empty_page(bool reserve)
+{
+  // checks to see if the user allocated more pages than allowed in the config (0=no limit)
+  if (clientConfig.MaxPages_ && stats.PagesInUse_ >= clientConfig.MaxPages_)
+  {
+    throw OAException(OAException::E_NO_PAGES, "Out of pages");
+  }
+
+  // an alignment stricter than the page source promises needs room to
+  // slide the page forward onto the boundary
+  PageSource *source = clientConfig.PageSource_;
+  unsigned capacity = next_page_capacity();
+  size_t pageSize = calculate_page_size(capacity);
+  size_t slack = 0;
+  if (clientConfig.Alignment_ > source->Alignment())
+  {
+    slack = clientConfig.Alignment_ - 1;
+  }
+
+  GenericObject *newPage;
+  char *memory = static_cast<char *>(source->AllocatePage(pageSize + slack));
+  if (!memory) // makes sure there is enough memory
+  {
+    throw OAException(OAException::E_NO_MEMORY, "out of memory");
+  }
+
+  // no one else has the memory yet, so it can be written freely
+  if (reserve)
+  {
+    prefault(memory, pageSize + slack);
+  }
+
+  size_t misalignment = 0;
+  if (slack)
+  {
+    misalignment = reinterpret_cast<size_t>(memory) % clientConfig.Alignment_;
+    misalignment = (clientConfig.Alignment_ - misalignment) % clientConfig.Alignment_;
+  }
+  newPage = reinterpret_cast<GenericObject *>(memory + misalignment);
+
+  // lazy pages leave the memory alone until a block is carved from it
+  if (clientConfig.DebugOn_ && !clientConfig.LazyPages_)
+  {
+    PadKernels::Fill(newPage, pageSize, UNALLOCATED_PATTERN);
+    write_align_bytes(reinterpret_cast<char *>(newPage), capacity);
+  }
+
+  // creates the bookkeeping for the page
+  PageInfo *info = nullptr;
+  try
+  {
+    info = new PageInfo;
+    info->memory = memory;
+    info->size = pageSize + slack;
+    info->pageSize = pageSize;
+    info->capacity = capacity;
+    info->page = reinterpret_cast<char *>(newPage);
+    info->inUse = 0;
+    info->freeMap.assign((capacity + 63) / 64 * 8, 0);
+    info->freeList = nullptr;
+    info->bin = 0;
+    info->firstFree = 0;
+    info->uncarved = false;
+    info->carved = 0;
+    info->binPrev = nullptr;
+    info->binNext = nullptr;
+    if (sampling())
+    {
+      info->sampleMap.assign((capacity + 7) / 8, 0);
+    }
+
+    // keeps the index sorted by address, and the chunk map pointing at the page
+    std::vector<PageInfo *>::iterator spot = 
+      std::upper_bound(PageIndex_.begin(), PageIndex_.end(), info->page, page_starts_after);
+    index_page(info);
+    PageIndex_.insert(spot, info);
+  }
+  catch (std::bad_alloc &)
+  {
+    if (info)
+    {
+      unindex_page(info);
+      delete info;
+    }
+    source->FreePage(memory, pageSize + slack);
+    throw OAException(OAException::E_NO_MEMORY, "out of memory");
+  }
+
+  stats.PageSize_ = pageSize;
+  stats.PageCapacity_ = capacity;
+
+  // creates the first page
+  if (!PageList_)
+  {
+    PageList_ = newPage;
+    PageList_->Next = nullptr;
+  }
+  else // links the new page to the previous ones
+  {
+    newPage->Next = PageList_;
+    PageList_ = newPage;
+  }
+}
+
+  // writes a byte of every 4 KB of memory the page source just returned,
+  // which faults it in (a lazy page's memory is only touched here)
+void ObjectAllocator::prefault(char *memory, size_t size)
+{
+  const size_t OS_PAGE = 4096;
+  volatile char *bytes = memory;
+  for (size_t offset = 0; offset < size; offset += OS_PAGE)
+  {
+    bytes[offset] = 0;
+  }
+}
+
+void ObjectAllocator::segment_page(void)
+{
+  blockIter = 0;
+  PageInfo *page = find_page(reinterpret_cast<char *>(PageList_));
+
+  // segments the page into its blocks
+  for (unsigned i = 0; i < page->capacity; i++)
+  {
+    add_to_page();
+  }
+  stats.PagesInUse_++;
+
+  // every block on a new page starts out free
+  mark_all_free(page);
+  page->carved = page->capacity;
+
+  // the global list is always empty in page-affine mode, so it's all this page's
+  // (bitmap pages don't keep the list at all)
+  if (clientConfig.PageAffine_)
+  {
+    page->freeList = clientConfig.BitmapBlocks_ ? nullptr : FreeList_;
+    FreeList_ = nullptr;
+    bin_page(page);
+  }
+}
+
+void ObjectAllocator::add_to_page(void)
+{ 
+  char* block = make_block(false);
+                         
+  // creates the next block to link to
+  if(blockIter != 0)
+  {
+    char* prevBlock = make_block(true);
+
+    FreeList_ = reinterpret_cast<GenericObject *>(block);
+    FreeList_->Next = reinterpret_cast<GenericObject *>(prevBlock);
+  }
+  else // creates the first block
+  {
+    if (clientConfig.DebugOn_)
+    {
+      PadKernels::Fill(block - clientConfig.PadBytes_, clientConfig.PadBytes_, PAD_PATTERN);
+    }
+    // keeps whatever was already on the free list behind the new page
+    reinterpret_cast<GenericObject *>(block)->Next = FreeList_;
+    FreeList_ = reinterpret_cast<GenericObject *>(block);
+  }
+  stats.FreeObjects_++;
+  blockIter++;
+  configure_header(block, false, false);
+}
+
+char * ObjectAllocator::make_block(bool makePrev)
+{
+  // creates a new block
+  char *newBlock = create_offset(reinterpret_cast<char *>(PageList_)) + (clientConfig.BlockSize_ * (blockIter - makePrev));
+  newBlock += clientConfig.HBlockInfo_.size_ + clientConfig.PadBytes_;
+
+  if (clientConfig.DebugOn_)
+  {
+    PadKernels::Fill(newBlock - clientConfig.PadBytes_, clientConfig.PadBytes_, PAD_PATTERN);
+    PadKernels::Fill(newBlock + stats.ObjectSize_, clientConfig.PadBytes_, PAD_PATTERN);
+  }
+
+  return newBlock;
+}
+
+void ObjectAllocator::configure_header(char * block, bool allocated, bool freed, const char *label, unsigned allocNum)
+{
+  OA_TIME(HeaderTimes_);
+  char *headerLocation = block - (clientConfig.PadBytes_ + clientConfig.HBlockInfo_.size_);
+
+  switch (clientConfig.HBlockInfo_.type_)
+  {
+  case OAConfig::hbBasic: // sets the memory to follow the basic header pattern
+    std::memset(headerLocation, 0, clientConfig.HBlockInfo_.size_);
+
+    if (allocated) 
+    {
+      int *headerInt = reinterpret_cast<int *>(headerLocation);
+      *headerInt = allocNum;
+      headerLocation += sizeof(int);
+      *headerLocation = true;
+    }
+    break;
+
+  case OAConfig::hbExtended: // sets the memory to follow the extended header pattern
+    if (!allocated && !freed) // initializes the bytes for first use
+    {
+      std::memset(headerLocation, 0, clientConfig.HBlockInfo_.size_);
+    }
+    else if (allocated) // updates the bytes once something is allocated
+    {
+      std::memset(headerLocation, 0, clientConfig.HBlockInfo_.additional_);
+      short *headerShort = reinterpret_cast<short *>(headerLocation + clientConfig.HBlockInfo_.additional_);
+      (*headerShort)++;
+      int *headerInt = reinterpret_cast<int *>(headerShort + 1);
+      *headerInt = allocNum;
+      char *headerFlag = reinterpret_cast<char *>(headerInt + 1);
+      *headerFlag = true;
+    }
+    else // makes sure the use counter does not get reset once something is freed
+    {
+      std::memset(headerLocation + clientConfig.HBlockInfo_.additional_ + sizeof(short), 0, sizeof(int) + sizeof(char));
+    }
+    break;
+
+  case OAConfig::hbExternal: // sets the pointer to the external header
+    if (!allocated && !freed) // initailizes the bytes for the first time
+    {
+      std::memset(headerLocation, 0, clientConfig.HBlockInfo_.size_);
+    }
+    else if (allocated) // takes a memblockinfo struct off the slabs
+    {
+      std::unique_lock<std::mutex> guard(InfoLock_, std::defer_lock);
+      if (clientConfig.LockFree_)
+      {
+        guard.lock();
+      }
+
+      MemBlockInfo *info = acquire_info();
+      try
+      {
+        info->label = label ? intern_label(label) : nullptr;
+      }
+      catch (const OAException &)
+      {
+        release_info(info);
+        throw;
+      }
+      info->alloc_num = allocNum;
+      info->in_use = true;
+      *(reinterpret_cast<MemBlockInfo **>(headerLocation)) = info;
+    }
+    else // gives the struct back once it's done (the label stays interned)
+    {
+      std::unique_lock<std::mutex> guard(InfoLock_, std::defer_lock);
+      if (clientConfig.LockFree_)
+      {
+        guard.lock();
+      }
+
+      release_info(*(reinterpret_cast<MemBlockInfo **>(headerLocation)));
+      memset(headerLocation, 0, clientConfig.HBlockInfo_.size_);
+    }
+    break;
+
+  default:
+    break;
+  }
+}
+
+  // takes a record for an external header off the slabs
+MemBlockInfo *ObjectAllocator::acquire_info(void)
+{
+  // records given back are reused first
+  if (!FreeInfos_.empty())
+  {
+    MemBlockInfo *info = FreeInfos_.back();
+    FreeInfos_.pop_back();
+    return info;
+  }
+
+  // then the slabs are handed out in order, like blocks carved off a page
+  if (!InfoUnused_)
+  {
+    add_info_slab();
+  }
+  while (InfoNext_ == InfoSlabSizes_[InfoSlab_])
+  {
+    InfoSlab_++;
+    InfoNext_ = 0;
+  }
+  InfoUnused_--;
+  return InfoSlabs_[InfoSlab_] + InfoNext_++;
+}
+
+  // adds a slab with a record for every block of the newest page
+void ObjectAllocator::add_info_slab(void)
+{
+  unsigned count = stats.PageCapacity_ ? stats.PageCapacity_ : 1;
+  try
+  {
+    // room to put every record back, so release_info never allocates
+    FreeInfos_.reserve(InfoRecords_ + count);
+    InfoSlabs_.reserve(InfoSlabs_.size() + 1);
+    InfoSlabSizes_.reserve(InfoSlabs_.size() + 1);
+    MemBlockInfo *slab = new MemBlockInfo[count]();
+    InfoSlabs_.push_back(slab);
+    InfoSlabSizes_.push_back(count);
+    InfoRecords_ += count;
+    InfoUnused_ += count;
+  }
+  catch (std::bad_alloc &)
+  {
+    throw OAException(OAException::E_NO_MEMORY, "could not allocate the memblock info");
+  }
+}
+
+  // puts an external header's record back for reuse
+void ObjectAllocator::release_info(MemBlockInfo *info)
+{
+  info->in_use = false;
+  info->label = nullptr;
+  info->alloc_num = 0;
+
+  // acquire_info reserved a spot for every record, so this can't throw
+  FreeInfos_.push_back(info);
+}
+
+  // finds the table's copy of a label, adding it the first time it's seen
+char *ObjectAllocator::intern_label(const char *label)
+{
+  std::set<const char *, LabelLess>::iterator found = Labels_.find(label);
+  if (found != Labels_.end())
+  {
+    return const_cast<char *>(*found);
+  }
+
+  char *copy = nullptr;
+  try
+  {
+    copy = new char[strlen(label) + 1];
+    strcpy(copy, label);
+    Labels_.insert(copy);
+  }
+  catch (std::bad_alloc &)
+  {
+    delete[] copy;
+    throw OAException(OAException::E_NO_MEMORY, "could not allocate the label");
+  }
+  return copy;
+}
+
+  // takes Object off the free list
+GenericObject* ObjectAllocator::take_off_freelist(const char *label)
+{
+  stats.FreeObjects_--;
+  stats.ObjectsInUse_++;
+  stats.MostObjects_++;
+  stats.Allocations_++;
+  GenericObject* block; // stores the block to give to the client
+  PageInfo *page = nullptr;
+  if (clientConfig.PageAffine_)
+  {
+    page = fullest_page();
+    unbin_page(page);
+    if (clientConfig.BitmapBlocks_)
+    {
+      block = reinterpret_cast<GenericObject *>(take_free_bit(page));
+    }
+    else if (page->freeList)
+    {
+      block = page->freeList;
+      page->freeList = block->Next;
+    }
+    else // the rest of a released page is set up as it's reached
+    {
+      block = reinterpret_cast<GenericObject *>(carve_page_block(page));
+    }
+  }
+  else
+  {
+    block = FreeList_;
+    FreeList_ = FreeList_->Next; 
+    if (counting())
+    {
+      page = find_page(reinterpret_cast<char *>(block));
+    }
+  }
+  char *blockCopy = reinterpret_cast<char *>(block);
+  configure_header(blockCopy, true, false, label, stats.Allocations_);
+
+  // keeps the page's live count up to date if anything needs it between
+  // calls to FreeEmptyPages (which otherwise works it out itself)
+  if (page)
+  {
+    page->inUse++;
+    set_block_free(blockCopy, page, false);
+  }
+  if (clientConfig.PageAffine_)
+  {
+    bin_page(page);
+  }
+
+  if (clientConfig.DebugOn_ && guard_block(blockCopy, page))
+  {
+    PadKernels::Fill(block, stats.ObjectSize_, ALLOCATED_PATTERN);
+  }
+  
+  return block;
+}
+
+  // puts object back on freelist
+void ObjectAllocator::put_on_freelist(void *Object)
+{
+  stats.Deallocations_++;
+  stats.ObjectsInUse_--;
+  stats.FreeObjects_++;
+
+  GenericObject *newFreeNode = reinterpret_cast<GenericObject *>(Object);
+  bool guarded = false;
+  PageInfo *page = nullptr;
+  if (counting())
+  {
+    page = check_guarded_free(newFreeNode, nullptr, &guarded);
+  }
+  configure_header(reinterpret_cast<char *>(newFreeNode), false, true);
+
+  if (guarded)
+  {
+    PadKernels::Fill(newFreeNode, stats.ObjectSize_, FREED_PATTERN);
+  }
+
+  // the block goes back on its own page, which moves up a bin
+  if (clientConfig.PageAffine_)
+  {
+    if (page)
+    {
+      unbin_page(page);
+      page->inUse--;
+      set_block_free(reinterpret_cast<char *>(newFreeNode), page, true);
+      if (!clientConfig.BitmapBlocks_)
+      {
+        newFreeNode->Next = page->freeList;
+        page->freeList = newFreeNode;
+      }
+      bin_page(page);
+    }
+    return;
+  }
+
+  // unchecked frees of foreign memory (and uncounted ones) have no page to update
+  if (page)
+  {
+    page->inUse--;
+    set_block_free(reinterpret_cast<char *>(newFreeNode), page, true);
+  }
+
+  // Sets the freelist back up if all memory was taken
+  if (!FreeList_)
+  {
+    FreeList_ = newFreeNode;
+    FreeList_->Next = nullptr;
+  }
+  else // attaches the list if it's not null
+  {
+    newFreeNode->Next = FreeList_;
+    FreeList_ = newFreeNode;
+  }
+}
+
+  // pushes a chain onto the deferred-free queue (only the drain pops, and
+  // it takes everything, so the head needs no ABA tag)
+void ObjectAllocator::push_deferred(GenericObject *head, GenericObject *tail)
+{
+  GenericObject *top = DeferredFrees_.load(std::memory_order_relaxed);
+  do
+  {
+    tail->Next = top;
+  } while (!DeferredFrees_.compare_exchange_weak(top, head, std::memory_order_release,
+                                                 std::memory_order_relaxed));
+}
+
+  // frees every block other threads queued with FreeDeferred
+void ObjectAllocator::drain_deferred(void)
+{
+  GenericObject *chain = DeferredFrees_.exchange(nullptr, std::memory_order_acquire);
+
+  while (chain)
+  {
+    GenericObject *next = chain->Next;
+    try
+    {
+      Free(chain);
+    }
+    catch (const OAException &)
+    {
+      // the blocks after a bad one wait for the next drain
+      if (next)
+      {
+        GenericObject *tail = next;
+        while (tail->Next)
+        {
+          tail = tail->Next;
+        }
+        push_deferred(next, tail);
+      }
+      throw;
+    }
+    chain = next;
+  }
+}
+
+  // Allocate for lock-free mode
+void *ObjectAllocator::allocate_shared(const char *label)
+{
+  StatStripe &stripe = local_stripe();
+
+  if (clientConfig.UseCPPMemManager_)
+  {
+    stripe.Allocations_.fetch_add(1, std::memory_order_relaxed);
+    try
+    {
+      return new char[stats.ObjectSize_];
+    }
+    catch (std::bad_alloc &)
+    {
+      throw OAException(OAException::E_NO_MEMORY, "No Memory");
+    }
+  }
+
+  GenericObject *block = pop_shared();
+  while (!block)
+  {
+    grow_shared();
+    block = pop_shared();
+  }
+  stripe.Allocations_.fetch_add(1, std::memory_order_relaxed);
+
+  // the free maps are only kept up to date for the debug checks
+  if (clientConfig.DebugOn_)
+  {
+    std::lock_guard<std::mutex> guard(PageLock_);
+    char *blockCopy = reinterpret_cast<char *>(block);
+    set_block_free(blockCopy, find_page(blockCopy), false);
+  }
+
+  // only headers need a single, global allocation order
+  unsigned allocNum = 0;
+  if (clientConfig.HBlockInfo_.type_ != OAConfig::hbNone)
+  {
+    allocNum = AllocNumber_.fetch_add(1, std::memory_order_relaxed) + 1;
+  }
+  configure_header(reinterpret_cast<char *>(block), true, false, label, allocNum);
+
+  if (clientConfig.DebugOn_)
+  {
+    PadKernels::Fill(block, stats.ObjectSize_, ALLOCATED_PATTERN);
+  }
+  return block;
+}
+
+  // Free for lock-free mode
+void ObjectAllocator::free_shared(void *Object)
+{
+  local_stripe().Deallocations_.fetch_add(1, std::memory_order_relaxed);
+
+  if (clientConfig.UseCPPMemManager_)
+  {
+    if (Trace_)
+    {
+      Trace_->RecordFree(Object);
+    }
+    delete[] reinterpret_cast<char *>(Object);
+    return;
+  }
+
+  // the page index and free maps can change under other threads' page
+  // growth, so the full checks are made under the page lock
+  GenericObject *node = reinterpret_cast<GenericObject *>(Object);
+  if (clientConfig.DebugOn_)
+  {
+    std::lock_guard<std::mutex> guard(PageLock_);
+    set_block_free(reinterpret_cast<char *>(node), check_freelist(node), true);
+  }
+  configure_header(reinterpret_cast<char *>(node), false, true);
+
+  if (clientConfig.DebugOn_)
+  {
+    PadKernels::Fill(node, stats.ObjectSize_, FREED_PATTERN);
+  }
+
+  // recorded while no other thread can have the block yet
+  if (Trace_)
+  {
+    Trace_->RecordFree(node);
+  }
+  push_shared(node, node);
+}
+
+  // pops the lock-free free list (nullptr if it's empty)
+GenericObject *ObjectAllocator::pop_shared(void)
+{
+  unsigned long long head = SharedFreeList_.load(std::memory_order_acquire);
+
+  for (;;)
+  {
+    GenericObject *node = untag(head);
+    if (!node)
+    {
+      return nullptr;
+    }
+
+    // if another thread popped the node first this read is stale, but the
+    // tag will have moved on and the exchange fails
+    GenericObject *next = node->Next;
+    if (SharedFreeList_.compare_exchange_weak(head, retag(next, head),
+                                              std::memory_order_acquire, 
+                                              std::memory_order_acquire))
+    {
+      return node;
+    }
+  }
+}
+
+  // pushes the chain head..tail onto the lock-free free list
+void ObjectAllocator::push_shared(GenericObject *head, GenericObject *tail)
+{
+  unsigned long long top = SharedFreeList_.load(std::memory_order_relaxed);
+
+  do
+  {
+    tail->Next = untag(top);
+  } while (!SharedFreeList_.compare_exchange_weak(top, retag(head, top),
+                                                  std::memory_order_release,
+                                                  std::memory_order_relaxed));
+}
+
+  // adds a page to the lock-free free list (Reserve adds one even if the
+  // list has blocks, and faults it in before it's handed over)
+void ObjectAllocator::grow_shared(bool reserve)
+{
+  std::lock_guard<std::mutex> guard(PageLock_);
+
+  // another thread may have added a page (or freed a block) while we waited
+  if (!reserve && untag(SharedFreeList_.load(std::memory_order_acquire)))
+  {
+    return;
+  }
+
+  // segments the page onto the private free list, then hands the whole 
+  // chain over at once (the first block segmented is the end of the chain)
+  FreeList_ = nullptr;
+  allocate_new_page(reserve);
+
+  char *firstBlock = reinterpret_cast<char *>(PageList_) + clientConfig.FirstBlockOffset_;
+  push_shared(FreeList_, reinterpret_cast<GenericObject *>(firstBlock));
+  FreeList_ = nullptr;
+}
+
+  // the calling thread's counters
+StatStripe &ObjectAllocator::local_stripe(void)
+{
+  static thread_local unsigned stripe = nextStripe++ % STAT_STRIPES;
+  return StatStripes_[stripe];
+}
+
+  // the page page-affine allocations come from (0 if no page has a free block)
+PageInfo *ObjectAllocator::fullest_page(void) const
+{
+  while (FullestBin_ < FreeBins_.size() && !FreeBins_[FullestBin_])
+  {
+    FullestBin_++;
+  }
+  return FullestBin_ < FreeBins_.size() ? FreeBins_[FullestBin_] : nullptr;
+}
+
+  // puts a page at the front of the bin for its free block count (full pages aren't binned)
+void ObjectAllocator::bin_page(PageInfo *page)
+{
+  unsigned bin = page->capacity - page->inUse;
+  page->bin = bin;
+  page->binPrev = nullptr;
+  page->binNext = nullptr;
+  if (!bin)
+  {
+    return;
+  }
+
+  if (bin >= FreeBins_.size())
+  {
+    FreeBins_.resize(bin + 1, nullptr);
+  }
+  page->binNext = FreeBins_[bin];
+  if (page->binNext)
+  {
+    page->binNext->binPrev = page;
+  }
+  FreeBins_[bin] = page;
+  FullestBin_ = std::min(FullestBin_, bin);
+}
+
+  // takes a page out of whichever bin it's in
+void ObjectAllocator::unbin_page(PageInfo *page)
+{
+  if (!page->bin)
+  {
+    return;
+  }
+
+  if (page->binPrev)
+  {
+    page->binPrev->binNext = page->binNext;
+  }
+  else
+  {
+    FreeBins_[page->bin] = page->binNext;
+  }
+  if (page->binNext)
+  {
+    page->binNext->binPrev = page->binPrev;
+  }
+  page->bin = 0;
+}
+
+  // finds the lowest free bit a word at a time, clears it and returns its block
+char *ObjectAllocator::take_free_bit(PageInfo *page)
+{
+  unsigned words = static_cast<unsigned>(page->freeMap.size() / 8);
+  for (unsigned word = page->firstFree; word < words; word++)
+  {
+    unsigned long long bits;
+    std::memcpy(&bits, &page->freeMap[word * 8], sizeof(bits));
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+    bits = __builtin_bswap64(bits);
+#endif
+    if (!bits)
+    {
+      continue;
+    }
+
+    page->firstFree = word;
+    unsigned index = word * 64 + static_cast<unsigned>(__builtin_ctzll(bits));
+    char *block = page->page + clientConfig.FirstBlockOffset_ + index * clientConfig.BlockSize_;
+    set_block_free(block, page, false);
+    return block;
+  }
+  return nullptr; // the bins only hand out pages with a free block
+}
+
+  // sets the first capacity bits (and only those, so the bit scan never runs off the page)
+void ObjectAllocator::mark_all_free(PageInfo *page) const
+{
+  std::fill(page->freeMap.begin(), page->freeMap.end(), static_cast<unsigned char>(0));
+  std::fill(page->freeMap.begin(), page->freeMap.begin() + page->capacity / 8, static_cast<unsigned char>(0xFF));
+  if (page->capacity % 8)
+  {
+    page->freeMap[page->capacity / 8] = static_cast<unsigned char>((1u << (page->capacity % 8)) - 1);
+  }
+  page->firstFree = 0;
+}
+
+  // whether Allocate and Free can skip every mode and only pop and push
+  // (the instrumented build always times and counts its calls)
+bool ObjectAllocator::plain(void) const
+{
+#ifdef OA_INSTRUMENT
+  return false;
+#else
+  return !clientConfig.UseCPPMemManager_ && !clientConfig.LockFree_ && !Trace_ && !counting();
+#endif
+}
+
+  // whether Allocate and Free keep each page's live count and free map,
+  // which only the debug checks and page-affine pages need as they go
+bool ObjectAllocator::counting(void) const
+{
+  return clientConfig.DebugOn_ || clientConfig.PageAffine_;
+}
+
+  // works out the live counts and free maps Allocate and Free haven't been
+  // keeping: a page's carved blocks start out in use and every block on 
+  // the free list is then taken back off its page
+void ObjectAllocator::recount_pages(void) const
+{
+  if (counting())
+  {
+    return;
+  }
+
+  for (size_t i = 0; i < PageIndex_.size(); i++)
+  {
+    PageInfo *page = PageIndex_[i];
+    unsigned carved = carved_blocks(page);
+    page->inUse = carved;
+    mark_all_free(page);
+    std::fill(page->freeMap.begin(), page->freeMap.begin() + carved / 8, static_cast<unsigned char>(0));
+    if (carved % 8)
+    {
+      page->freeMap[carved / 8] &= static_cast<unsigned char>(~((1u << (carved % 8)) - 1));
+    }
+  }
+
+  PageInfo *page = nullptr;
+  for (GenericObject *node = FreeList_; node; node = node->Next)
+  {
+    page = page_of(reinterpret_cast<char *>(node), page);
+    page->inUse--;
+    set_block_free(reinterpret_cast<char *>(node), page, true);
+  }
+}
+
+  // whether only some blocks are guarded (the map is kept even while debugging is off)
+bool ObjectAllocator::sampling(void) const
+{
+  return clientConfig.SampleRate_ > 1 && !clientConfig.LockFree_;
+}
+
+  // a gap of 1 to 2 * SampleRate_ - 1 allocations, so one in SampleRate_ on average
+unsigned ObjectAllocator::next_sample_gap(void)
+{
+  SampleState_ ^= SampleState_ << 13;
+  SampleState_ ^= SampleState_ >> 17;
+  SampleState_ ^= SampleState_ << 5;
+  return 1 + SampleState_ % (2 * clientConfig.SampleRate_ - 1);
+}
+
+  // true if the block being allocated gets the debug patterns and checks
+bool ObjectAllocator::guard_block(char *block, PageInfo *page)
+{
+  if (!clientConfig.DebugOn_)
+  {
+    return false;
+  }
+  if (!sampling())
+  {
+    return true;
+  }
+
+  bool guarded = --SampleCountdown_ == 0;
+  if (guarded)
+  {
+    SampleCountdown_ = next_sample_gap();
+  }
+
+  unsigned index = block_index(block, page);
+  unsigned char mask = static_cast<unsigned char>(1u << (index % 8));
+  if (guarded)
+  {
+    page->sampleMap[index / 8] |= mask;
+  }
+  else
+  {
+    page->sampleMap[index / 8] &= static_cast<unsigned char>(~mask);
+  }
+  return guarded;
+}
+
+  // runs the debug checks on a block being freed if it was guarded, and finds
+  // its page (only called while counting, as there's nothing to find it for otherwise)
+PageInfo *ObjectAllocator::check_guarded_free(GenericObject *node, PageInfo *hint, bool *guarded)
+{
+  char *block = reinterpret_cast<char *>(node);
+  *guarded = false;
+
+  if (!clientConfig.DebugOn_)
+  {
+    // the bitmap knows a double free without any header
+    PageInfo *page = page_of(block, hint);
+    if (clientConfig.BitmapBlocks_ && page && !check_out_of_page(block, page) &&
+        !check_wrong_offset(block, page->page) && is_block_free(block, page))
+    {
+      throw OAException(OAException::E_MULTIPLE_FREE, "Freed multiple times");
+    }
+    return page;
+  }
+  if (sampling())
+  {
+    // only the pads and patterns are sampled, the boundary and the free
+    // map are checked on every free since they cost next to nothing
+    PageInfo *page = page_of(block, hint);
+    if (!is_block_sampled(block, page))
+    {
+      page = check_bad_location(block);
+      check_multiple_free(block, page);
+      return page;
+    }
+  }
+
+  *guarded = true;
+  return check_freelist(node);
+}
+
+  // reads the sample map (false for anything that isn't a block of the page)
+bool ObjectAllocator::is_block_sampled(char *block, const PageInfo *page) const
+{
+  if (!page || page->sampleMap.empty())
+  {
+    return false;
+  }
+  unsigned index = block_index(block, page);
+  return index < page->capacity && ((page->sampleMap[index / 8] >> (index % 8)) & 1);
+}
+
+PageInfo *ObjectAllocator::check_freelist(GenericObject *node)
+{
+  OA_TIME(ValidationTimes_);
+  char *nodeCopy = reinterpret_cast<char *>(node);
+
+  if (clientConfig.PadBytes_ != 0)
+  {
+    if (check_corruption(nodeCopy))
+    {
+      throw OAException(OAException::E_CORRUPTED_BLOCK, "Overrote padding");
+    }
+  }
+  PageInfo *page = check_bad_location(nodeCopy);
+  check_multiple_free(nodeCopy, page);
+
+  return page;
+}
+
+PageInfo *ObjectAllocator::check_bad_location(char * toCheck)
+{
+  // finds the page the block claims to be on, then makes sure
+  // it sits on one of that page's block boundaries
+  PageInfo *page = find_page(toCheck);
+
+  if (!page || check_out_of_page(toCheck, page) || check_wrong_offset(toCheck, page->page))
+  {
+    throw OAException(OAException::E_BAD_BOUNDARY, "Not freed inside a page");
+  }
+  return page;
+}
+
+void ObjectAllocator::check_multiple_free(char * toCheck, PageInfo *page)
+{
+  // the block's bit in the free map is set while it is on the freelist
+  if (is_block_free(toCheck, page))
+  {
+    throw OAException(OAException::E_MULTIPLE_FREE, "Freed multiple times");
+  }
+}
+
+bool ObjectAllocator::check_out_of_page(char * toCheck, const PageInfo *page)
+{
+  // checks to see if the data is under or over where the page it
+  if (toCheck < page->page || toCheck > (page->page + page->pageSize) - sizeof(void *))
+  {
+    return true;
+  }
+  else
+  {
+    return false;
+  }
+}
+
+bool ObjectAllocator::check_wrong_offset(char * toCheck, char * pageList)
+{ 
+  char *firstBlock = pageList + clientConfig.FirstBlockOffset_;
+
+  // anything in front of the first block can't be on a boundary
+  if (toCheck < firstBlock)
+  {
+    return true;
+  }
+
+  // sees if the difference is divisable by the block size
+  bool onBoundary;
+  block_number(static_cast<size_t>(toCheck - firstBlock), &onBoundary);
+  return !onBoundary;
+}
+
+bool ObjectAllocator::check_leak_in_header(char *node) const
+{
+  // checks the external struct's in use variable (a free block has none)
+  if (clientConfig.HBlockInfo_.type_ == OAConfig::hbExternal)
+  {
+    MemBlockInfo *info = *reinterpret_cast<MemBlockInfo **>(node);
+    return info && info->in_use;
+  }
+  else // checks the header's in use variable
+  {
+    node += (clientConfig.HBlockInfo_.size_ - 1);
+    return *node;
+  }
+  return false;
+}
+
+bool ObjectAllocator::check_corruption(char * toCheck) const
+{
+  // points to the padding before and after the data
+  char *firstPad  = toCheck - clientConfig.PadBytes_;
+  char *secondPad = toCheck + stats.ObjectSize_;
+
+  // tests to see if the padding has its correct pattern
+  return !PadKernels::Matches(firstPad, clientConfig.PadBytes_, PAD_PATTERN)
+      || !PadKernels::Matches(secondPad, clientConfig.PadBytes_, PAD_PATTERN);
+}
+
+// finds the page that contains the block, trying the hint first since
+// blocks next to each other on the free list are often on the same page
+PageInfo *ObjectAllocator::page_of(char *block, PageInfo *hint) const
+{
+  if (hint && block >= hint->page && block < hint->page + hint->pageSize)
+  {
+    return hint;
+  }
+  return find_page(block);
+}
+
+// orders blocks and pages by address for the page index
+bool ObjectAllocator::page_starts_after(const char *block, const PageInfo *page)
+{
+  return block < page->page;
+}
+
+// finds the page that contains the block (nullptr if there isn't one).
+// Masking the address down to its chunk finds the few pages that overlap
+// the chunk in one lookup, however many pages there are.
+PageInfo *ObjectAllocator::find_page(char *block) const
+{
+  uintptr_t chunk = reinterpret_cast<uintptr_t>(block) >> ChunkShift_;
+  typedef std::unordered_multimap<uintptr_t, PageInfo *>::const_iterator CHUNK_ITERATOR;
+  std::pair<CHUNK_ITERATOR, CHUNK_ITERATOR> pages = PageChunks_.equal_range(chunk);
+
+  for (CHUNK_ITERATOR it = pages.first; it != pages.second; ++it)
+  {
+    PageInfo *page = it->second;
+    if (block >= page->page && block < page->page + page->pageSize)
+    {
+      return page;
+    }
+  }
+  return nullptr;
+}
+
+// records the page under every chunk it overlaps. The chunks are the 
+// largest power of two no bigger than the biggest page, so a chunk only 
+// overlaps two or three pages; a page that's at least twice as big as a
+// chunk moves the map to bigger chunks (geometric growth does that a 
+// handful of times), which is built aside so a failure leaves it as it was
+void ObjectAllocator::index_page(PageInfo *page)
+{
+  unsigned shift = 0;
+  while ((page->pageSize >> shift) > 1)
+  {
+    shift++;
+  }
+
+  std::unordered_multimap<uintptr_t, PageInfo *> rebuilt;
+  std::unordered_multimap<uintptr_t, PageInfo *> *chunks = &PageChunks_;
+  if (shift > ChunkShift_)
+  {
+    chunks = &rebuilt;
+    for (size_t i = 0; i < PageIndex_.size(); i++)
+    {
+      uintptr_t start = reinterpret_cast<uintptr_t>(PageIndex_[i]->page);
+      for (uintptr_t chunk = start >> shift; chunk <= (start + PageIndex_[i]->pageSize - 1) >> shift; chunk++)
+      {
+        rebuilt.insert(std::make_pair(chunk, PageIndex_[i]));
+      }
+    }
+  }
+
+  uintptr_t start = reinterpret_cast<uintptr_t>(page->page);
+  for (uintptr_t chunk = start >> shift; chunk <= (start + page->pageSize - 1) >> shift; chunk++)
+  {
+    chunks->insert(std::make_pair(chunk, page));
+  }
+
+  if (chunks == &rebuilt)
+  {
+    PageChunks_.swap(rebuilt);
+    ChunkShift_ = shift;
+  }
+}
+
+// takes the page out of every chunk it overlaps (never throws)
+void ObjectAllocator::unindex_page(PageInfo *page)
+{
+  uintptr_t start = reinterpret_cast<uintptr_t>(page->page);
+  for (uintptr_t chunk = start >> ChunkShift_; chunk <= (start + page->pageSize - 1) >> ChunkShift_; chunk++)
+  {
+    typedef std::unordered_multimap<uintptr_t, PageInfo *>::iterator CHUNK_ITERATOR;
+    std::pair<CHUNK_ITERATOR, CHUNK_ITERATOR> pages = PageChunks_.equal_range(chunk);
+    for (CHUNK_ITERATOR it = pages.first; it != pages.second; ++it)
+    {
+      if (it->second == page)
+      {
+        PageChunks_.erase(it);
+        break;
+      }
+    }
+  }
+}
+
+// calculates which block on the page this is
+unsigned ObjectAllocator::block_index(char *block, const PageInfo *page) const
+{
+  char *firstBlock = page->page + clientConfig.FirstBlockOffset_;
+  bool onBoundary;
+  return block_number(static_cast<size_t>(block - firstBlock), &onBoundary);
+}
+
+// divides an offset from a page's first object by the block size, using
+// the reciprocal the constructor worked out (Lemire, Kaser and Kurz, 
+// "Faster Remainder by Direct Computation"), which is exact for every 
+// 32-bit offset. Bigger pages fall back to dividing.
+unsigned ObjectAllocator::block_number(size_t offset, bool *onBoundary) const
+{
+  unsigned long long reciprocal = clientConfig.BlockReciprocal_;
+
+  if (offset > 0xFFFFFFFFu || !reciprocal)
+  {
+    *onBoundary = offset % clientConfig.BlockSize_ == 0;
+    return static_cast<unsigned>(offset / clientConfig.BlockSize_);
+  }
+
+  // the low 64 bits of offset * reciprocal hold the remainder, scaled
+  unsigned long long n = offset;
+  *onBoundary = n * reciprocal <= reciprocal - 1;
+
+  // the high 64 bits are the quotient, built from two 32-bit halves
+  unsigned long long high = (reciprocal >> 32) * n;
+  unsigned long long low = ((reciprocal & 0xFFFFFFFFu) * n) >> 32;
+  return static_cast<unsigned>((high + low) >> 32);
+}
+
+// marks the block as free or in use in its page's free map
+void ObjectAllocator::set_block_free(char *block, PageInfo *page, bool isFree) const
+{
+  unsigned index = block_index(block, page);
+  unsigned char mask = static_cast<unsigned char>(1u << (index % 8));
+
+  if (isFree)
+  {
+    page->freeMap[index / 8] |= mask;
+    page->firstFree = std::min(page->firstFree, index / 64);
+  }
+  else
+  {
+    page->freeMap[index / 8] &= static_cast<unsigned char>(~mask);
+  }
+}
+
+// checks the block's bit in its page's free map
+bool ObjectAllocator::is_block_free(char *block, const PageInfo *page) const
+{
+  unsigned index = block_index(block, page);
+  return (page->freeMap[index / 8] >> (index % 8)) & 1;
+}
+
+// fills the leading and inter-block alignment bytes of a page
+void ObjectAllocator::write_align_bytes(char *page, unsigned capacity) const
+{
+  PadKernels::Fill(page + sizeof(void *), clientConfig.LeftAlignSize_, ALIGN_PATTERN);
+
+  char *block = create_offset(page);
+  for (unsigned i = 1; i < capacity; i++)
+  {
+    block += clientConfig.BlockSize_;
+    PadKernels::Fill(block - clientConfig.InterAlignSize_, clientConfig.InterAlignSize_, ALIGN_PATTERN);
+  }
+}
+
+// calculates where blocks start
+char * ObjectAllocator::create_offset(char * page) const
+{
+  return page + sizeof(void *) + clientConfig.LeftAlignSize_;
+}
+
+// calculates how many alignment bytes the page layout needs
+void ObjectAllocator::calculate_alignment(void)
+{
+  clientConfig.LeftAlignSize_ = 0;
+  clientConfig.InterAlignSize_ = 0;
+
+  // 0 and 1 both mean the blocks don't need aligning
+  if (clientConfig.Alignment_ <= 1)
+  {
+    return;
+  }
+
+  size_t alignment = clientConfig.Alignment_;
+  size_t leftSize = sizeof(void *) + clientConfig.HBlockInfo_.size_ + clientConfig.PadBytes_;
+  size_t interSize = stats.ObjectSize_ + clientConfig.PadBytes_ * 2 + clientConfig.HBlockInfo_.size_;
+
+  // pads the first block, then every block after it, up to the boundary
+  clientConfig.LeftAlignSize_ = static_cast<unsigned>((alignment - leftSize % alignment) % alignment);
+  clientConfig.InterAlignSize_ = static_cast<unsigned>((alignment - interSize % alignment) % alignment);
+}
+
+// works out the layout constants every page scan and free check uses
+void ObjectAllocator::calculate_layout(void)
+{
+  clientConfig.BlockSize_ = calculate_block_size();
+  clientConfig.FirstBlockOffset_ = sizeof(void *) + clientConfig.LeftAlignSize_
+                                 + clientConfig.HBlockInfo_.size_ + clientConfig.PadBytes_;
+
+  // ceil(2^64 / BlockSize_), 0 when that doesn't fit (a 1 byte block)
+  clientConfig.BlockReciprocal_ = 0;
+  if (clientConfig.BlockSize_ > 1)
+  {
+    clientConfig.BlockReciprocal_ = ~0ull / clientConfig.BlockSize_ + 1;
+  }
+}
+
+// calculates the size of a page that holds capacity blocks
+size_t ObjectAllocator::calculate_page_size(unsigned capacity) const
+{
+  if (!capacity)
+  {
+    return sizeof(void *) + clientConfig.LeftAlignSize_;
+  }
+
+  // there are no alignment bytes after the last block
+  return sizeof(void *) + clientConfig.LeftAlignSize_ 
+       + (clientConfig.BlockSize_ * capacity) - clientConfig.InterAlignSize_;
+}
+
+// works out how many blocks the next page holds from the growth policy
+unsigned ObjectAllocator::next_page_capacity(void) const
+{
+  return page_capacity(stats.PageCapacity_, !PageList_);
+}
+
+// how many blocks the page after one of last blocks holds (the first page
+// if first is set)
+unsigned ObjectAllocator::page_capacity(unsigned last, bool first) const
+{
+  const OAConfig::GrowthPolicy &growth = clientConfig.Growth_;
+
+  if (growth.type_ == OAConfig::gpGeometric && !first)
+  {
+    // doubles the newest page, as long as that stays under the cap (there's
+    // always one, so the doubling can't wrap around to an empty page)
+    unsigned most = growth.maxObjects_;
+    if (!most)
+    {
+      most = OAConfig::GrowthPolicy::DEFAULT_MAX_OBJECTS;
+    }
+    unsigned capacity = last;
+    if (capacity <= most / 2)
+    {
+      capacity *= 2;
+    }
+    else if (capacity < most)
+    {
+      capacity = most;
+    }
+    return capacity;
+  }
+
+  if (growth.type_ == OAConfig::gpPageBytes)
+  {
+    // as many blocks as fit in the target size, but always at least one
+    size_t fixedBytes = sizeof(void *) + clientConfig.LeftAlignSize_;
+    size_t fits = 0;
+    if (growth.pageBytes_ > fixedBytes)
+    {
+      fits = (growth.pageBytes_ - fixedBytes + clientConfig.InterAlignSize_) / clientConfig.BlockSize_;
+    }
+    return fits ? static_cast<unsigned>(fits) : 1;
+  }
+
+  return clientConfig.ObjectsPerPage_;
+}
+
+// calculates the size of a block (including the alignment bytes that 
+// separate it from the next one)
+size_t ObjectAllocator::calculate_block_size() const
+{
+  size_t headerSize = clientConfig.HBlockInfo_.size_;;
+  size_t padding = clientConfig.PadBytes_ * 2;
+
+  return stats.ObjectSize_ + padding + headerSize + clientConfig.InterAlignSize_;
+}
+
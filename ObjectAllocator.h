@@ -1,219 +1,577 @@
-//---------------------------------------------------------------------------
-#ifndef OBJECTALLOCATORH
-#define OBJECTALLOCATORH
-//---------------------------------------------------------------------------
-
-#include <string>
-#include <iostream>
-
-// If the client doesn't specify these:
-static const int DEFAULT_OBJECTS_PER_PAGE = 4;  
-static const int DEFAULT_MAX_PAGES = 3;
-
-class OAException
-{
-  public:
-			// Possible exception codes
-    enum OA_EXCEPTION 
-		{
-			E_NO_MEMORY,      // out of physical memory (operator new fails)
-			E_NO_PAGES,       // out of logical memory (max pages has been reached)
-			E_BAD_BOUNDARY,   // block address is on a page, but not on any block-boundary
-			E_MULTIPLE_FREE,  // block has already been freed
-			E_CORRUPTED_BLOCK // block has been corrupted (pad bytes have been overwritten)
-		};
-
-    OAException(OA_EXCEPTION ErrCode, const std::string& Message) : error_code_(ErrCode), message_(Message) {};
-
-    virtual ~OAException() {
-    }
-
-    OA_EXCEPTION code(void) const { 
-      return error_code_; 
-    }
-
-    virtual const char *what(void) const {
-      return message_.c_str();
-    }
-  private:  
-    OA_EXCEPTION error_code_;
-    std::string message_;
-};
-
-// ObjectAllocator configuration parameters
-struct OAConfig
-{
-	static const size_t BASIC_HEADER_SIZE = sizeof(unsigned) + 1; // allocation number + flags
-	static const size_t EXTERNAL_HEADER_SIZE = sizeof(void*);     // just a pointer
-
-	enum HBLOCK_TYPE{hbNone, hbBasic, hbExtended, hbExternal};
-	struct HeaderBlockInfo
-	{
-		HBLOCK_TYPE type_;
-		size_t size_;
-		size_t additional_;
-		HeaderBlockInfo(HBLOCK_TYPE type = hbNone, unsigned additional = 0) : type_(type), size_(0), additional_(additional)
-		{
-			if (type_ == hbBasic)
-				size_ = BASIC_HEADER_SIZE;
-			else if (type_ == hbExtended) // alloc # + use counter + flag byte + user-defined
-				size_ = sizeof(unsigned int) + sizeof(unsigned short) + sizeof(char) + additional_;
-			else if (type_ == hbExternal)
-				size_ = EXTERNAL_HEADER_SIZE;
-		};
-	};
-
-	OAConfig(bool UseCPPMemManager = false,
-					 unsigned ObjectsPerPage = DEFAULT_OBJECTS_PER_PAGE, 
-		       unsigned MaxPages = DEFAULT_MAX_PAGES, 
-					 bool DebugOn = false, 
-					 unsigned PadBytes = 0,
-					 const HeaderBlockInfo &HBInfo = HeaderBlockInfo(),
-					 unsigned Alignment = 0) : UseCPPMemManager_(UseCPPMemManager),
-																		 ObjectsPerPage_(ObjectsPerPage), 
-																		 MaxPages_(MaxPages), 
-					                           DebugOn_(DebugOn), 
-																		 PadBytes_(PadBytes),
-																		 HBlockInfo_(HBInfo),
-																		 Alignment_(Alignment)
-	{
-		HBlockInfo_ = HBInfo;
-		LeftAlignSize_ = 0;  
-		InterAlignSize_ = 0;
-	}
-
-	bool UseCPPMemManager_;   // by-pass the functionality of the OA and use new/delete
-  unsigned ObjectsPerPage_; // number of objects on each page
-  unsigned MaxPages_;       // maximum number of pages the OA can allocate (0=unlimited)
-	bool DebugOn_;            // enable/disable debugging code (signatures, checks, etc.)
-	unsigned PadBytes_;          // size of the left/right padding for each block
-	HeaderBlockInfo HBlockInfo_; // size of the header for each block (0=no headers)
-	unsigned Alignment_;      // address alignment of each block
-
-	unsigned LeftAlignSize_;  // number of alignment bytes required to align first block
-	unsigned InterAlignSize_; // number of alignment bytes required between remaining blocks
-};
-
-// ObjectAllocator statistical info
-struct OAStats
-{
-	OAStats(void) : ObjectSize_(0), PageSize_(0), FreeObjects_(0), ObjectsInUse_(0), PagesInUse_(0),
-                  MostObjects_(0), Allocations_(0), Deallocations_(0) {};
-
-	size_t ObjectSize_;      // size of each object
-	size_t PageSize_;        // size of a page including all headers, padding, etc.
-	unsigned FreeObjects_;   // number of objects on the free list
-	unsigned ObjectsInUse_;  // number of objects in use by client
-	unsigned PagesInUse_;    // number of pages allocated
-	unsigned MostObjects_;   // most objects in use by client at one time
-	unsigned Allocations_;   // total requests to allocate memory
-	unsigned Deallocations_; // total requests to free memory
-};
-
-// This allows us to easily treat raw objects as nodes in a linked list
-struct GenericObject
-{
-  GenericObject *Next;
-};
-
-struct MemBlockInfo
-{
-	bool in_use;        // Is the block free or in use?
-	char *label;        // A dynamically allocated NUL-terminated string
-	unsigned alloc_num; // The allocation number (count) of this block
-};
-
-// This memory manager class 
-class ObjectAllocator
-{
-  public:
-  		// Defined by the client (pointer to a block, size of block)
-		typedef void (*DUMPCALLBACK)(const void *, size_t);
-		typedef void (*VALIDATECALLBACK)(const void *, size_t);
-
-			// Predefined values for memory signatures
-		static const unsigned char UNALLOCATED_PATTERN = 0xAA;
-		static const unsigned char ALLOCATED_PATTERN = 0xBB;
-		static const unsigned char FREED_PATTERN = 0xCC;
-		static const unsigned char PAD_PATTERN = 0xDD;
-		static const unsigned char ALIGN_PATTERN = 0xEE;
-
-      // Creates the ObjectManager per the specified values
-      // Throws an exception if the construction fails. (Memory allocation problem)
-    ObjectAllocator(size_t ObjectSize, const OAConfig& config);
-
-      // Destroys the ObjectManager (never throws)
-    ~ObjectAllocator();
-
-      // Take an object from the free list and give it to the client (simulates new)
-      // Throws an exception if the object can't be allocated. (Memory allocation problem)
-    void *Allocate(const char *label = 0);
-
-      // Returns an object to the free list for the client (simulates delete)
-      // Throws an exception if the the object can't be freed. (Invalid object)
-    void Free(void *Object);
-
-      // Calls the callback fn for each block still in use
-    unsigned DumpMemoryInUse(DUMPCALLBACK fn) const;
-
-      // Calls the callback fn for each block that is potentially corrupted
-		unsigned ValidatePages(VALIDATECALLBACK fn) const;
-
-			// Frees all empty pages (extra credit)
-		unsigned FreeEmptyPages(void);
-
-			// Returns true if FreeEmptyPages and alignments are implemented
-		static bool ImplementedExtraCredit(void);
-
-      // Testing/Debugging/Statistic methods
-    void SetDebugState(bool State);       // true=enable, false=disable
-    const void *GetFreeList(void) const;  // returns a pointer to the internal free list
-    const void *GetPageList(void) const;  // returns a pointer to the internal page list
-		OAConfig GetConfig(void) const;       // returns the configuration parameters
-		OAStats GetStats(void) const;         // returns the statistics for the allocator
-
-  private:
-  	  // Some "suggested" members (only a suggestion!)
-    GenericObject *PageList_;            //!< the beginning of the list of pages
-    GenericObject *FreeList_;            //!< the beginning of the list of objects
-    void allocate_new_page(void);        //!< allocates another page of objects
-    void allocate_empty_page(void);      //!< creates a page with nothing in it
-    void segment_page(void);             //!< segments the page into blocks
-    GenericObject* 
-    take_off_freelist(const char *label);//!< takes Object off the list
-    void put_on_freelist(void *Object);  //!< puts space back on the freelist
-    void check_freelist
-    (GenericObject *node);               //!< error checks the free function
-    void check_bad_location              //!< checks to see if the client tried
-    (char *toCheck, char *pageList);     //!< to free memory in a bad location
-    void check_multiple_free             //!< checks to see if something
-    (char *toCheck, char *freeList);     //!< has been freed multiple times
-    bool check_out_of_page               //!< checks to see if the free location
-    (char *toCheck, char *pageList);     //!< is not in the page
-    bool check_wrong_offset              //!< checks to see if the free location
-    (char *toCheck, char *pageList);     //!< is not aligned with the page
-    bool check_leak_in_header            //!< checks to see if there is a leak 
-    (char *node) const;       
-    bool check_corruption                //!< checks to see if pad bytes are overritten
-    (char *toCheck) const;                               
-    char *create_offset(char *page)      //!< creates a pointer to the correct offset
-    const;                               
-    size_t calculate_page_size(void);    //!< calculates what the size of a page should be
-    size_t calculate_block_size(void)    //!< calculates what size a block should be
-    const;
-    void add_to_page(void);              //!< Function used to add data to a page
-    char *make_block(bool makePrev);     //!< creates a block of memory          
-    void configure_header
-    (char *, bool allocated, bool freed,
-    const char *label = nullptr);        // configures the header
-    OAConfig clientConfig;               // Configuration for the manager
-    OAStats stats;                       // stats for debug purposes
-    MemBlockInfo info;                   // additional block information
-    unsigned blockIter = 0;              // Tracks where to add data
-
-      // Make private to prevent copy construction and assignment
-    ObjectAllocator(const ObjectAllocator &oa);
-    ObjectAllocator &operator=(const ObjectAllocator &oa);
-};
-
-#endif
+//---------------------------------------------------------------------------
+#ifndef OBJECTALLOCATORH
+#define OBJECTALLOCATORH
+//---------------------------------------------------------------------------
+
+#include <string>
+#include <iostream>
+#include <vector>
+#include <atomic>
+#include <mutex>
+#include <set>
+#include <map>
+#include <unordered_map>
+#include <cstring>
+#include <cstdint>
+
+// If the client doesn't specify these:
+static const int DEFAULT_OBJECTS_PER_PAGE = 4;  
+static const int DEFAULT_MAX_PAGES = 3;
+
+class PageSource;
+class OATraceWriter;
+
+class OAException
+{
+  public:
+			// Possible exception codes
+    enum OA_EXCEPTION 
+		{
+			E_NO_MEMORY,      // out of physical memory (operator new fails)
+			E_NO_PAGES,       // out of logical memory (max pages has been reached)
+			E_BAD_BOUNDARY,   // block address is on a page, but not on any block-boundary
+			E_MULTIPLE_FREE,  // block has already been freed
+			E_CORRUPTED_BLOCK // block has been corrupted (pad bytes have been overwritten)
+		};
+
+    OAException(OA_EXCEPTION ErrCode, const std::string& Message) : error_code_(ErrCode), message_(Message) {};
+
+    virtual ~OAException() {
+    }
+
+    OA_EXCEPTION code(void) const { 
+      return error_code_; 
+    }
+
+    virtual const char *what(void) const {
+      return message_.c_str();
+    }
+  private:  
+    OA_EXCEPTION error_code_;
+    std::string message_;
+};
+
+// ObjectAllocator configuration parameters
+struct OAConfig
+{
+	static const size_t BASIC_HEADER_SIZE = sizeof(unsigned) + 1; // allocation number + flags
+	static const size_t EXTERNAL_HEADER_SIZE = sizeof(void*);     // just a pointer
+
+	enum HBLOCK_TYPE{hbNone, hbBasic, hbExtended, hbExternal};
+	struct HeaderBlockInfo
+	{
+		HBLOCK_TYPE type_;
+		size_t size_;
+		size_t additional_;
+		HeaderBlockInfo(HBLOCK_TYPE type = hbNone, unsigned additional = 0) : type_(type), size_(0), additional_(additional)
+		{
+			if (type_ == hbBasic)
+				size_ = BASIC_HEADER_SIZE;
+			else if (type_ == hbExtended) // alloc # + use counter + flag byte + user-defined
+				size_ = sizeof(unsigned int) + sizeof(unsigned short) + sizeof(char) + additional_;
+			else if (type_ == hbExternal)
+				size_ = EXTERNAL_HEADER_SIZE;
+		};
+	};
+
+	enum GROWTH_TYPE{gpFixed, gpGeometric, gpPageBytes};
+	struct GrowthPolicy
+	{
+		static const unsigned DEFAULT_MAX_OBJECTS = 65536; // the cap gpGeometric pages get if none is given
+
+		GROWTH_TYPE type_;
+		unsigned maxObjects_; // gpGeometric: most objects on one page (0=DEFAULT_MAX_OBJECTS)
+		size_t pageBytes_;    // gpPageBytes: how big each page should be
+		GrowthPolicy(GROWTH_TYPE type = gpFixed, size_t limit = 0) : type_(type), maxObjects_(0), pageBytes_(0)
+		{
+			if (type_ == gpGeometric)
+				maxObjects_ = static_cast<unsigned>(limit);
+			else if (type_ == gpPageBytes)
+				pageBytes_ = limit;
+		};
+	};
+
+	OAConfig(bool UseCPPMemManager = false,
+					 unsigned ObjectsPerPage = DEFAULT_OBJECTS_PER_PAGE, 
+		       unsigned MaxPages = DEFAULT_MAX_PAGES, 
+					 bool DebugOn = false, 
+					 unsigned PadBytes = 0,
+					 const HeaderBlockInfo &HBInfo = HeaderBlockInfo(),
+					 unsigned Alignment = 0,
+					 bool LockFree = false,
+					 PageSource *Source = 0,
+					 const GrowthPolicy &Growth = GrowthPolicy(),
+					 bool LazyPages = false,
+					 unsigned SampleRate = 0,
+					 bool PageAffine = false,
+					 bool BitmapBlocks = false) : UseCPPMemManager_(UseCPPMemManager),
+																		 ObjectsPerPage_(ObjectsPerPage), 
+																		 MaxPages_(MaxPages), 
+					                           DebugOn_(DebugOn), 
+																		 PadBytes_(PadBytes),
+																		 HBlockInfo_(HBInfo),
+																		 Alignment_(Alignment),
+																		 LockFree_(LockFree),
+																		 PageSource_(Source),
+																		 Growth_(Growth),
+																		 LazyPages_(LazyPages),
+																		 SampleRate_(SampleRate),
+																		 PageAffine_(PageAffine),
+																		 BitmapBlocks_(BitmapBlocks)
+	{
+		HBlockInfo_ = HBInfo;
+		LeftAlignSize_ = 0;  
+		InterAlignSize_ = 0;
+		BlockSize_ = 0;
+		FirstBlockOffset_ = 0;
+		BlockReciprocal_ = 0;
+	}
+
+	bool UseCPPMemManager_;   // by-pass the functionality of the OA and use new/delete
+  unsigned ObjectsPerPage_; // number of objects on each page (the first page, see Growth_)
+  unsigned MaxPages_;       // maximum number of pages the OA can allocate (0=unlimited)
+	bool DebugOn_;            // enable/disable debugging code (signatures, checks, etc.)
+	unsigned PadBytes_;          // size of the left/right padding for each block
+	HeaderBlockInfo HBlockInfo_; // size of the header for each block (0=no headers)
+	unsigned Alignment_;      // address alignment of each block
+
+	unsigned LeftAlignSize_;  // number of alignment bytes required to align first block
+	unsigned InterAlignSize_; // number of alignment bytes required between remaining blocks
+
+	size_t BlockSize_;        // bytes from one block to the next (set by the allocator)
+	size_t FirstBlockOffset_; // bytes from the start of a page to its first object (set by the allocator)
+	unsigned long long BlockReciprocal_; // ceil(2^64 / BlockSize_) for division-free offset checks
+
+	bool LockFree_;           // share one lock-free free list between threads (see ObjectAllocator)
+	PageSource *PageSource_;  // where page memory comes from (0=the heap, see PageSource.h)
+	GrowthPolicy Growth_;     // how many objects later pages hold (gpFixed=ObjectsPerPage_,
+	                          // gpGeometric=double the last page, gpPageBytes=fill pageBytes_)
+	bool LazyPages_;          // carve blocks off new pages as they're needed (not with LockFree_)
+	unsigned SampleRate_;     // with DebugOn_, guard about 1 in SampleRate_ allocations (0 or 1=all,
+	                          // not with LockFree_); the rest skip the patterns and pad checks
+	bool PageAffine_;         // keep a free list per page and allocate from the fullest page
+	                          // (not with LockFree_, and pages are segmented whole)
+	bool BitmapBlocks_;       // find free blocks in the page bitmaps instead of free lists, so
+	                          // leaks and double frees are found without headers (PageAffine_ too)
+};
+
+// ObjectAllocator statistical info
+struct OAStats
+{
+	OAStats(void) : ObjectSize_(0), PageSize_(0), FreeObjects_(0), ObjectsInUse_(0), PagesInUse_(0),
+                  MostObjects_(0), Allocations_(0), Deallocations_(0), PageCapacity_(0) {};
+
+	size_t ObjectSize_;      // size of each object
+	size_t PageSize_;        // size of the newest page including all headers, padding, etc.
+	unsigned FreeObjects_;   // number of objects on the free list
+	unsigned ObjectsInUse_;  // number of objects in use by client
+	unsigned PagesInUse_;    // number of pages allocated
+	unsigned MostObjects_;   // most objects in use by client at one time
+	unsigned Allocations_;   // total requests to allocate memory
+	unsigned Deallocations_; // total requests to free memory
+	unsigned PageCapacity_;  // number of objects the newest page holds
+};
+
+// This allows us to easily treat raw objects as nodes in a linked list
+struct GenericObject
+{
+  GenericObject *Next;
+};
+
+struct MemBlockInfo
+{
+	bool in_use;        // Is the block free or in use?
+	char *label;        // A dynamically allocated NUL-terminated string
+	unsigned alloc_num; // The allocation number (count) of this block
+};
+
+// Bookkeeping kept beside each page so the page layout itself is untouched
+struct PageInfo
+{
+  char *memory;                       // what the page source returned for the page
+  size_t size;                        // how many bytes were asked of the page source
+  size_t pageSize;                    // size of the page itself
+  unsigned capacity;                  // number of blocks on the page
+  char *page;                         // start of the page this describes
+  // kept by Allocate and Free only while debugging or PageAffine_, worked out when needed otherwise
+  unsigned inUse;                     // number of blocks the client holds
+  std::vector<unsigned char> freeMap; // one bit per block, set while it's free (in 64-bit words)
+  std::vector<unsigned char> sampleMap; // one bit per block, set while it's guarded (SampleRate_)
+  GenericObject *freeList;            // the page's free blocks (PageAffine_)
+  unsigned bin;                       // free blocks when last binned (0=full, in no bin)
+  unsigned firstFree;                 // no free block in the freeMap words before this (BitmapBlocks_)
+  bool uncarved;                      // waiting in ReleasedPages_ to be carved (again)
+  unsigned carved;                    // blocks set up so far (PageAffine_, the rest go by BumpPage_)
+  PageInfo *binPrev;                  // the neighbours in that bin
+  PageInfo *binNext;
+};
+
+// How full one page is, from its bookkeeping
+struct OAPageOccupancy
+{
+  const void *Page_;      // start of the page
+  unsigned Capacity_;     // number of blocks on the page
+  unsigned InUse_;        // number of blocks the client holds
+  unsigned FreeListRank_; // order Allocate reaches the page in (NOT_ON_FREE_LIST if it won't)
+};
+
+// Occupancy of every page, for tuning ObjectsPerPage_/MaxPages_ and seeing
+// what FreeEmptyPages would give back
+struct OAOccupancy
+{
+  static const unsigned BUCKETS = 10;
+  static const unsigned NOT_ON_FREE_LIST = ~0u;
+
+  OAOccupancy(void) : EmptyPages_(0), FullPages_(0), ReclaimableBytes_(0), FreeListRuns_(0)
+  {
+    for (unsigned i = 0; i < BUCKETS; i++)
+      Histogram_[i] = 0;
+  };
+
+  std::vector<OAPageOccupancy> Pages_; // every page, newest first (the page list order)
+  unsigned Histogram_[BUCKETS];        // pages holding [i/BUCKETS, (i+1)/BUCKETS) of their blocks (full in the last)
+  unsigned EmptyPages_;                // pages with no blocks in use
+  unsigned FullPages_;                 // pages with no free blocks
+  size_t ReclaimableBytes_;            // memory FreeEmptyPages would give back
+  unsigned FreeListRuns_;              // stretches of the free list that stay on one page
+};
+
+// How long one kind of call took, in log2 buckets of nanoseconds
+struct OAHistogram
+{
+  static const unsigned BUCKETS = 32;
+
+  OAHistogram(void) : Calls_(0), TotalNs_(0)
+  {
+    for (unsigned i = 0; i < BUCKETS; i++)
+      Buckets_[i] = 0;
+  };
+
+  unsigned long long Buckets_[BUCKETS]; // calls that took [2^i, 2^(i+1)) ns (bucket 0 from 0, the last has the rest)
+  unsigned long long Calls_;            // number of calls timed
+  unsigned long long TotalNs_;          // time spent in all of them
+};
+
+// Where the allocator's time goes. Only collected when built with 
+// OA_INSTRUMENT defined; otherwise it's never touched and the snapshot
+// comes back with Enabled_ false.
+struct OAInstrumentation
+{
+  OAInstrumentation(void) : Enabled_(false) {};
+
+  bool Enabled_;              // the allocator was built with OA_INSTRUMENT
+  OAHistogram Allocate_;      // whole Allocate calls
+  OAHistogram Free_;          // whole Free calls
+  OAHistogram PageGrowth_;    // adding a page (within Allocate)
+  OAHistogram Validation_;    // the debug checks on Free
+  OAHistogram HeaderSetup_;   // writing block headers on Allocate and Free
+  std::map<std::string, unsigned> LabelCounts_; // allocations made with each label
+};
+
+#ifdef OA_INSTRUMENT
+// The live form of an OAHistogram, safe to update from any thread
+struct OAHistogramCounters
+{
+  OAHistogramCounters(void);
+  void record(unsigned long long ns);        // adds one call
+  void copy_to(OAHistogram &histogram) const; // takes a snapshot
+  void take(OAHistogramCounters &other);      // moves other's counts here
+
+  std::atomic<unsigned long long> buckets[OAHistogram::BUCKETS];
+  std::atomic<unsigned long long> calls;
+  std::atomic<unsigned long long> totalNs;
+};
+#endif
+
+// Allocation/free counts for the threads that hash to it (LockFree_ mode),
+// padded out so two stripes don't share a cache line
+struct StatStripe
+{
+  StatStripe(void) : Allocations_(0), Deallocations_(0) {};
+
+  std::atomic<unsigned> Allocations_;
+  std::atomic<unsigned> Deallocations_;
+  char pad_[64 - 2 * sizeof(std::atomic<unsigned>)];
+};
+
+// This memory manager class 
+//
+// With OAConfig::LockFree_ set, any number of threads may Allocate and Free
+// at once: the free list is a lock-free stack whose head carries an ABA
+// tag, page growth is serialized by a mutex, and the counters are striped
+// across threads and summed by GetStats. The per-page live counts aren't
+// kept in that mode, so FreeEmptyPages does nothing. With DebugOn_ the
+// free maps are, under the page growth mutex, so Free still makes every
+// check (which serializes a debug allocator, and debugging has to be on
+// before the first block is handed out). DumpMemoryInUse and ValidatePages
+// must not race with other calls.
+//
+// Otherwise only one thread may use the allocator at a time, except for
+// FreeDeferred, which any thread may call: the objects wait on a lock-free
+// queue until the owner's next Allocate frees them all at once. Until
+// then they still count (and are dumped) as in use.
+class ObjectAllocator
+{
+  public:
+  		// Defined by the client (pointer to a block, size of block)
+		typedef void (*DUMPCALLBACK)(const void *, size_t);
+		typedef void (*VALIDATECALLBACK)(const void *, size_t);
+
+			// Predefined values for memory signatures
+		static const unsigned char UNALLOCATED_PATTERN = 0xAA;
+		static const unsigned char ALLOCATED_PATTERN = 0xBB;
+		static const unsigned char FREED_PATTERN = 0xCC;
+		static const unsigned char PAD_PATTERN = 0xDD;
+		static const unsigned char ALIGN_PATTERN = 0xEE;
+
+			// How the parallel sweeps call back: on the calling thread in page
+			// order (as the serial ones do), or from the workers as blocks are found
+		enum CALLBACK_ORDER {coPageOrder, coConcurrent};
+
+      // Creates the ObjectManager per the specified values
+      // Throws an exception if the construction fails. (Memory allocation problem)
+    ObjectAllocator(size_t ObjectSize, const OAConfig& config);
+
+      // Destroys the ObjectManager (never throws)
+    ~ObjectAllocator();
+
+      // Takes over another allocator's pages, blocks and counters, leaving it
+      // with none, so it can only be destroyed or assigned to (never throws)
+    ObjectAllocator(ObjectAllocator &&oa);
+    ObjectAllocator &operator=(ObjectAllocator &&oa);
+
+      // Take an object from the free list and give it to the client (simulates new)
+      // Throws an exception if the object can't be allocated. (Memory allocation problem)
+    void *Allocate(const char *label = 0);
+
+      // Returns an object to the free list for the client (simulates delete)
+      // Throws an exception if the the object can't be freed. (Invalid object)
+    void Free(void *Object);
+
+      // Queues an object for the owner to free (safe from any thread, see the .cpp)
+    void FreeDeferred(void *Object);
+
+      // Takes n objects off the free list at once and stores them in out
+      // Throws an exception if all n can't be allocated (none are allocated then)
+    void AllocateBatch(void **out, size_t n, const char *label = 0);
+
+      // Returns n objects to the free list at once
+      // Throws an exception if an object can't be freed (the ones before it are)
+    void FreeBatch(void **in, size_t n);
+
+      // Calls the callback fn for each block still in use
+    unsigned DumpMemoryInUse(DUMPCALLBACK fn) const;
+
+      // Calls the callback fn for each block that is potentially corrupted
+		unsigned ValidatePages(VALIDATECALLBACK fn) const;
+
+      // Checks the pads of up to maxBlocks blocks, carrying on where the last call stopped
+    unsigned ValidatePagesIncremental(VALIDATECALLBACK fn, unsigned maxBlocks);
+
+      // DumpMemoryInUse and ValidatePages with the pages split across threads (0=one per core)
+    unsigned DumpMemoryInUseParallel(DUMPCALLBACK fn, unsigned threads = 0,
+                                     CALLBACK_ORDER order = coPageOrder) const;
+    unsigned ValidatePagesParallel(VALIDATECALLBACK fn, unsigned threads = 0,
+                                   CALLBACK_ORDER order = coPageOrder) const;
+
+      // Reports how full each page is (empty in LockFree_ mode, which doesn't count)
+    OAOccupancy GetOccupancy(void) const;
+
+			// Frees all empty pages (extra credit)
+		unsigned FreeEmptyPages(void);
+
+			// Takes back every block at once, without walking them (arena style)
+		unsigned ReleaseAll(void);
+
+			// Adds pages up front until Objects blocks are free, and faults them in
+			// Throws an exception if a page can't be added (the ones added are kept)
+		unsigned Reserve(unsigned Objects);
+
+			// true if Object lies on one of this allocator's pages (never with UseCPPMemManager_)
+		bool Owns(const void *Object) const;
+
+			// Records every Allocate and Free into trace (0 stops recording, see OATrace.h)
+		void SetTrace(OATraceWriter *trace);
+
+			// Returns true if FreeEmptyPages and alignments are implemented
+		static bool ImplementedExtraCredit(void);
+
+      // Testing/Debugging/Statistic methods
+    void SetDebugState(bool State);       // true=enable, false=disable
+    const void *GetFreeList(void) const;  // returns a pointer to the internal free list
+    const void *GetPageList(void) const;  // returns a pointer to the internal page list
+		OAConfig GetConfig(void) const;       // returns the configuration parameters
+		OAStats GetStats(void) const;         // returns the statistics for the allocator
+		OAInstrumentation GetInstrumentation(void) const; // timings and label counts (OA_INSTRUMENT builds)
+
+  private:
+  	  // Some "suggested" members (only a suggestion!)
+    GenericObject *PageList_;            //!< the beginning of the list of pages
+    GenericObject *FreeList_;            //!< the beginning of the list of objects
+    std::vector<PageInfo *> PageIndex_;  //!< page bookkeeping, sorted by address
+    std::unordered_multimap<uintptr_t, PageInfo *>
+    PageChunks_;                         //!< the pages on each 2^ChunkShift_ chunk of address space
+    unsigned ChunkShift_;                //!< log2 of the chunk size (no page is smaller than a chunk)
+    std::atomic<unsigned long long>
+    SharedFreeList_;                     //!< lock-free free list head + ABA tag
+    mutable std::mutex PageLock_;        //!< serializes lock-free page growth
+    std::atomic<GenericObject *>
+    DeferredFrees_;                      //!< blocks other threads queued with FreeDeferred
+    OATraceWriter *Trace_;               //!< where calls are recorded (0=nowhere)
+    bool Plain_;                         //!< Allocate and Free only pop and push (see plain)
+    bool plain(void) const;              //!< whether no mode needs more than a pop and a push
+    void *allocate_block                 //!< Allocate, without the trace
+    (const char *label);
+    void push_deferred                   //!< pushes a chain onto DeferredFrees_
+    (GenericObject *head, GenericObject *tail);
+    void drain_deferred(void);           //!< frees everything on DeferredFrees_
+    struct LabelLess                     //!< orders interned labels by their text
+    {
+      bool operator()(const char *left, const char *right) const { return std::strcmp(left, right) < 0; }
+    };
+    std::vector<MemBlockInfo *> InfoSlabs_; //!< slabs the external header records come from
+    std::vector<MemBlockInfo *> FreeInfos_; //!< records given back since ReleaseAll, reused first
+    std::vector<unsigned> InfoSlabSizes_; //!< number of records in each slab
+    size_t InfoRecords_;                 //!< number of records in all the slabs
+    size_t InfoSlab_;                    //!< the slab records are being handed out from
+    unsigned InfoNext_;                  //!< the next record to hand out of that slab
+    size_t InfoUnused_;                  //!< records on the slabs not handed out since ReleaseAll
+#ifdef OA_INSTRUMENT
+    OAHistogramCounters AllocateTimes_;  //!< see OAInstrumentation
+    OAHistogramCounters FreeTimes_;
+    OAHistogramCounters GrowthTimes_;
+    OAHistogramCounters ValidationTimes_;
+    OAHistogramCounters HeaderTimes_;
+    std::map<std::string, unsigned>
+    LabelCounts_;                        //!< allocations made with each label
+    mutable std::mutex LabelLock_;       //!< guards LabelCounts_
+#endif
+    std::set<const char *, LabelLess>
+    Labels_;                             //!< one copy of every label seen (external headers)
+    std::mutex InfoLock_;                //!< guards the records and labels in lock-free mode
+    MemBlockInfo *acquire_info(void);    //!< takes a record off the slabs
+    void add_info_slab(void);            //!< adds a slab of records for the newest page
+    void release_info(MemBlockInfo *info); //!< puts a record back for reuse
+    char *intern_label                   //!< finds (or stores) the shared copy of a label
+    (const char *label);
+    StatStripe *StatStripes_;            //!< striped counters for lock-free mode
+    std::atomic<unsigned> AllocNumber_;  //!< allocation numbers for lock-free headers
+    void *allocate_shared                //!< Allocate for lock-free mode
+    (const char *label);
+    void free_shared(void *Object);      //!< Free for lock-free mode
+    GenericObject *pop_shared(void);     //!< pops the lock-free free list
+    void push_shared                     //!< pushes a chain onto the lock-free free list
+    (GenericObject *head, GenericObject *tail);
+    void grow_shared                     //!< adds a page to the lock-free free list
+    (bool reserve = false);
+    StatStripe &local_stripe(void);      //!< the calling thread's counters
+    GenericObject *ValidateCursor_;      //!< the page ValidatePagesIncremental resumes on (0=start over)
+    unsigned ValidateBlock_;             //!< the block on that page it resumes at
+    std::vector<PageInfo *> FreeBins_;   //!< pages by how many free blocks they have (PageAffine_)
+    mutable unsigned FullestBin_;        //!< no bin below this has a page in it
+    PageInfo *fullest_page(void) const;  //!< the page with the fewest free blocks, but some
+    void bin_page(PageInfo *page);       //!< files a page under its free block count
+    char *take_free_bit                  //!< claims the first free block in a page's bitmap
+    (PageInfo *page);
+    void mark_all_free                   //!< sets the free bit of every block on a page
+    (PageInfo *page) const;
+    bool counting(void) const;           //!< whether Allocate and Free keep the page counts
+    void recount_pages(void) const;      //!< works out the page counts when they aren't kept
+    void unbin_page(PageInfo *page);     //!< takes a page out of its bin
+    PageInfo *BumpPage_;                 //!< the page blocks are being carved from (LazyPages_)
+    unsigned BumpNext_;                  //!< the next block to carve off BumpPage_
+    unsigned SampleCountdown_;           //!< allocations until the next guarded one (SampleRate_)
+    unsigned SampleState_;               //!< xorshift state for the sampling gaps
+    bool sampling(void) const;           //!< whether only some blocks are guarded
+    unsigned next_sample_gap(void);      //!< draws the allocations until the next guarded one
+    bool guard_block                     //!< decides if a block being allocated is guarded
+    (char *block, PageInfo *page);
+    PageInfo *check_guarded_free         //!< checks a block being freed if it was guarded
+    (GenericObject *node, PageInfo *hint, bool *guarded);
+    bool is_block_sampled                //!< reads the sample map of a block
+    (char *block, const PageInfo *page) const;
+    void allocate_new_page               //!< allocates another page of objects
+    (bool reserve = false);
+    std::vector<PageInfo *> ReleasedPages_; //!< pages waiting to be carved (after ReleaseAll, or reserved lazily)
+    bool carving(void) const;            //!< whether blocks still come from carve_block
+    void carve_block(void);              //!< puts the next uncarved block on the free list
+    char *carve_page_block               //!< sets up the next block of a page (PageAffine_)
+    (PageInfo *page);
+    unsigned carved_blocks               //!< how many of a page's blocks have been set up
+    (const PageInfo *page) const;
+    enum SWEEP_TYPE {swLeaks, swCorruption};
+    unsigned sweep_page                  //!< checks every block of a page for leaks or corruption
+    (char *page, SWEEP_TYPE type, DUMPCALLBACK fn, std::vector<char *> *found) const;
+    unsigned sweep_parallel              //!< sweeps the pages on several threads
+    (SWEEP_TYPE type, DUMPCALLBACK fn, unsigned threads, CALLBACK_ORDER order) const;
+    void allocate_empty_page             //!< creates a page with nothing in it
+    (bool reserve);
+    static void prefault                 //!< touches every OS page of new memory
+    (char *memory, size_t size);
+    void segment_page(void);             //!< segments the page into blocks
+    GenericObject* 
+    take_off_freelist(const char *label);//!< takes Object off the list
+    void put_on_freelist(void *Object);  //!< puts space back on the freelist
+    PageInfo *check_freelist
+    (GenericObject *node);               //!< error checks the free function
+    PageInfo *check_bad_location         //!< checks to see if the client tried
+    (char *toCheck);                     //!< to free memory in a bad location
+    void check_multiple_free             //!< checks to see if something
+    (char *toCheck, PageInfo *page);     //!< has been freed multiple times
+    bool check_out_of_page               //!< checks to see if the free location
+    (char *toCheck, const PageInfo *page); //!< is not in the page
+    bool check_wrong_offset              //!< checks to see if the free location
+    (char *toCheck, char *pageList);     //!< is not aligned with the page
+    bool check_leak_in_header            //!< checks to see if there is a leak 
+    (char *node) const;       
+    bool check_corruption                //!< checks to see if pad bytes are overritten
+    (char *toCheck) const;                               
+    PageInfo *find_page                  //!< finds the page a block lives on
+    (char *block) const;
+    void index_page(PageInfo *page);     //!< records a page under the chunks it covers
+    void unindex_page(PageInfo *page);   //!< forgets the chunks a page covers
+    PageInfo *page_of                    //!< finds the page, trying the hint first
+    (char *block, PageInfo *hint) const;
+    static bool page_starts_after        //!< orders the page index by address
+    (const char *block, const PageInfo *page);
+    unsigned block_index                 //!< index of a block within its page
+    (char *block, const PageInfo *page) const;
+    void set_block_free                  //!< updates the free map of a block
+    (char *block, PageInfo *page, bool isFree) const;
+    bool is_block_free                   //!< reads the free map of a block
+    (char *block, const PageInfo *page) const;
+    char *create_offset(char *page)      //!< creates a pointer to the correct offset
+    const;                               
+    void write_align_bytes               //!< fills a page's alignment bytes
+    (char *page, unsigned capacity) const;
+    void calculate_alignment(void);      //!< calculates the left/inter alignment sizes
+    void calculate_layout(void);         //!< calculates the block size, first block and reciprocal
+    unsigned block_number                //!< divides an offset by the block size
+    (size_t offset, bool *onBoundary) const;
+    size_t calculate_page_size           //!< calculates what the size of a page should be
+    (unsigned capacity) const;
+    unsigned next_page_capacity(void)    //!< how many blocks the next page gets
+    const;
+    unsigned page_capacity               //!< how many blocks the page after one of last blocks gets
+    (unsigned last, bool first) const;
+    size_t calculate_block_size(void)    //!< calculates what size a block should be
+    const;
+    void add_to_page(void);              //!< Function used to add data to a page
+    char *make_block(bool makePrev);     //!< creates a block of memory          
+    void configure_header
+    (char *, bool allocated, bool freed,
+    const char *label = nullptr,
+    unsigned allocNum = 0);              // configures the header
+    OAConfig clientConfig;               // Configuration for the manager
+    OAStats stats;                       // stats for debug purposes
+    MemBlockInfo info;                   // additional block information
+    unsigned blockIter = 0;              // Tracks where to add data
+    void take_over(ObjectAllocator &oa); //!< moves everything oa owns here
+    void release_memory(void);           //!< gives back the pages, records and labels
+
+      // Make private to prevent copy construction and assignment
+    ObjectAllocator(const ObjectAllocator &oa);
+    ObjectAllocator &operator=(const ObjectAllocator &oa);
+};
+
+#endif
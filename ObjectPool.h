@@ -0,0 +1,378 @@
+//---------------------------------------------------------------------------
+#ifndef OBJECTPOOLH
+#define OBJECTPOOLH
+//---------------------------------------------------------------------------
+
+#include "ObjectAllocator.h"
+#include <cstddef>
+#include <cstring>
+
+// The compile-time counterpart of OAConfig. Every setting is a constant,
+// so the checks ObjectAllocator makes on each call are resolved when
+// ObjectPool is instantiated. External headers aren't offered since they
+// need a heap record per block, which is what a pool is meant to avoid.
+template <unsigned ObjectsPerPage = DEFAULT_OBJECTS_PER_PAGE,
+          unsigned MaxPages = DEFAULT_MAX_PAGES,
+          bool DebugOn = false,
+          unsigned PadBytes = 0,
+          OAConfig::HBLOCK_TYPE HeaderType = OAConfig::hbNone,
+          unsigned ExtraHeaderBytes = 0,
+          unsigned Alignment = 0,
+          bool KeepStats = DebugOn>
+struct PoolConfig
+{
+  static const unsigned ObjectsPerPage_ = ObjectsPerPage; // number of objects on each page
+  static const unsigned MaxPages_ = MaxPages;             // maximum number of pages the pool can allocate (0=unlimited)
+  static const bool DebugOn_ = DebugOn;                   // signatures and checks on Free
+  static const unsigned PadBytes_ = PadBytes;             // size of the left/right padding for each block
+  static const OAConfig::HBLOCK_TYPE HeaderType_ = HeaderType; // hbNone, hbBasic or hbExtended
+  static const unsigned ExtraHeaderBytes_ = ExtraHeaderBytes;  // user-defined bytes of an extended header
+  static const unsigned Alignment_ = Alignment;           // address alignment of each block
+  static const bool KeepStats_ = KeepStats;               // keep the OAStats counters up to date
+
+  static_assert(HeaderType != OAConfig::hbExternal, "ObjectPool doesn't support external headers");
+  static_assert(ObjectsPerPage > 0, "ObjectPool needs at least one object on each page");
+};
+
+// The release configuration: no checks, no headers, no counters
+typedef PoolConfig<> ReleasePoolConfig;
+
+// An ObjectAllocator for objects of type T whose configuration is fixed at
+// compile time. Pages are laid out exactly like ObjectAllocator's (the
+// same patterns in debug too), so GetPageList/GetConfig/GetStats work with
+// the same tooling. With ReleasePoolConfig, Allocate and Free are a pop
+// and a push on the free list.
+//
+// Allocate returns raw storage, the pool never constructs or destroys T.
+template <typename T, typename Config = ReleasePoolConfig>
+class ObjectPool
+{
+  public:
+      // Creates the pool and its first page
+      // Throws an exception if the construction fails. (Memory allocation problem)
+    ObjectPool(void) : PageList_(0), FreeList_(0)
+    {
+      stats.ObjectSize_ = ObjectSize;
+      stats.PageSize_ = PageSize;
+      allocate_new_page();
+    }
+
+      // Destroys the pool (never throws)
+    ~ObjectPool()
+    {
+      while (PageList_)
+      {
+        GenericObject *next = PageList_->Next;
+        delete[] reinterpret_cast<char *>(PageList_);
+        PageList_ = next;
+      }
+    }
+
+      // Take an object from the free list and give it to the client
+      // Throws an exception if the object can't be allocated. (Memory allocation problem)
+    T *Allocate(void)
+    {
+      if (!FreeList_)
+      {
+        allocate_new_page();
+      }
+
+      GenericObject *block = FreeList_;
+      FreeList_ = block->Next;
+
+      if (Counting)
+      {
+        stats.FreeObjects_--;
+        stats.ObjectsInUse_++;
+        stats.Allocations_++;
+        if (stats.ObjectsInUse_ > stats.MostObjects_)
+        {
+          stats.MostObjects_ = stats.ObjectsInUse_;
+        }
+      }
+      if (Config::DebugOn_)
+      {
+        std::memset(block, ObjectAllocator::ALLOCATED_PATTERN, ObjectSize);
+      }
+      if (HeaderSize)
+      {
+        write_header(reinterpret_cast<char *>(block), true);
+      }
+
+      return reinterpret_cast<T *>(block);
+    }
+
+      // Returns an object to the free list
+      // Throws an exception if the the object can't be freed. (Invalid object)
+    void Free(T *Object)
+    {
+      char *block = reinterpret_cast<char *>(Object);
+
+      if (Config::DebugOn_)
+      {
+        check_free(block);
+        std::memset(block, ObjectAllocator::FREED_PATTERN, ObjectSize);
+      }
+      if (HeaderSize)
+      {
+        write_header(block, false);
+      }
+      if (Counting)
+      {
+        stats.FreeObjects_++;
+        stats.ObjectsInUse_--;
+        stats.Deallocations_++;
+      }
+
+      GenericObject *node = reinterpret_cast<GenericObject *>(block);
+      node->Next = FreeList_;
+      FreeList_ = node;
+    }
+
+      // Calls the callback fn for each block still in use (needs a header)
+    unsigned DumpMemoryInUse(ObjectAllocator::DUMPCALLBACK fn) const
+    {
+      unsigned inUse = 0;
+
+      for (GenericObject *page = PageList_; page && HeaderSize; page = page->Next)
+      {
+        char *block = first_block(reinterpret_cast<char *>(page));
+        for (unsigned i = 0; i < Config::ObjectsPerPage_; i++, block += BlockSize)
+        {
+          if (in_use(block))
+          {
+            fn(block, ObjectSize);
+            inUse++;
+          }
+        }
+      }
+      return inUse;
+    }
+
+      // Calls the callback fn for each block whose pad bytes have been overwritten
+    unsigned ValidatePages(ObjectAllocator::VALIDATECALLBACK fn) const
+    {
+      unsigned corrupted = 0;
+
+      for (GenericObject *page = PageList_; page && Config::PadBytes_; page = page->Next)
+      {
+        char *block = first_block(reinterpret_cast<char *>(page));
+        for (unsigned i = 0; i < Config::ObjectsPerPage_; i++, block += BlockSize)
+        {
+          if (is_corrupted(block))
+          {
+            fn(block, ObjectSize);
+            corrupted++;
+          }
+        }
+      }
+      return corrupted;
+    }
+
+      // Testing/Debugging/Statistic methods
+    const void *GetFreeList(void) const { return FreeList_; } // returns a pointer to the internal free list
+    const void *GetPageList(void) const { return PageList_; } // returns a pointer to the internal page list
+
+      // returns the configuration as an OAConfig
+    OAConfig GetConfig(void) const
+    {
+      OAConfig config(false, Config::ObjectsPerPage_, Config::MaxPages_, Config::DebugOn_,
+                      Config::PadBytes_,
+                      OAConfig::HeaderBlockInfo(Config::HeaderType_, Config::ExtraHeaderBytes_),
+                      Config::Alignment_);
+      config.LeftAlignSize_ = static_cast<unsigned>(LeftAlignSize);
+      config.InterAlignSize_ = static_cast<unsigned>(InterAlignSize);
+      return config;
+    }
+
+      // returns the statistics (only counts with Config::KeepStats_ or a header)
+    OAStats GetStats(void) const { return stats; }
+
+      // the layout, worked out the same way as ObjectAllocator does at runtime
+    static const size_t ObjectSize = sizeof(T) < sizeof(GenericObject) ? sizeof(GenericObject) : sizeof(T);
+    static const size_t HeaderSize =
+      Config::HeaderType_ == OAConfig::hbBasic ? OAConfig::BASIC_HEADER_SIZE :
+      Config::HeaderType_ == OAConfig::hbExtended ?
+        sizeof(unsigned int) + sizeof(unsigned short) + sizeof(char) + Config::ExtraHeaderBytes_ : 0;
+    static const size_t LeftAlignSize = Config::Alignment_ <= 1 ? 0 :
+      (Config::Alignment_ - (sizeof(void *) + HeaderSize + Config::PadBytes_) % Config::Alignment_)
+      % Config::Alignment_;
+    static const size_t InterAlignSize = Config::Alignment_ <= 1 ? 0 :
+      (Config::Alignment_ - (ObjectSize + Config::PadBytes_ * 2 + HeaderSize) % Config::Alignment_)
+      % Config::Alignment_;
+    static const size_t BlockSize = ObjectSize + Config::PadBytes_ * 2 + HeaderSize + InterAlignSize;
+    static const size_t PageSize = !Config::ObjectsPerPage_ ? sizeof(void *) + LeftAlignSize :
+      sizeof(void *) + LeftAlignSize + BlockSize * Config::ObjectsPerPage_ - InterAlignSize;
+
+  private:
+    static_assert(Config::Alignment_ <= alignof(std::max_align_t),
+                  "ObjectPool pages are only aligned as far as new[] aligns them");
+
+      // the headers need the allocation numbers, so they keep the counters going too
+    static const bool Counting = Config::KeepStats_ || HeaderSize != 0;
+
+    GenericObject *PageList_;  //!< the beginning of the list of pages
+    GenericObject *FreeList_;  //!< the beginning of the list of objects
+    OAStats stats;             // stats for debug purposes
+
+      // where the first object of a page starts
+    static char *first_block(char *page)
+    {
+      return page + sizeof(void *) + LeftAlignSize + HeaderSize + Config::PadBytes_;
+    }
+
+      // allocates another page and puts all of its blocks on the free list
+    void allocate_new_page(void)
+    {
+      if (Config::MaxPages_ && stats.PagesInUse_ >= Config::MaxPages_)
+      {
+        throw OAException(OAException::E_NO_PAGES, "Out of pages");
+      }
+
+      char *page;
+      try
+      {
+        page = new char[PageSize];
+      }
+      catch (std::bad_alloc &)
+      {
+        throw OAException(OAException::E_NO_MEMORY, "out of memory");
+      }
+
+      if (Config::DebugOn_)
+      {
+        std::memset(page, ObjectAllocator::UNALLOCATED_PATTERN, PageSize);
+        std::memset(page + sizeof(void *), ObjectAllocator::ALIGN_PATTERN, LeftAlignSize);
+      }
+
+      GenericObject *newPage = reinterpret_cast<GenericObject *>(page);
+      newPage->Next = PageList_;
+      PageList_ = newPage;
+
+      // the first block ends up at the end of the free list, like ObjectAllocator
+      char *block = first_block(page);
+      for (unsigned i = 0; i < Config::ObjectsPerPage_; i++, block += BlockSize)
+      {
+        if (Config::DebugOn_)
+        {
+          std::memset(block - Config::PadBytes_, ObjectAllocator::PAD_PATTERN, Config::PadBytes_);
+          std::memset(block + ObjectSize, ObjectAllocator::PAD_PATTERN, Config::PadBytes_);
+          if (i + 1 < Config::ObjectsPerPage_)
+          {
+            std::memset(block + ObjectSize + Config::PadBytes_, ObjectAllocator::ALIGN_PATTERN,
+                        InterAlignSize);
+          }
+        }
+        std::memset(block - Config::PadBytes_ - HeaderSize, 0, HeaderSize);
+
+        GenericObject *node = reinterpret_cast<GenericObject *>(block);
+        node->Next = FreeList_;
+        FreeList_ = node;
+      }
+
+      stats.PagesInUse_++;
+      stats.FreeObjects_ += Config::ObjectsPerPage_;
+    }
+
+      // fills in the header the same way ObjectAllocator's configure_header does
+    void write_header(char *block, bool allocated)
+    {
+      char *header = block - Config::PadBytes_ - HeaderSize;
+      unsigned allocNum = stats.Allocations_;
+
+      if (Config::HeaderType_ == OAConfig::hbBasic)
+      {
+        std::memset(header, 0, HeaderSize);
+        if (allocated)
+        {
+          std::memcpy(header, &allocNum, sizeof(unsigned));
+          header[sizeof(unsigned)] = true;
+        }
+      }
+      else if (allocated) // extended: user bytes, use count, alloc number, flag
+      {
+        std::memset(header, 0, Config::ExtraHeaderBytes_);
+        unsigned short uses;
+        std::memcpy(&uses, header + Config::ExtraHeaderBytes_, sizeof(uses));
+        uses++;
+        std::memcpy(header + Config::ExtraHeaderBytes_, &uses, sizeof(uses));
+        std::memcpy(header + Config::ExtraHeaderBytes_ + sizeof(uses), &allocNum, sizeof(unsigned));
+        header[HeaderSize - 1] = true;
+      }
+      else // keeps the use count
+      {
+        std::memset(header + Config::ExtraHeaderBytes_ + sizeof(unsigned short), 0,
+                    sizeof(unsigned) + sizeof(char));
+      }
+    }
+
+      // reads the in use flag of the block's header
+    static bool in_use(char *block)
+    {
+      return block[-static_cast<std::ptrdiff_t>(Config::PadBytes_) - 1] != 0;
+    }
+
+      // checks to see if the pad bytes around the block are overwritten
+    static bool is_corrupted(char *block)
+    {
+      for (unsigned i = 0; i < Config::PadBytes_; i++)
+      {
+        if (static_cast<unsigned char>((block - Config::PadBytes_)[i]) != ObjectAllocator::PAD_PATTERN
+         || static_cast<unsigned char>(block[ObjectSize + i]) != ObjectAllocator::PAD_PATTERN)
+        {
+          return true;
+        }
+      }
+      return false;
+    }
+
+      // the debug checks on Free (the boundary comes first so the pad bytes
+      // read are known to belong to a block)
+    void check_free(char *block) const
+    {
+      bool onBoundary = false;
+      for (GenericObject *page = PageList_; page; page = page->Next)
+      {
+        char *start = reinterpret_cast<char *>(page);
+        if (block >= start && block < start + PageSize)
+        {
+          char *first = first_block(start);
+          onBoundary = block >= first && static_cast<size_t>(block - first) % BlockSize == 0;
+          break;
+        }
+      }
+      if (!onBoundary)
+      {
+        throw OAException(OAException::E_BAD_BOUNDARY, "Not freed inside a page");
+      }
+
+      if (Config::PadBytes_ && is_corrupted(block))
+      {
+        throw OAException(OAException::E_CORRUPTED_BLOCK, "Overrote padding");
+      }
+
+      // the header says whether it's in use, without one the free list does
+      bool isFree = false;
+      if (HeaderSize)
+      {
+        isFree = !in_use(block);
+      }
+      else
+      {
+        for (GenericObject *node = FreeList_; node && !isFree; node = node->Next)
+        {
+          isFree = reinterpret_cast<char *>(node) == block;
+        }
+      }
+      if (isFree)
+      {
+        throw OAException(OAException::E_MULTIPLE_FREE, "Freed multiple times");
+      }
+    }
+
+      // Make private to prevent copy construction and assignment
+    ObjectPool(const ObjectPool &pool);
+    ObjectPool &operator=(const ObjectPool &pool);
+};
+
+#endif
@@ -1,15 +1,15 @@
-//---------------------------------------------------------------------------
-#ifndef PRNGH
-#define PRNGH
-//---------------------------------------------------------------------------
-
-namespace Digipen
-{
-  namespace Utils
-  {
-    unsigned rand(void);              // returns a random 32-bit integer
-    void srand(unsigned, unsigned);   // seed the generator
-    int Random(int low, int high);    // range
-  }
-}
-#endif
+//---------------------------------------------------------------------------
+#ifndef PRNGH
+#define PRNGH
+//---------------------------------------------------------------------------
+
+namespace Digipen
+{
+  namespace Utils
+  {
+    unsigned rand(void);              // returns a random 32-bit integer
+    void srand(unsigned, unsigned);   // seed the generator
+    int Random(int low, int high);    // range
+  }
+}
+#endif
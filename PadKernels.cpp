@@ -0,0 +1,302 @@
+#include "PadKernels.h"
+
+#include <cstring>
+#include <stdint.h>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#include <immintrin.h>
+#define HAVE_X86_KERNELS 1
+#else
+#define HAVE_X86_KERNELS 0
+#endif
+
+#if defined(__aarch64__) && defined(__ARM_NEON)
+#include <arm_neon.h>
+#define HAVE_NEON_KERNEL 1
+#else
+#define HAVE_NEON_KERNEL 0
+#endif
+
+namespace
+{
+  typedef bool (*MATCHER)(const unsigned char *, size_t, unsigned char);
+  typedef void (*FILLER)(unsigned char *, size_t, unsigned char);
+
+  bool matches_scalar(const unsigned char *bytes, size_t count, unsigned char pattern)
+  {
+    for (size_t i = 0; i < count; i++)
+    {
+      if (bytes[i] != pattern)
+      {
+        return false;
+      }
+    }
+    return true;
+  }
+
+    // the volatile keeps the compiler from turning the loop back into memset
+  void fill_scalar(unsigned char *bytes, size_t count, unsigned char pattern)
+  {
+    volatile unsigned char *data = bytes;
+    for (size_t i = 0; i < count; i++)
+    {
+      data[i] = pattern;
+    }
+  }
+
+    // runs shorter than a register: two word stores that overlap in the
+    // middle cover anything from one word to two
+  void fill_short(unsigned char *bytes, size_t count, unsigned char pattern)
+  {
+    if (count >= 8)
+    {
+      uint64_t word = 0x0101010101010101ULL * pattern;
+      std::memcpy(bytes, &word, 8);
+      std::memcpy(bytes + count - 8, &word, 8);
+    }
+    else if (count >= 4)
+    {
+      uint32_t word = 0x01010101U * pattern;
+      std::memcpy(bytes, &word, 4);
+      std::memcpy(bytes + count - 4, &word, 4);
+    }
+    else
+    {
+      fill_scalar(bytes, count, pattern);
+    }
+  }
+
+#if HAVE_X86_KERNELS
+  __attribute__((target("sse2")))
+  bool matches_sse2(const unsigned char *bytes, size_t count, unsigned char pattern)
+  {
+    const __m128i wanted = _mm_set1_epi8(static_cast<char>(pattern));
+    size_t i = 0;
+
+    for (; i + 16 <= count; i += 16)
+    {
+      __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i *>(bytes + i));
+      if (_mm_movemask_epi8(_mm_cmpeq_epi8(chunk, wanted)) != 0xFFFF)
+      {
+        return false;
+      }
+    }
+    return matches_scalar(bytes + i, count - i, pattern);
+  }
+
+  __attribute__((target("avx2")))
+  bool matches_avx2(const unsigned char *bytes, size_t count, unsigned char pattern)
+  {
+    const __m256i wanted = _mm256_set1_epi8(static_cast<char>(pattern));
+    size_t i = 0;
+
+    for (; i + 32 <= count; i += 32)
+    {
+      __m256i chunk = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(bytes + i));
+      if (_mm256_movemask_epi8(_mm256_cmpeq_epi8(chunk, wanted)) != -1)
+      {
+        return false;
+      }
+    }
+    return matches_sse2(bytes + i, count - i, pattern);
+  }
+
+    // a run of at least one register ends with a store that overlaps the
+    // one before it rather than a byte loop
+  __attribute__((target("sse2")))
+  void fill_sse2(unsigned char *bytes, size_t count, unsigned char pattern)
+  {
+    if (count < 16)
+    {
+      fill_scalar(bytes, count, pattern);
+      return;
+    }
+
+    const __m128i wanted = _mm_set1_epi8(static_cast<char>(pattern));
+    for (size_t i = 0; i + 16 < count; i += 16)
+    {
+      _mm_storeu_si128(reinterpret_cast<__m128i *>(bytes + i), wanted);
+    }
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(bytes + count - 16), wanted);
+  }
+
+  __attribute__((target("avx2")))
+  void fill_avx2(unsigned char *bytes, size_t count, unsigned char pattern)
+  {
+    if (count < 32)
+    {
+      fill_sse2(bytes, count, pattern);
+      return;
+    }
+
+    const __m256i wanted = _mm256_set1_epi8(static_cast<char>(pattern));
+    for (size_t i = 0; i + 32 < count; i += 32)
+    {
+      _mm256_storeu_si256(reinterpret_cast<__m256i *>(bytes + i), wanted);
+    }
+    _mm256_storeu_si256(reinterpret_cast<__m256i *>(bytes + count - 32), wanted);
+  }
+#endif
+
+#if HAVE_NEON_KERNEL
+  bool matches_neon(const unsigned char *bytes, size_t count, unsigned char pattern)
+  {
+    const uint8x16_t wanted = vdupq_n_u8(pattern);
+    size_t i = 0;
+
+    for (; i + 16 <= count; i += 16)
+    {
+      if (vminvq_u8(vceqq_u8(vld1q_u8(bytes + i), wanted)) != 0xFF)
+      {
+        return false;
+      }
+    }
+    return matches_scalar(bytes + i, count - i, pattern);
+  }
+
+  void fill_neon(unsigned char *bytes, size_t count, unsigned char pattern)
+  {
+    if (count < 16)
+    {
+      fill_scalar(bytes, count, pattern);
+      return;
+    }
+
+    const uint8x16_t wanted = vdupq_n_u8(pattern);
+    for (size_t i = 0; i + 16 < count; i += 16)
+    {
+      vst1q_u8(bytes + i, wanted);
+    }
+    vst1q_u8(bytes + count - 16, wanted);
+  }
+#endif
+
+  MATCHER matcher_for(PadKernels::KERNEL_TYPE kernel)
+  {
+    switch (kernel)
+    {
+#if HAVE_X86_KERNELS
+      case PadKernels::kSSE2:
+        return matches_sse2;
+      case PadKernels::kAVX2:
+        return matches_avx2;
+#endif
+#if HAVE_NEON_KERNEL
+      case PadKernels::kNEON:
+        return matches_neon;
+#endif
+      default:
+        return matches_scalar;
+    }
+  }
+
+  FILLER filler_for(PadKernels::KERNEL_TYPE kernel)
+  {
+    switch (kernel)
+    {
+#if HAVE_X86_KERNELS
+      case PadKernels::kSSE2:
+        return fill_sse2;
+      case PadKernels::kAVX2:
+        return fill_avx2;
+#endif
+#if HAVE_NEON_KERNEL
+      case PadKernels::kNEON:
+        return fill_neon;
+#endif
+      default:
+        return fill_scalar;
+    }
+  }
+
+  // the widest kernel the CPU supports
+  PadKernels::KERNEL_TYPE best_kernel(void)
+  {
+    const PadKernels::KERNEL_TYPE widestFirst[] = {PadKernels::kAVX2, PadKernels::kNEON, PadKernels::kSSE2};
+
+    for (unsigned i = 0; i < sizeof(widestFirst) / sizeof(*widestFirst); i++)
+    {
+      if (PadKernels::Supported(widestFirst[i]))
+      {
+        return widestFirst[i];
+      }
+    }
+    return PadKernels::kScalar;
+  }
+
+  // the pad regions of most configurations are shorter than a register
+  const size_t VECTOR_THRESHOLD = 16;
+}
+
+namespace PadKernels
+{
+
+bool Matches(const void *bytes, size_t count, unsigned char pattern)
+{
+  const unsigned char *data = static_cast<const unsigned char *>(bytes);
+  if (count < VECTOR_THRESHOLD)
+  {
+    return matches_scalar(data, count, pattern);
+  }
+
+  static const MATCHER matcher = matcher_for(Active());
+  return matcher(data, count, pattern);
+}
+
+bool MatchesWith(KERNEL_TYPE kernel, const void *bytes, size_t count, unsigned char pattern)
+{
+  return matcher_for(kernel)(static_cast<const unsigned char *>(bytes), count, pattern);
+}
+
+void Fill(void *bytes, size_t count, unsigned char pattern)
+{
+  unsigned char *data = static_cast<unsigned char *>(bytes);
+  if (count < VECTOR_THRESHOLD)
+  {
+    fill_short(data, count, pattern);
+    return;
+  }
+
+  static const FILLER filler = filler_for(Active());
+  filler(data, count, pattern);
+}
+
+void FillWith(KERNEL_TYPE kernel, void *bytes, size_t count, unsigned char pattern)
+{
+  filler_for(kernel)(static_cast<unsigned char *>(bytes), count, pattern);
+}
+
+KERNEL_TYPE Active(void)
+{
+  static const KERNEL_TYPE kernel = best_kernel();
+  return kernel;
+}
+
+bool Supported(KERNEL_TYPE kernel)
+{
+  switch (kernel)
+  {
+    case kScalar:
+      return true;
+#if HAVE_X86_KERNELS
+    case kSSE2:
+      return __builtin_cpu_supports("sse2");
+    case kAVX2:
+      return __builtin_cpu_supports("avx2");
+#endif
+#if HAVE_NEON_KERNEL
+    case kNEON:
+      return true;
+#endif
+    default:
+      return false;
+  }
+}
+
+const char *Name(KERNEL_TYPE kernel)
+{
+  static const char *names[] = {"scalar", "sse2", "avx2", "neon"};
+  return names[kernel];
+}
+
+} // namespace PadKernels
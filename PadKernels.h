@@ -0,0 +1,35 @@
+//---------------------------------------------------------------------------
+#ifndef PADKERNELSH
+#define PADKERNELSH
+//---------------------------------------------------------------------------
+
+#include <cstddef>
+
+// Checks and writes runs of bytes in one of the debug patterns (the pad
+// bytes against PAD_PATTERN, mostly) a vector register at a time. The
+// widest kernel the CPU has is picked the first time Matches or Fill is
+// called: AVX2 or SSE2 on x86, NEON on 64-bit ARM, a byte loop everywhere
+// else. Runs shorter than a register take a byte loop for Matches and
+// two overlapping word stores for Fill.
+namespace PadKernels
+{
+  enum KERNEL_TYPE {kScalar, kSSE2, kAVX2, kNEON};
+
+    // true if all count bytes are pattern
+  bool Matches(const void *bytes, size_t count, unsigned char pattern);
+
+    // Matches with a particular kernel (it must be Supported)
+  bool MatchesWith(KERNEL_TYPE kernel, const void *bytes, size_t count, unsigned char pattern);
+
+    // sets all count bytes to pattern
+  void Fill(void *bytes, size_t count, unsigned char pattern);
+
+    // Fill with a particular kernel (it must be Supported)
+  void FillWith(KERNEL_TYPE kernel, void *bytes, size_t count, unsigned char pattern);
+
+  KERNEL_TYPE Active(void);             // the kernel Matches and Fill use
+  bool Supported(KERNEL_TYPE kernel);   // whether this CPU can run a kernel
+  const char *Name(KERNEL_TYPE kernel); // "scalar", "sse2", "avx2" or "neon"
+}
+
+#endif
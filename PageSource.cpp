@@ -0,0 +1,390 @@
+#include "PageSource.h"
+#include <atomic>
+#include <cstdio>
+#include <new>
+#include <vector>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <sys/mman.h>
+#include <unistd.h>
+#define HAVE_MMAP 1
+#else
+#define HAVE_MMAP 0
+#endif
+
+#if defined(__linux__)
+#include <sys/syscall.h>
+#endif
+#if defined(__linux__) && defined(SYS_mbind) && defined(SYS_getcpu) && HAVE_MMAP
+#define HAVE_NUMA_SYSCALLS 1
+#else
+#define HAVE_NUMA_SYSCALLS 0
+#endif
+
+namespace
+{
+#if HAVE_MMAP
+  // maps Size bytes of zeroed memory (0 if it can't)
+  void *map_pages(size_t Size, int extraFlags)
+  {
+    void *page = mmap(0, Size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | extraFlags, -1, 0);
+    return page == MAP_FAILED ? 0 : page;
+  }
+
+  // rounds Size up to a multiple of the huge page size
+  size_t huge_length(size_t Size)
+  {
+    const size_t huge = HugePageSource::HUGE_PAGE_SIZE;
+    return (Size + huge - 1) / huge * huge;
+  }
+#endif
+
+#if HAVE_NUMA_SYSCALLS
+  // from <numaif.h>, which comes with libnuma rather than the C library
+  const int NUMA_MPOL_BIND = 2;
+
+  // binds the pages to the node (left unbound if the kernel won't)
+  void bind_pages(void *page, size_t Size, unsigned node)
+  {
+    const unsigned bits = sizeof(unsigned long) * 8;
+    std::vector<unsigned long> mask(node / bits + 1, 0);
+    mask[node / bits] = 1UL << (node % bits);
+
+    // the kernel reads one bit less than maxnode says
+    unsigned long maxnode = mask.size() * bits + 1;
+    syscall(SYS_mbind, page, Size, NUMA_MPOL_BIND, &mask[0], maxnode, 0);
+  }
+
+  // the highest node listed in /sys/devices/system/node/online ("0-1,3"), plus one
+  unsigned online_nodes(void)
+  {
+    std::FILE *file = std::fopen("/sys/devices/system/node/online", "r");
+    if (!file)
+    {
+      return 1;
+    }
+
+    unsigned highest = 0, number = 0;
+    bool digits = false;
+    for (int c = std::fgetc(file); c != EOF; c = std::fgetc(file))
+    {
+      if (c >= '0' && c <= '9')
+      {
+        number = number * 10 + static_cast<unsigned>(c - '0');
+        digits = true;
+        continue;
+      }
+      if (digits && number > highest)
+      {
+        highest = number;
+      }
+      number = 0;
+      digits = false;
+    }
+    if (digits && number > highest)
+    {
+      highest = number;
+    }
+    std::fclose(file);
+    return highest + 1;
+  }
+#endif
+
+#if HAVE_MMAP
+  // The node map is a two level radix tree over the address in 4 KB units
+  // (no OS page is smaller), holding node + 1 for every unit a
+  // NumaPageSource mapped. Leaves are made the first time a page lands in
+  // their 1 GB of address space and are never freed, so readers need no
+  // lock. Addresses past the 2^48 the tree covers aren't recorded.
+  const unsigned MAP_UNIT_BITS = 12;
+  const unsigned MAP_LEAF_BITS = 18;
+  const unsigned MAP_ROOT_BITS = 18;
+
+  typedef std::atomic<unsigned char> NodeEntry;
+  std::atomic<NodeEntry *> nodeMap[1 << MAP_ROOT_BITS];
+
+  // the entry for the unit holding address (0 if it has none, or if create
+  // is false and its leaf hasn't been made)
+  NodeEntry *map_entry(const char *address, bool create)
+  {
+    unsigned long long unit = reinterpret_cast<size_t>(address) >> MAP_UNIT_BITS;
+    unsigned long long root = unit >> MAP_LEAF_BITS;
+    if (root >> MAP_ROOT_BITS)
+    {
+      return 0;
+    }
+
+    std::atomic<NodeEntry *> &slot = nodeMap[root];
+    NodeEntry *leaf = slot.load(std::memory_order_acquire);
+    if (!leaf && create)
+    {
+      NodeEntry *made = new (std::nothrow) NodeEntry[1 << MAP_LEAF_BITS]();
+      if (!made)
+      {
+        return 0;
+      }
+      if (slot.compare_exchange_strong(leaf, made, std::memory_order_acq_rel))
+      {
+        leaf = made;
+      }
+      else
+      {
+        delete[] made;
+      }
+    }
+    if (!leaf)
+    {
+      return 0;
+    }
+    return &leaf[unit & ((1 << MAP_LEAF_BITS) - 1)];
+  }
+
+  // records value (node + 1, or 0 to forget it) for the pages
+  void map_pages_to(void *page, size_t Size, unsigned char value)
+  {
+    const char *start = static_cast<const char *>(page);
+    const size_t unit = static_cast<size_t>(1) << MAP_UNIT_BITS;
+
+    for (size_t offset = 0; offset < Size; offset += unit)
+    {
+      NodeEntry *entry = map_entry(start + offset, value != 0);
+      if (entry)
+      {
+        entry->store(value, std::memory_order_relaxed);
+      }
+    }
+  }
+#endif
+}
+
+  // the heap source the allocators use when none is configured
+PageSource &PageSource::Heap(void)
+{
+  static HeapPageSource heap;
+  return heap;
+}
+
+/*****************************************************************************/
+/*
+  HeapPageSource
+*/
+/*****************************************************************************/
+void *HeapPageSource::AllocatePage(size_t Size)
+{
+  return new (std::nothrow) char[Size];
+}
+
+void HeapPageSource::FreePage(void *Page, size_t)
+{
+  delete[] static_cast<char *>(Page);
+}
+
+size_t HeapPageSource::Alignment(void) const
+{
+  return alignof(std::max_align_t);
+}
+
+/*****************************************************************************/
+/*
+  MmapPageSource
+*/
+/*****************************************************************************/
+MmapPageSource::MmapPageSource(bool Populate) : populate(Populate)
+{
+}
+
+void *MmapPageSource::AllocatePage(size_t Size)
+{
+#if HAVE_MMAP
+  int flags = 0;
+#ifdef MAP_POPULATE
+  if (populate)
+  {
+    flags |= MAP_POPULATE;
+  }
+#endif
+  return map_pages(Size, flags);
+#else
+  return PageSource::Heap().AllocatePage(Size);
+#endif
+}
+
+void MmapPageSource::FreePage(void *Page, size_t Size)
+{
+#if HAVE_MMAP
+  munmap(Page, Size);
+#else
+  PageSource::Heap().FreePage(Page, Size);
+#endif
+}
+
+size_t MmapPageSource::Alignment(void) const
+{
+#if HAVE_MMAP
+  return static_cast<size_t>(sysconf(_SC_PAGESIZE));
+#else
+  return PageSource::Heap().Alignment();
+#endif
+}
+
+/*****************************************************************************/
+/*
+  HugePageSource
+*/
+/*****************************************************************************/
+HugePageSource::HugePageSource(bool Explicit) : explicitPages(Explicit)
+{
+}
+
+void *HugePageSource::AllocatePage(size_t Size)
+{
+#if HAVE_MMAP
+  size_t length = huge_length(Size);
+
+#ifdef MAP_HUGETLB
+  if (explicitPages)
+  {
+    void *page = map_pages(length, MAP_HUGETLB);
+    if (page)
+    {
+      return page;
+    }
+  }
+#endif
+
+  // maps an extra huge page so a 2 MB boundary can be cut out of it
+  char *mapping = static_cast<char *>(map_pages(length + HUGE_PAGE_SIZE, 0));
+  if (!mapping)
+  {
+    return 0;
+  }
+
+  size_t misalignment = reinterpret_cast<size_t>(mapping) % HUGE_PAGE_SIZE;
+  size_t head = (HUGE_PAGE_SIZE - misalignment) % HUGE_PAGE_SIZE;
+  if (head)
+  {
+    munmap(mapping, head);
+  }
+  munmap(mapping + head + length, HUGE_PAGE_SIZE - head);
+
+  char *page = mapping + head;
+#ifdef MADV_HUGEPAGE
+  madvise(page, length, MADV_HUGEPAGE);
+#endif
+  return page;
+#else
+  return PageSource::Heap().AllocatePage(Size);
+#endif
+}
+
+void HugePageSource::FreePage(void *Page, size_t Size)
+{
+#if HAVE_MMAP
+  munmap(Page, huge_length(Size));
+#else
+  PageSource::Heap().FreePage(Page, Size);
+#endif
+}
+
+size_t HugePageSource::Alignment(void) const
+{
+#if HAVE_MMAP
+  return HUGE_PAGE_SIZE;
+#else
+  return PageSource::Heap().Alignment();
+#endif
+}
+
+/*****************************************************************************/
+/*
+  NumaPageSource
+*/
+/*****************************************************************************/
+NumaPageSource::NumaPageSource(unsigned Node) : node(Node)
+{
+}
+
+void *NumaPageSource::AllocatePage(size_t Size)
+{
+#if HAVE_MMAP
+  void *page = map_pages(Size, 0);
+#if HAVE_NUMA_SYSCALLS
+  if (page)
+  {
+    bind_pages(page, Size, node);
+  }
+#endif
+  if (page && node < 255)
+  {
+    map_pages_to(page, Size, static_cast<unsigned char>(node + 1));
+  }
+  return page;
+#else
+  return PageSource::Heap().AllocatePage(Size);
+#endif
+}
+
+void NumaPageSource::FreePage(void *Page, size_t Size)
+{
+#if HAVE_MMAP
+  map_pages_to(Page, Size, 0);
+  munmap(Page, Size);
+#else
+  PageSource::Heap().FreePage(Page, Size);
+#endif
+}
+
+size_t NumaPageSource::Alignment(void) const
+{
+#if HAVE_MMAP
+  return static_cast<size_t>(sysconf(_SC_PAGESIZE));
+#else
+  return PageSource::Heap().Alignment();
+#endif
+}
+
+  // the node the pages are bound to
+unsigned NumaPageSource::Node(void) const
+{
+  return node;
+}
+
+  // how many nodes the machine has (1 if it can't tell)
+unsigned NumaPageSource::NodeCount(void)
+{
+#if HAVE_NUMA_SYSCALLS
+  static const unsigned nodes = online_nodes();
+  return nodes;
+#else
+  return 1;
+#endif
+}
+
+  // the node the calling thread is running on (0 if it can't tell)
+unsigned NumaPageSource::CurrentNode(void)
+{
+#if HAVE_NUMA_SYSCALLS
+  unsigned cpu = 0, current = 0;
+  if (syscall(SYS_getcpu, &cpu, &current, 0) == 0)
+  {
+    return current;
+  }
+#endif
+  return 0;
+}
+
+  // the node of the source that mapped Address (NO_NODE if none did)
+unsigned NumaPageSource::NodeOf(const void *Address)
+{
+#if HAVE_MMAP
+  NodeEntry *entry = map_entry(static_cast<const char *>(Address), false);
+  unsigned char value = entry ? entry->load(std::memory_order_relaxed) : 0;
+  if (value)
+  {
+    return value - 1u;
+  }
+#else
+  (void)Address;
+#endif
+  return NO_NODE;
+}
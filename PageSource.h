@@ -0,0 +1,107 @@
+//---------------------------------------------------------------------------
+#ifndef PAGESOURCEH
+#define PAGESOURCEH
+//---------------------------------------------------------------------------
+
+#include <cstddef>
+
+// Where an ObjectAllocator gets the memory for its pages. Set
+// OAConfig::PageSource_ to use one (the heap is used otherwise). The
+// allocator gives every page back to the source it came from, in
+// FreeEmptyPages and its destructor, so the source must outlive every
+// allocator using it. A source may be shared by any number of allocators.
+class PageSource
+{
+  public:
+    virtual ~PageSource() {}
+
+      // Returns at least Size bytes aligned to Alignment(), or 0 if there's no memory
+    virtual void *AllocatePage(size_t Size) = 0;
+
+      // Gives back memory AllocatePage(Size) returned (never throws)
+    virtual void FreePage(void *Page, size_t Size) = 0;
+
+      // the alignment every page is guaranteed to have
+    virtual size_t Alignment(void) const = 0;
+
+      // the heap source the allocators use when none is configured
+    static PageSource &Heap(void);
+};
+
+// Pages from new[]/delete[], the allocator's original behaviour
+class HeapPageSource : public PageSource
+{
+  public:
+    void *AllocatePage(size_t Size);
+    void FreePage(void *Page, size_t Size);
+    size_t Alignment(void) const;
+};
+
+// Pages mapped straight from the OS. With Populate (MAP_POPULATE, where
+// the OS has it) the memory is faulted in when the page is mapped rather
+// than on first touch. Falls back to the heap where mmap isn't available.
+class MmapPageSource : public PageSource
+{
+  public:
+    explicit MmapPageSource(bool Populate = true);
+    void *AllocatePage(size_t Size);
+    void FreePage(void *Page, size_t Size);
+    size_t Alignment(void) const;
+
+  private:
+    bool populate; // fault the pages in up front
+};
+
+// Pages backed by 2 MB huge pages, each rounded up to a multiple of 2 MB,
+// so it suits allocators whose pages are at least that big. Explicit asks
+// for pages from the reserved hugetlb pool (MAP_HUGETLB) and falls back to
+// transparent huge pages when the pool is empty. Transparent maps 2 MB
+// aligned memory and advises the kernel to back it with huge pages.
+class HugePageSource : public PageSource
+{
+  public:
+    static const size_t HUGE_PAGE_SIZE = 2 * 1024 * 1024;
+
+    explicit HugePageSource(bool Explicit = false);
+    void *AllocatePage(size_t Size);
+    void FreePage(void *Page, size_t Size);
+    size_t Alignment(void) const;
+
+  private:
+    bool explicitPages; // try the hugetlb pool first
+};
+
+// Pages mapped from the OS and bound to one NUMA node (mbind MPOL_BIND)
+// before anything touches them, so they land on that node whichever thread
+// faults them in. Where the kernel has no NUMA support, or the node isn't
+// there, the binding fails quietly and the pages come from wherever the
+// OS puts them. Falls back to the heap where mmap isn't available.
+//
+// Every page is also recorded in a process-wide map from address to node,
+// which NodeOf reads without a lock, so any thread can tell which node's
+// pool a block belongs to.
+class NumaPageSource : public PageSource
+{
+  public:
+    static const unsigned NO_NODE = ~0u;
+
+    explicit NumaPageSource(unsigned Node = 0);
+    void *AllocatePage(size_t Size);
+    void FreePage(void *Page, size_t Size);
+    size_t Alignment(void) const;
+    unsigned Node(void) const;          // the node the pages are bound to
+
+      // how many nodes the machine has (1 if it can't tell)
+    static unsigned NodeCount(void);
+
+      // the node the calling thread is running on (0 if it can't tell)
+    static unsigned CurrentNode(void);
+
+      // the node of the source that mapped Address (NO_NODE if none did)
+    static unsigned NodeOf(const void *Address);
+
+  private:
+    unsigned node; // the node every page is bound to
+};
+
+#endif
@@ -0,0 +1,111 @@
+//---------------------------------------------------------------------------
+#ifndef POOLALLOCATORH
+#define POOLALLOCATORH
+//---------------------------------------------------------------------------
+
+#include "ObjectAllocator.h"
+#include <cstddef>
+#include <new>
+
+// Nodes on each page of a shared pool
+static const unsigned SHARED_POOL_OBJECTS_PER_PAGE = 256;
+
+// The pool PoolAllocator takes single nodes from: one lock-free
+// ObjectAllocator for every node size and alignment, shared by all the
+// containers (on any thread) whose nodes have that shape. It is never
+// destroyed, so containers with static storage duration can still give
+// their nodes back while the program exits.
+template <size_t Size, size_t Align>
+struct SharedNodePool
+{
+  static ObjectAllocator &Get(void)
+  {
+    static ObjectAllocator *pool = new ObjectAllocator(Size < sizeof(void *) ? sizeof(void *) : Size,
+                                                       Config());
+    return *pool;
+  }
+
+    // no checks or headers, unlimited pages, and the node's own alignment
+  static OAConfig Config(void)
+  {
+    return OAConfig(false, SHARED_POOL_OBJECTS_PER_PAGE, 0, false, 0, OAConfig::HeaderBlockInfo(),
+                    Align > sizeof(void *) ? static_cast<unsigned>(Align) : 0, true);
+  }
+};
+
+// A standard allocator for node-based containers (std::list, std::map,
+// std::unordered_map, ...). The containers rebind it to their node type,
+// and every allocation of a single node comes from the SharedNodePool for
+// that node's size. Anything else (an unordered_map's bucket array, a
+// vector's storage) goes to operator new. The allocator has no state, so
+// any two compare equal and containers can swap or splice freely.
+template <typename T>
+class PoolAllocator
+{
+  public:
+    typedef T value_type;
+
+    template <typename U>
+    struct rebind
+    {
+      typedef PoolAllocator<U> other;
+    };
+
+    PoolAllocator(void) {}
+
+    template <typename U>
+    PoolAllocator(const PoolAllocator<U> &) {}
+
+      // Storage for n objects: a pool node when n is 1
+      // Throws std::bad_alloc if there's no memory
+    T *allocate(size_t n)
+    {
+      if (n != 1)
+      {
+        return static_cast<T *>(::operator new(n * sizeof(T)));
+      }
+      try
+      {
+        return static_cast<T *>(Pool().Allocate());
+      }
+      catch (const OAException &)
+      {
+        throw std::bad_alloc();
+      }
+    }
+
+      // Gives back what allocate(n) returned (never throws)
+    void deallocate(T *p, size_t n)
+    {
+      if (n != 1)
+      {
+        ::operator delete(p);
+        return;
+      }
+      Pool().Free(p);
+    }
+
+      // the pool single objects of T come from
+    static ObjectAllocator &Pool(void)
+    {
+      return SharedNodePool<sizeof(T), alignof(T)>::Get();
+    }
+
+  private:
+    static_assert(alignof(T) <= alignof(std::max_align_t),
+                  "operator new only aligns arrays as far as max_align_t");
+};
+
+template <typename T, typename U>
+bool operator==(const PoolAllocator<T> &, const PoolAllocator<U> &)
+{
+  return true;
+}
+
+template <typename T, typename U>
+bool operator!=(const PoolAllocator<T> &, const PoolAllocator<U> &)
+{
+  return false;
+}
+
+#endif
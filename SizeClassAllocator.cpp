@@ -0,0 +1,303 @@
+#include "SizeClassAllocator.h"
+#include <algorithm>
+
+/*****************************************************************************/
+/*!
+  \brief
+    Creates an ObjectAllocator for each size class, all with the same config
+    Throws an exception if the construction fails.
+    (Memory allocation problem)
+
+  \param ClassSizes
+    Object sizes of the classes (in any order, rounded up to a multiple of
+    SIZE_CLASS_GRANULE)
+
+  \param config
+    the configuration of the blocks for every class
+*/
+/*****************************************************************************/
+SizeClassAllocator::SizeClassAllocator(const std::vector<size_t> &ClassSizes,
+                                       const OAConfig& config)
+{
+  create_classes(ClassSizes, config);
+}
+
+/*****************************************************************************/
+/*!
+  \brief
+    Creates the allocator with DefaultClassSizes()
+    Throws an exception if the construction fails.
+    (Memory allocation problem)
+
+  \param config
+    the configuration of the blocks for every class
+*/
+/*****************************************************************************/
+SizeClassAllocator::SizeClassAllocator(const OAConfig& config)
+{
+  create_classes(DefaultClassSizes(), config);
+}
+
+/*****************************************************************************/
+/*!
+  \brief
+    Destroys every class's ObjectAllocator (never throws)
+*/
+/*****************************************************************************/
+SizeClassAllocator::~SizeClassAllocator()
+{
+  for (size_t i = 0; i < classes.size(); i++)
+  {
+    delete classes[i];
+  }
+}
+
+/*****************************************************************************/
+/*!
+  \brief
+    Allocates an object of at least Size bytes from the smallest class that
+    fits, or with new if no class is big enough
+    Throws an exception if the object can't be allocated.
+    (Memory allocation problem)
+
+  \param Size
+    how many bytes the client needs
+
+  \param label
+    the label for the header-block, if any
+
+  \return
+    a pointer to the data allocated
+*/
+/*****************************************************************************/
+void *SizeClassAllocator::Allocate(size_t Size, const char *label)
+{
+  unsigned index = class_of(Size);
+
+  if (index < classes.size())
+  {
+    return classes[index]->Allocate(label);
+  }
+
+  largeStats.Allocations_++;
+  largeStats.MostObjects_++;
+  try
+  {
+    return new char[Size];
+  }
+  catch (std::bad_alloc &)
+  {
+    throw OAException(OAException::E_NO_MEMORY, "No Memory");
+  }
+}
+
+/*****************************************************************************/
+/*!
+  \brief
+    Returns an object to the class it was allocated from
+    Throws an exception if the the object can't be freed. (Invalid object)
+
+  \param Object
+    Indicates which object to free
+
+  \param Size
+    the size the object was allocated with
+*/
+/*****************************************************************************/
+void SizeClassAllocator::Free(void *Object, size_t Size)
+{
+  unsigned index = class_of(Size);
+
+  if (index < classes.size())
+  {
+    classes[index]->Free(Object);
+    return;
+  }
+
+  largeStats.Deallocations_++;
+  delete[] reinterpret_cast<char *>(Object);
+}
+
+/*****************************************************************************/
+/*!
+  \brief
+    Calls the callback fn for each block still in use in every class
+
+  \param fn
+    the function to call
+
+  \return
+    how many blocks are still in use
+*/
+/*****************************************************************************/
+unsigned SizeClassAllocator::DumpMemoryInUse(ObjectAllocator::DUMPCALLBACK fn) const
+{
+  unsigned inUse = 0;
+  for (size_t i = 0; i < classes.size(); i++)
+  {
+    inUse += classes[i]->DumpMemoryInUse(fn);
+  }
+  return inUse;
+}
+
+/*****************************************************************************/
+/*!
+  \brief
+    Calls the callback fn for each block that is potentially corrupted in
+    every class
+
+  \param fn
+    the function to call
+
+  \return
+    how many blocks are corrupted
+*/
+/*****************************************************************************/
+unsigned SizeClassAllocator::ValidatePages(ObjectAllocator::VALIDATECALLBACK fn) const
+{
+  unsigned corrupted = 0;
+  for (size_t i = 0; i < classes.size(); i++)
+  {
+    corrupted += classes[i]->ValidatePages(fn);
+  }
+  return corrupted;
+}
+
+/*****************************************************************************/
+/*!
+  \brief
+    Frees all empty pages of every class
+
+  \return
+    how many pages were freed
+*/
+/*****************************************************************************/
+unsigned SizeClassAllocator::FreeEmptyPages(void)
+{
+  unsigned freed = 0;
+  for (size_t i = 0; i < classes.size(); i++)
+  {
+    freed += classes[i]->FreeEmptyPages();
+  }
+  return freed;
+}
+
+  // 8, 16, 32, 48, 64, 96, 128, 192 and 256 bytes
+std::vector<size_t> SizeClassAllocator::DefaultClassSizes(void)
+{
+  static const size_t sizes[] = {8, 16, 32, 48, 64, 96, 128, 192, 256};
+  return std::vector<size_t>(sizes, sizes + sizeof(sizes) / sizeof(*sizes));
+}
+
+  // number of size classes
+unsigned SizeClassAllocator::ClassCount(void) const
+{
+  return static_cast<unsigned>(classes.size());
+}
+
+  // object size of a class
+size_t SizeClassAllocator::ClassSize(unsigned index) const
+{
+  return classSizes[index];
+}
+
+  // the allocator of a class
+const ObjectAllocator *SizeClassAllocator::GetClassAllocator(unsigned index) const
+{
+  return classes[index];
+}
+
+/*****************************************************************************/
+/*!
+  \brief
+    Sums the statistics of every class and of the requests that went to
+    new/delete. ObjectSize_ is the largest class, PageSize_ and
+    PageCapacity_ are the totals for the newest page of each class.
+
+  \return
+    the combined statistics
+*/
+/*****************************************************************************/
+OAStats SizeClassAllocator::GetStats(void) const
+{
+  OAStats total = largeStats;
+
+  for (size_t i = 0; i < classes.size(); i++)
+  {
+    OAStats stats = classes[i]->GetStats();
+    total.ObjectSize_ = stats.ObjectSize_;
+    total.PageSize_ += stats.PageSize_;
+    total.PageCapacity_ += stats.PageCapacity_;
+    total.FreeObjects_ += stats.FreeObjects_;
+    total.ObjectsInUse_ += stats.ObjectsInUse_;
+    total.PagesInUse_ += stats.PagesInUse_;
+    total.MostObjects_ += stats.MostObjects_;
+    total.Allocations_ += stats.Allocations_;
+    total.Deallocations_ += stats.Deallocations_;
+  }
+
+  total.ObjectsInUse_ += largeStats.Allocations_ - largeStats.Deallocations_;
+  return total;
+}
+
+/*****************************************************************************/
+/*
+  HELPER FUNCTIONS
+*/
+/*****************************************************************************/
+void SizeClassAllocator::create_classes(const std::vector<size_t> &ClassSizes,
+                                        const OAConfig &config)
+{
+  for (size_t i = 0; i < ClassSizes.size(); i++)
+  {
+    size_t granules = (ClassSizes[i] + SIZE_CLASS_GRANULE - 1) / SIZE_CLASS_GRANULE;
+    classSizes.push_back((granules ? granules : 1) * SIZE_CLASS_GRANULE);
+  }
+  std::sort(classSizes.begin(), classSizes.end());
+  classSizes.erase(std::unique(classSizes.begin(), classSizes.end()), classSizes.end());
+
+  try
+  {
+    for (size_t i = 0; i < classSizes.size(); i++)
+    {
+      classes.push_back(0);
+      classes.back() = new ObjectAllocator(classSizes[i], config);
+    }
+  }
+  catch (...)
+  {
+    // the destructor won't run, so give back the classes made so far
+    for (size_t i = 0; i < classes.size(); i++)
+    {
+      delete classes[i];
+    }
+    throw;
+  }
+
+  // lookup[g] is the smallest class holding g granules
+  if (!classSizes.empty())
+  {
+    lookup.resize(classSizes.back() / SIZE_CLASS_GRANULE + 1);
+  }
+
+  unsigned short index = 0;
+  for (size_t g = 0; g < lookup.size(); g++)
+  {
+    if (classSizes[index] < g * SIZE_CLASS_GRANULE)
+    {
+      index++;
+    }
+    lookup[g] = index;
+  }
+}
+
+unsigned SizeClassAllocator::class_of(size_t Size) const
+{
+  size_t granules = Size / SIZE_CLASS_GRANULE + (Size % SIZE_CLASS_GRANULE != 0);
+
+  if (granules >= lookup.size())
+  {
+    return static_cast<unsigned>(classes.size());
+  }
+  return lookup[granules];
+}
@@ -0,0 +1,70 @@
+//---------------------------------------------------------------------------
+#ifndef SIZECLASSALLOCATORH
+#define SIZECLASSALLOCATORH
+//---------------------------------------------------------------------------
+
+#include "ObjectAllocator.h"
+#include <vector>
+
+// Requests are rounded up to a multiple of this before the class lookup
+static const size_t SIZE_CLASS_GRANULE = 8;
+
+// A general purpose allocator for small objects built out of one
+// ObjectAllocator per size class. Allocate(size) picks the smallest class
+// that fits through a lookup table indexed by size / SIZE_CLASS_GRANULE,
+// anything bigger than the largest class goes to new/delete.
+class SizeClassAllocator
+{
+  public:
+      // Creates an ObjectAllocator for each size class, all with the same config
+      // Throws an exception if the construction fails. (Memory allocation problem)
+    SizeClassAllocator(const std::vector<size_t> &ClassSizes, const OAConfig& config);
+
+      // Creates the allocator with DefaultClassSizes()
+    explicit SizeClassAllocator(const OAConfig& config);
+
+      // Destroys every class's ObjectAllocator (never throws)
+    ~SizeClassAllocator();
+
+      // Allocates an object of at least Size bytes from the smallest class that fits
+      // Throws an exception if the object can't be allocated. (Memory allocation problem)
+    void *Allocate(size_t Size, const char *label = 0);
+
+      // Returns an object to the class it was allocated from (Size must be
+      // the size it was allocated with)
+      // Throws an exception if the the object can't be freed. (Invalid object)
+    void Free(void *Object, size_t Size);
+
+      // Calls the callback fn for each block still in use in every class
+    unsigned DumpMemoryInUse(ObjectAllocator::DUMPCALLBACK fn) const;
+
+      // Calls the callback fn for each block that is potentially corrupted in every class
+    unsigned ValidatePages(ObjectAllocator::VALIDATECALLBACK fn) const;
+
+      // Frees all empty pages of every class
+    unsigned FreeEmptyPages(void);
+
+      // 8, 16, 32, 48, 64, 96, 128, 192 and 256 bytes
+    static std::vector<size_t> DefaultClassSizes(void);
+
+      // Testing/Debugging/Statistic methods
+    unsigned ClassCount(void) const;                               // number of size classes
+    size_t ClassSize(unsigned index) const;                        // object size of a class
+    const ObjectAllocator *GetClassAllocator(unsigned index) const; // the allocator of a class
+    OAStats GetStats(void) const;  // the statistics summed over every class (and new/delete)
+
+  private:
+    void create_classes                  //!< builds the allocators and lookup table
+    (const std::vector<size_t> &ClassSizes, const OAConfig &config);
+    unsigned class_of(size_t Size) const; //!< which class serves a request (ClassCount if none)
+    std::vector<size_t> classSizes;      // object size of every class, smallest first
+    std::vector<ObjectAllocator *> classes; // the allocator of every class
+    std::vector<unsigned short> lookup;  // class index for every granule of request size
+    OAStats largeStats;                  // requests that were too big for any class
+
+      // Make private to prevent copy construction and assignment
+    SizeClassAllocator(const SizeClassAllocator &sca);
+    SizeClassAllocator &operator=(const SizeClassAllocator &sca);
+};
+
+#endif
@@ -0,0 +1,272 @@
+#include "ThreadCachedAllocator.h"
+#include <algorithm>
+
+namespace
+{
+  // a magazine the calling thread holds for one allocator
+  struct CacheEntry
+  {
+    unsigned long long owner;
+    std::shared_ptr<Magazine> magazine;
+  };
+
+  // every magazine the calling thread holds, handed back when it exits
+  struct ThreadCaches
+  {
+    std::vector<CacheEntry> entries;
+
+    ~ThreadCaches()
+    {
+      for (size_t i = 0; i < entries.size(); i++)
+      {
+        entries[i].magazine->abandoned.store(true, std::memory_order_release);
+      }
+    }
+  };
+
+  thread_local ThreadCaches threadCaches;
+
+  // ids are never reused, so a new allocator at a destroyed one's address
+  // can't pick up its stale magazines
+  std::atomic<unsigned long long> nextAllocatorId(1);
+}
+
+/*****************************************************************************/
+/*!
+  \brief
+    Creates the underlying ObjectAllocator per the specified values
+    Throws an exception if the construction fails.
+    (Memory allocation problem)
+
+  \param ObjectSize
+    Size of the objects that are in the blocks
+
+  \param config
+    the configuration of the blocks
+
+  \param MagazineSize
+    how many blocks each thread can keep to itself
+*/
+/*****************************************************************************/
+ThreadCachedAllocator::ThreadCachedAllocator(size_t ObjectSize, const OAConfig& config,
+                                             unsigned MagazineSize)
+  : allocator(ObjectSize, config), id(nextAllocatorId++),
+    magazineSize(MagazineSize < 2 ? 2 : MagazineSize), batchSize(magazineSize / 2)
+{
+}
+
+/*****************************************************************************/
+/*!
+  \brief
+    Destroys the allocator and every thread's magazine (never throws)
+    The cached blocks live on the allocator's pages, so nothing has to be
+    returned, the threads just have to stop using the magazines.
+*/
+/*****************************************************************************/
+ThreadCachedAllocator::~ThreadCachedAllocator()
+{
+  std::lock_guard<std::mutex> guard(lock);
+
+  for (size_t i = 0; i < magazines.size(); i++)
+  {
+    magazines[i]->ownerGone.store(true, std::memory_order_release);
+  }
+}
+
+/*****************************************************************************/
+/*!
+  \brief
+    Takes a block from the calling thread's magazine (refilling it if empty)
+    Throws an exception if the object can't be allocated.
+    (Memory allocation problem)
+
+  \return
+    a pointer to the data allocated
+*/
+/*****************************************************************************/
+void *ThreadCachedAllocator::Allocate(void)
+{
+  Magazine *magazine = local_magazine();
+
+  if (!magazine->count.load(std::memory_order_relaxed))
+  {
+    refill(magazine);
+  }
+
+  unsigned count = magazine->count.load(std::memory_order_relaxed) - 1;
+  magazine->count.store(count, std::memory_order_relaxed);
+  return magazine->blocks[count];
+}
+
+/*****************************************************************************/
+/*!
+  \brief
+    Puts a block in the calling thread's magazine (spilling half if full)
+    Throws an exception if a spilled object can't be freed. (Invalid object)
+
+  \param Object
+    Indicates which object to free
+*/
+/*****************************************************************************/
+void ThreadCachedAllocator::Free(void *Object)
+{
+  Magazine *magazine = local_magazine();
+
+  if (magazine->count.load(std::memory_order_relaxed) == magazineSize)
+  {
+    spill(magazine, batchSize);
+  }
+
+  unsigned count = magazine->count.load(std::memory_order_relaxed);
+  magazine->blocks[count] = Object;
+  magazine->count.store(count + 1, std::memory_order_relaxed);
+}
+
+/*****************************************************************************/
+/*!
+  \brief
+    Returns the calling thread's cached blocks, and those of any threads
+    that have exited, to the shared free list
+*/
+/*****************************************************************************/
+void ThreadCachedAllocator::Flush(void)
+{
+  Magazine *magazine = local_magazine();
+  spill(magazine, magazine->count.load(std::memory_order_relaxed));
+}
+
+  // blocks parked in magazines of all threads
+unsigned ThreadCachedAllocator::CachedObjects(void) const
+{
+  std::lock_guard<std::mutex> guard(lock);
+
+  unsigned cached = 0;
+  for (size_t i = 0; i < magazines.size(); i++)
+  {
+    cached += magazines[i]->count.load(std::memory_order_relaxed);
+  }
+  return cached;
+}
+
+  // returns the configuration parameters
+OAConfig ThreadCachedAllocator::GetConfig(void) const
+{
+  std::lock_guard<std::mutex> guard(lock);
+  return allocator.GetConfig();
+}
+
+  // returns the statistics for the allocator
+OAStats ThreadCachedAllocator::GetStats(void) const
+{
+  std::lock_guard<std::mutex> guard(lock);
+  return allocator.GetStats();
+}
+
+/*****************************************************************************/
+/*
+  HELPER FUNCTIONS
+*/
+/*****************************************************************************/
+Magazine *ThreadCachedAllocator::local_magazine(void)
+{
+  std::vector<CacheEntry> &entries = threadCaches.entries;
+
+  for (size_t i = 0; i < entries.size(); i++)
+  {
+    if (entries[i].owner == id)
+    {
+      return entries[i].magazine.get();
+    }
+  }
+
+  // first use from this thread, so drops magazines of destroyed allocators
+  std::vector<CacheEntry>::iterator kept = entries.begin();
+  for (size_t i = 0; i < entries.size(); i++)
+  {
+    if (!entries[i].magazine->ownerGone.load(std::memory_order_acquire))
+    {
+      *kept++ = entries[i];
+    }
+  }
+  entries.erase(kept, entries.end());
+
+  CacheEntry entry;
+  try
+  {
+    entry.owner = id;
+    entry.magazine = std::make_shared<Magazine>(magazineSize);
+    entries.push_back(entry);
+  }
+  catch (std::bad_alloc &)
+  {
+    throw OAException(OAException::E_NO_MEMORY, "could not allocate the magazine");
+  }
+
+  std::lock_guard<std::mutex> guard(lock);
+  magazines.push_back(entry.magazine);
+  return entry.magazine.get();
+}
+
+void ThreadCachedAllocator::refill(Magazine *magazine)
+{
+  std::lock_guard<std::mutex> guard(lock);
+  reclaim_abandoned();
+
+  try
+  {
+    allocator.AllocateBatch(&magazine->blocks[0], batchSize);
+  }
+  catch (const OAException &)
+  {
+    // the allocator can't supply a whole batch, one block is still enough
+    magazine->blocks[0] = allocator.Allocate();
+    magazine->count.store(1, std::memory_order_relaxed);
+    return;
+  }
+  magazine->count.store(batchSize, std::memory_order_relaxed);
+}
+
+void ThreadCachedAllocator::spill(Magazine *magazine, unsigned amount)
+{
+  std::lock_guard<std::mutex> guard(lock);
+  reclaim_abandoned();
+
+  // the count drops first so blocks that fail the allocator's checks 
+  // aren't handed out again
+  unsigned count = magazine->count.load(std::memory_order_relaxed) - amount;
+  magazine->count.store(count, std::memory_order_relaxed);
+  allocator.FreeBatch(&magazine->blocks[count], amount);
+}
+
+void ThreadCachedAllocator::reclaim_abandoned(void)
+{
+  // moves the magazines of threads that have exited to the back first (by
+  // swapping, which can't throw), so the list is whole whatever the frees do
+  std::vector<std::shared_ptr<Magazine> >::iterator abandoned = 
+    std::partition(magazines.begin(), magazines.end(), 
+                   [](const std::shared_ptr<Magazine> &magazine)
+                   { return !magazine->abandoned.load(std::memory_order_acquire); });
+
+  // nobody else can touch the magazine of a thread that has exited. Its 
+  // blocks go back from the top, so a block that fails the allocator's 
+  // checks is dropped and the ones under it stay for the next call
+  std::vector<std::shared_ptr<Magazine> >::iterator emptied = abandoned;
+  try
+  {
+    for (; emptied != magazines.end(); ++emptied)
+    {
+      Magazine *magazine = emptied->get();
+      for (unsigned count = magazine->count.load(std::memory_order_relaxed); count > 0; count--)
+      {
+        magazine->count.store(count - 1, std::memory_order_relaxed);
+        allocator.Free(magazine->blocks[count - 1]);
+      }
+    }
+  }
+  catch (const OAException &)
+  {
+    magazines.erase(abandoned, emptied);
+    throw;
+  }
+  magazines.erase(abandoned, magazines.end());
+}
@@ -0,0 +1,81 @@
+//---------------------------------------------------------------------------
+#ifndef THREADCACHEDALLOCATORH
+#define THREADCACHEDALLOCATORH
+//---------------------------------------------------------------------------
+
+#include "ObjectAllocator.h"
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+// If the client doesn't specify it:
+static const unsigned DEFAULT_MAGAZINE_SIZE = 64;
+
+// One thread's private stash of blocks for one ThreadCachedAllocator
+struct Magazine
+{
+  Magazine(unsigned capacity) : blocks(capacity), count(0), abandoned(false), ownerGone(false) {};
+
+  std::vector<void *> blocks;   // the cached blocks (only the first count are valid)
+  std::atomic<unsigned> count;  // number of blocks in the magazine
+  std::atomic<bool> abandoned;  // the thread using it has exited
+  std::atomic<bool> ownerGone;  // the allocator it belongs to has been destroyed
+};
+
+// A thread-safe front-end for an ObjectAllocator. Each thread keeps a
+// magazine of blocks so Allocate/Free only take the shared lock when the
+// magazine runs empty (refill) or overflows (spill), and then move half
+// a magazine at once with AllocateBatch/FreeBatch.
+//
+// Blocks sitting in magazines count as in use as far as the underlying
+// ObjectAllocator is concerned, so debug checks only see a block when it
+// is spilled back. Labels are not supported since blocks are taken from
+// the allocator before the client asks for them.
+class ThreadCachedAllocator
+{
+  public:
+      // Creates the underlying ObjectAllocator per the specified values
+      // Throws an exception if the construction fails. (Memory allocation problem)
+    ThreadCachedAllocator(size_t ObjectSize, const OAConfig& config,
+                          unsigned MagazineSize = DEFAULT_MAGAZINE_SIZE);
+
+      // Destroys the allocator and every thread's magazine (never throws)
+    ~ThreadCachedAllocator();
+
+      // Takes a block from the calling thread's magazine (refilling it if empty)
+      // Throws an exception if the object can't be allocated. (Memory allocation problem)
+    void *Allocate(void);
+
+      // Puts a block in the calling thread's magazine (spilling half if full)
+      // Throws an exception if a spilled object can't be freed. (Invalid object)
+    void Free(void *Object);
+
+      // Returns the calling thread's cached blocks, and those of any threads
+      // that have exited, to the shared free list
+    void Flush(void);
+
+      // Testing/Debugging/Statistic methods
+    unsigned CachedObjects(void) const;   // blocks parked in magazines of all threads
+    OAConfig GetConfig(void) const;       // returns the configuration parameters
+    OAStats GetStats(void) const;         // returns the statistics for the allocator
+
+  private:
+    Magazine *local_magazine(void);      //!< finds (or makes) the calling thread's magazine
+    void refill(Magazine *magazine);     //!< moves a batch from the shared free list
+    void spill                           //!< moves blocks back to the shared free list
+    (Magazine *magazine, unsigned amount);
+    void reclaim_abandoned(void);        //!< empties magazines of exited threads
+    ObjectAllocator allocator;           // the shared allocator (guarded by lock)
+    mutable std::mutex lock;             // guards allocator and magazines
+    std::vector<std::shared_ptr<Magazine> > magazines; // every thread's magazine
+    unsigned long long id;               // tells this allocator's magazines apart
+    unsigned magazineSize;               // blocks each magazine can hold
+    unsigned batchSize;                  // blocks moved per refill/spill
+
+      // Make private to prevent copy construction and assignment
+    ThreadCachedAllocator(const ThreadCachedAllocator &tca);
+    ThreadCachedAllocator &operator=(const ThreadCachedAllocator &tca);
+};
+
+#endif
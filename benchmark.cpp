@@ -0,0 +1,194 @@
+// Allocation benchmarks for ObjectAllocator
+//
+//   make bench PRG=bench              (-O2, or BENCHOPT=-O3)
+//   ./bench [objects] [rounds]
+//
+// Every free order is run for each header type with debug off and on, and
+// then through the UseCPPMemManager_ (new/delete) path as the reference.
+// Throughput comes from an untimed pass over the whole workload, latency
+// from a second pass that times every call, so the percentiles include
+// the clock's own overhead (shown on the first line) but the ops/sec
+// don't.
+
+#include <iostream>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+#include <algorithm>
+#include <chrono>
+
+#include "ObjectAllocator.h"
+#include "PRNG.h"
+
+using std::printf;
+
+typedef std::chrono::steady_clock Clock;
+
+struct Student
+{
+  int Age;
+  float GPA;
+  long long Year;
+  long long ID;
+};
+
+// How the objects are handed back
+enum FreeOrder {foChurn, foLIFO, foFIFO, foRandom};
+
+const char *ORDER_NAMES[] = {"churn", "lifo", "fifo", "random"};
+const char *HEADER_NAMES[] = {"none", "basic", "extended", "external"};
+
+// Latencies of one kind of call, in nanoseconds
+struct Latencies
+{
+  std::vector<double> samples;
+
+  void add(Clock::time_point start, Clock::time_point end)
+  {
+    samples.push_back(std::chrono::duration<double, std::nano>(end - start).count());
+  }
+
+  double percentile(double p)
+  {
+    if (samples.empty())
+      return 0;
+    size_t index = static_cast<size_t>(p * static_cast<double>(samples.size() - 1));
+    std::nth_element(samples.begin(), samples.begin() + static_cast<std::ptrdiff_t>(index), samples.end());
+    return samples[index];
+  }
+};
+
+// Times fn around each call if latencies is given
+template <typename Fn>
+void Call(Fn fn, Latencies *latencies)
+{
+  if (!latencies)
+  {
+    fn();
+    return;
+  }
+  Clock::time_point start = Clock::now();
+  fn();
+  latencies->add(start, Clock::now());
+}
+
+// Runs the workload once, returning how many calls it made
+unsigned RunWorkload(ObjectAllocator *oa, FreeOrder order, std::vector<void *> &objects,
+                     const std::vector<unsigned> &shuffle, unsigned rounds,
+                     Latencies *allocs, Latencies *frees)
+{
+  unsigned count = static_cast<unsigned>(objects.size());
+  unsigned calls = 0;
+
+  for (unsigned round = 0; round < rounds; round++)
+  {
+    for (unsigned i = 0; i < count; i++)
+      Call([&]() { objects[i] = oa->Allocate(); }, allocs);
+    calls += count;
+
+    switch (order)
+    {
+      case foChurn: // frees and reallocates random objects while holding them all, then frees them all
+        for (unsigned i = 0; i < count; i++)
+        {
+          unsigned victim = shuffle[i];
+          Call([&]() { oa->Free(objects[victim]); }, frees);
+          Call([&]() { objects[victim] = oa->Allocate(); }, allocs);
+        }
+        calls += count * 2;
+        for (unsigned i = 0; i < count; i++)
+          Call([&]() { oa->Free(objects[i]); }, frees);
+        break;
+      case foLIFO:
+        for (unsigned i = count; i > 0; i--)
+          Call([&]() { oa->Free(objects[i - 1]); }, frees);
+        break;
+      case foFIFO:
+        for (unsigned i = 0; i < count; i++)
+          Call([&]() { oa->Free(objects[i]); }, frees);
+        break;
+      case foRandom:
+        for (unsigned i = 0; i < count; i++)
+          Call([&]() { oa->Free(objects[shuffle[i]]); }, frees);
+        break;
+    }
+    calls += count;
+  }
+  return calls;
+}
+
+// Benchmarks one configuration and prints its line
+void Benchmark(FreeOrder order, OAConfig::HBLOCK_TYPE header, bool debug, bool newdel,
+               unsigned count, unsigned rounds, const std::vector<unsigned> &shuffle)
+{
+  const unsigned objectsPerPage = 1024;
+  unsigned pages = count / objectsPerPage + 2;
+  OAConfig config(newdel, objectsPerPage, pages, debug, debug ? 2 : 0,
+                  OAConfig::HeaderBlockInfo(header, header == OAConfig::hbExtended ? 4 : 0), 0);
+  std::vector<void *> objects(count);
+
+  try
+  {
+    ObjectAllocator oa(sizeof(Student), config);
+
+      // warms the pages up, then the untimed pass for throughput
+    RunWorkload(&oa, order, objects, shuffle, 1, 0, 0);
+    Clock::time_point start = Clock::now();
+    unsigned calls = RunWorkload(&oa, order, objects, shuffle, rounds, 0, 0);
+    double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+
+    Latencies allocs, frees;
+    allocs.samples.reserve(count * 2);
+    frees.samples.reserve(count * 2);
+    RunWorkload(&oa, order, objects, shuffle, 1, &allocs, &frees);
+
+    printf("%-7s %-9s %-6s %-8s %9.2f  %6.0f %6.0f %7.0f  %6.0f %6.0f %7.0f\n",
+           ORDER_NAMES[order], newdel ? "-" : HEADER_NAMES[header], debug ? "on" : "off",
+           newdel ? "new" : "oa", calls / seconds / 1e6,
+           allocs.percentile(0.5), allocs.percentile(0.99), allocs.percentile(0.999),
+           frees.percentile(0.5), frees.percentile(0.99), frees.percentile(0.999));
+  }
+  catch (const OAException &e)
+  {
+    printf("%-7s %-9s %-6s %-8s failed: %s\n", ORDER_NAMES[order], HEADER_NAMES[header],
+           debug ? "on" : "off", newdel ? "new" : "oa", e.what());
+  }
+}
+
+int main(int argc, char **argv)
+{
+  unsigned count = 100000;
+  unsigned rounds = 10;
+  if (argc > 1)
+    count = static_cast<unsigned>(std::atoi(argv[1]));
+  if (argc > 2)
+    rounds = static_cast<unsigned>(std::atoi(argv[2]));
+
+    // the same random order for every configuration
+  Digipen::Utils::srand(1, 2);
+  std::vector<unsigned> shuffle(count);
+  for (unsigned i = 0; i < count; i++)
+    shuffle[i] = i;
+  for (unsigned i = count; i > 1; i--)
+    std::swap(shuffle[i - 1], shuffle[Digipen::Utils::rand() % i]);
+
+    // what a timed call costs with nothing in it
+  Latencies empty;
+  for (unsigned i = 0; i < 100000; i++)
+    Call([]() {}, &empty);
+
+  printf("objects: %u, rounds: %u, clock overhead p50: %.0f ns\n", count, rounds, empty.percentile(0.5));
+  printf("%-7s %-9s %-6s %-8s %9s  %22s  %22s\n", "order", "header", "debug", "manager",
+         "Mops/s", "alloc p50/p99/p999 ns", "free p50/p99/p999 ns");
+
+  const OAConfig::HBLOCK_TYPE headers[] = {OAConfig::hbNone, OAConfig::hbBasic,
+                                           OAConfig::hbExtended, OAConfig::hbExternal};
+  for (unsigned order = foChurn; order <= foRandom; order++)
+  {
+    for (unsigned debug = 0; debug < 2; debug++)
+      for (unsigned h = 0; h < 4; h++)
+        Benchmark(static_cast<FreeOrder>(order), headers[h], debug != 0, false, count, rounds, shuffle);
+    Benchmark(static_cast<FreeOrder>(order), OAConfig::hbNone, false, true, count, rounds, shuffle);
+  }
+  return 0;
+}
@@ -1,2373 +1,4723 @@
-#include <iostream> 
-#include <cstdio>
-#include <cstring>
-#include <cstdlib>
-
-using std::cout;
-using std::endl;
-using std::printf;
-
-int SHOWADDRESS1 = 0;    // DumpCallback
-int SHOWADDRESS2 = 0;    // ValidateCallback
-int SHOWREAL = 0;        // DumpPages, DumpPagesEx
-int SHOW_EXCEPTIONS = 0; // Show student exceptions in all tests
-int EXTRA_CREDIT = 0;    // Run extra credit tests (Alignment, FreeEmptyPages)
-
-#include "ObjectAllocator.h"
-#include "PRNG.h"
-
-struct Student
-{
-  int Age;       
-  float GPA;
-  long long Year;
-  long long ID;  
-};
-
-struct Employee
-{
-  Employee *Next;
-  char lastName[12];
-  char firstName[12];
-  float salary;
-  int years;
-};
-
-
-ObjectAllocator *studentObjectMgr;
-ObjectAllocator *employeeObjectMgr;
-
-// Support functions
-void PrintCounts(const ObjectAllocator *nm);
-void PrintCounts2(const ObjectAllocator *nm);
-void PrintConfig(const ObjectAllocator *nm);
-void DumpPages(const ObjectAllocator *nm, unsigned width = 16);
-void DumpPagesEx(const ObjectAllocator *nm, unsigned width = 16);
-
-void DoStudents(unsigned padding = 0, bool printall = false);
-void DoEmployees(void);               
-void TestPadding(unsigned size);      
-void TestBasicHeaderBlocks();         
-void TestCorruption(void);            
-void DisableOA(void);                 
-void TestLeak(void);                  
-void TestValidate(void);              
-void TestAlignment(void);             
-void TestFreeEmptyPages1(void);       
-void TestFreeEmptyPages2(void);       
-void TestFreeEmptyPages3(void);       
-void StressFreeChecking(void);        
-void Stress(bool UseNewDelete);       
-
-struct Person
-{
-  char lastName[12];   
-  char firstName[12];  
-  float salary;        
-  int years;           
-};
-
-struct Person PEOPLE[] = {
-  {"Faith", "Ian", 80000, 10},
-  {"Tufnel", "Nigel", 90000, 12},
-  {"Savage", "Viv", 50000, 4},
-  {"Shrimpton", "Mick", 50000, 4},
-  {"Besser", "Joe", 40000, 1},
-  {"Smalls", "Derek", 80000, 10},
-  {"St.Hubbins", "David", 90000, 12},
-  {"Fleckman", "Bobbi", 120000, 8},
-  {"Eton-Hogg", "Denis", 250000, 22},
-  {"Upham", "Denny", 60000, 5},
-  {"McLochness", "Ross", 60000, 5},
-  {"Pudding", "Ronnie", 50000, 2},
-  {"Schindler", "Danny", 60000, 3},
-  {"Pettibone", "Jeanine", 85000, 3},
-  {"Fame", "Duke", 95000, 8},
-  {"Fufkin", "Artie", 45000, 1},
-  {"DiBergi", "Marty", 15000, 7},
-  {"Floyd", "Pink", 25000, 6},
-  {"Zeppelin", "Led", 35000, 3},
-  {"Mason", "Nick", 15000, 7},
-  {"Wright", "Richard", 17000, 9},
-  {"Waters", "Roger", 10000, 3},
-  {"Gilmore", "David", 19000, 5}
-};
-
-void FillEmployee(Employee& emp)
-{
-  static unsigned int index = 0;
-
-  strcpy(emp.firstName, PEOPLE[index].firstName);
-  strcpy(emp.lastName, PEOPLE[index].lastName);
-  emp.salary = PEOPLE[index].salary;
-  emp.years = PEOPLE[index].years;
-  index++;
-  if (index >= sizeof(PEOPLE) / sizeof(*PEOPLE))
-    index = 0;
-}
-
-void DumpCallback(const void *block, size_t actual_size)
-{
-  size_t size = actual_size;
-    // limit to 16 bytes
-  if (actual_size > 16)
-    size = 16;
-
-  unsigned char *data = const_cast<unsigned char*>(static_cast<const unsigned char *>(block));
-
-  if (SHOWADDRESS1)
-    printf("Block at 0x%p, %u bytes long.\n", block, static_cast<unsigned>(actual_size));
-  else
-    printf("Block at 0x00000000, %u bytes long.\n", static_cast<unsigned>(actual_size));
-
-    // If we were passed a NULL pointer, do nothing
-  if (!block)
-    return;
-
-  printf(" Data: <");
-  for (unsigned int i = 0; i < size; i++)
-  {
-    unsigned char c = *data++;
-    if (c > 31 && c < 128) // printable range
-      printf("%c", c);
-    else
-      printf(" ");
-  }
-  printf(">");
-
-  data = const_cast<unsigned char*>(static_cast<const unsigned char *>(block));
-  for (unsigned int i = 0; i < size; i++)
-    printf(" %02X", static_cast<int>(*data++));
-  printf("\n");
-}
-
-void DumpCallback2(const void *, size_t)
-{
-}
-
-void CheckAndDumpLeaks(const ObjectAllocator* oa)
-{
-  if (oa->GetStats().ObjectsInUse_)
-  {
-    printf("Detected memory leaks!\n");
-    printf("Dumping objects ->\n");
-    unsigned leaks = oa->DumpMemoryInUse(DumpCallback);
-    printf("Object dump complete. [%u]\n", leaks);
-  }
-  else
-    printf("No leaks detected.\n");
-}
-
-void ValidateCallback(const void *block, size_t actual_size)
-{
-  if (SHOWADDRESS2)
-    printf("Block at 0x%p, %u bytes long.\n", block, static_cast<unsigned>(actual_size));
-  else
-    printf("Block at 0x00000000, %u bytes long.\n", static_cast<unsigned>(actual_size));
-
-  if (!block)
-    return;
-}
-
-//****************************************************************************************************
-//****************************************************************************************************
-int RandomInt(int low, int high)
-{
-  //return std::rand() % (high - low + 1) + low;
-  return Digipen::Utils::Random(low, high);
-}
-
-template <typename T>
-void SwapT(T &a, T &b)
-{
-  T temp = a;
-  a = b;
-  b = temp;
-}
-
-template <typename T>
-void Shuffle(T *array, unsigned count)
-{
-  for (unsigned int i = 0; i < count; i++)
-  {
-    int r = RandomInt(static_cast<int>(i), static_cast<int>(count) - 1);
-    SwapT(array[i], array[r]);
-  }
-}
-
-template <typename T>
-void PrintArray(T *array, unsigned count)
-{
-  for (unsigned i = 0; i < count; i++)
-    std::cout << array[i] << std::endl;
-}
-
-const unsigned objects = 4096;
-const unsigned pages = 100;
-const unsigned total = objects * pages;
-void *ptrs[total];
-
-#include <ctime>
-void Stress(bool UseNewDelete)
-{
-  ObjectAllocator *oa;
-    
-  try
-  {
-    bool newdel = UseNewDelete;
-    bool debug = false;
-    unsigned padbytes = 0;
-    OAConfig::HeaderBlockInfo header(OAConfig::hbNone);
-    unsigned alignment = 0;
-
-    OAConfig config(newdel, objects, pages, debug, padbytes, header, alignment);
-    oa  = new ObjectAllocator(sizeof(Student), config);
-    for (unsigned i = 0; i < total; i++)
-    {
-      void *p = oa->Allocate();
-      ptrs[i] = p;
-    }
-
-    Shuffle(ptrs, total);
-    for (unsigned i = 0; i < total; i++)
-    {
-      oa->Free(ptrs[i]);
-    }
-
-    delete oa;
-  }
-  catch (const OAException& e)
-  {
-    if (SHOW_EXCEPTIONS)
-      cout << e.what() << endl;
-    else
-      cout << "Exception thrown during construction in Stress."  << endl;
-
-    return;
-  }
-}
-
-void StressFreeChecking(const OAConfig::HeaderBlockInfo& header)
-{
-  unsigned objects;
-  unsigned pages;
-
-  objects = 1000;
-  pages = 10;
-
-  const unsigned total = objects * pages;
-
-  ObjectAllocator *oa;
-    
-  char **ptrs = new char*[total];
-  
-  try
-  { 
-    bool newdel = false;
-    bool debug = true;
-    unsigned padbytes = 0;
-    unsigned alignment = 0;
-
-    OAConfig config(newdel, objects, pages, debug, padbytes, header, alignment);
-    oa  = new ObjectAllocator(sizeof(Student), config);
-
-    for (unsigned int i = 0; i < total; i++)
-    {
-      void *p = oa->Allocate();
-      ptrs[i] = static_cast<char *>(p);
-    }
-
-    PrintConfig(oa);
-    PrintCounts(oa);
-    //DumpPagesEx(oa, 42);
-
-    Shuffle(ptrs, total);
-    for (unsigned int i = 0; i < total; i++)
-    {
-      oa->Free(ptrs[i]);
-    }
-
-    oa->DumpMemoryInUse(DumpCallback2);
-    delete oa;
-  }
-  catch (const OAException& e)
-  {
-    if (SHOW_EXCEPTIONS)
-      cout << e.what() << endl;
-    else
-    {
-      cout << "Exception thrown during StressFreeChecking."  << endl;
-      fflush(stdout);
-    }
-
-    return;
-  }
-  delete [] ptrs;
-}
-
-void TestFreeEmptyPages1(void)
-{
-  if (!ObjectAllocator::ImplementedExtraCredit())
-    return;
-
-  ObjectAllocator *oa;
-  const int objects = 4;
-  const int pages = 3;
-  const int total = objects * pages;
-  void *ptrs[total];
-  try
-  {
-    bool newdel = false;
-    bool debug = true;
-    unsigned padbytes = 2;
-    OAConfig::HeaderBlockInfo header(OAConfig::hbNone);
-    unsigned alignment = 0;
-
-    OAConfig config(newdel, objects, pages, debug, padbytes, header, alignment);
-    oa  = new ObjectAllocator(sizeof(Student), config);
-
-    unsigned width = 32; 
-
-    for (int i = 0; i < total; i++)
-    {
-      void *p = oa->Allocate();
-      ptrs[i] = p;
-    }
-    //****************************************************************************
-    PrintConfig(oa);
-    PrintCounts(oa);
-    DumpPages(oa, width);
-
-    for (int i = 0; i < objects; i++)
-      oa->Free(ptrs[i + 0]);
-
-    for (int i = 0; i < objects; i++)
-      oa->Free(ptrs[i + 8]);
-
-    //****************************************************************************
-    PrintCounts(oa);
-    DumpPages(oa, width);
-
-    //****************************************************************************
-    oa->FreeEmptyPages();
-    PrintCounts(oa);
-    DumpPages(oa, width);
-
-    //****************************************************************************
-    for (int i = 0; i < objects - 1; i++)
-      oa->Free(ptrs[i + 4]);
-    oa->FreeEmptyPages();
-    PrintCounts(oa);
-    DumpPages(oa, width);
-
-    //****************************************************************************
-    oa->Free(ptrs[7]);
-    oa->FreeEmptyPages();
-    PrintCounts(oa);
-    DumpPages(oa, width);
-
-
-    //****************************************************************************
-    printf("\n\n");
-    void *p = oa->Allocate();
-    oa->FreeEmptyPages();
-    PrintCounts(oa);
-    DumpPages(oa, width);
-
-    oa->Free(p);
-    //oa->FreeEmptyPages();
-    PrintCounts(oa);
-    DumpPages(oa, width);
-
-    oa->FreeEmptyPages();
-    PrintCounts(oa);
-    DumpPages(oa, width);
-
-    delete oa;
-  }
-  catch (const OAException& e)
-  {
-    if (SHOW_EXCEPTIONS)
-      cout << e.what() << endl;
-    else
-      cout << "Exception thrown during TestFreeEmptyPages1."  << endl;
-
-    return;
-  }
-}
-
-void TestFreeEmptyPages2(void)
-{
-  if (!ObjectAllocator::ImplementedExtraCredit())
-    return;
-
-  ObjectAllocator *oa;
-  const int objects = 4;
-  const int pages = 3;
-  const int total = objects * pages;
-  void *ptrs[total];
-  try
-  {
-    bool newdel = false;
-    bool debug = true;
-    unsigned padbytes = 2;
-    OAConfig::HeaderBlockInfo header(OAConfig::hbBasic);
-    unsigned alignment = 16;
-
-    OAConfig config(newdel, objects, pages, debug, padbytes, header, alignment);
-    oa  = new ObjectAllocator(sizeof(Student), config);
-
-    unsigned width = 32;
-
-    for (int i = 0; i < total; i++)
-    {
-      void *p = oa->Allocate();
-      ptrs[i] = p;
-    }
-    //****************************************************************************
-    PrintConfig(oa);
-    PrintCounts(oa);
-    DumpPages(oa, width);
-
-    for (int i = 0; i < objects; i++)
-      oa->Free(ptrs[i + 0]);
-
-    for (int i = 0; i < objects; i++)
-      oa->Free(ptrs[i + 8]);
-
-    //****************************************************************************
-    PrintCounts(oa);
-    DumpPages(oa, width);
-
-    //****************************************************************************
-    oa->FreeEmptyPages();
-    PrintCounts(oa);
-    DumpPages(oa, width);
-
-    //****************************************************************************
-    for (int i = 0; i < objects - 1; i++)
-      oa->Free(ptrs[i + 4]);
-    oa->FreeEmptyPages();
-    PrintCounts(oa);
-    DumpPages(oa, width);
-
-    //****************************************************************************
-    oa->Free(ptrs[7]);
-    oa->FreeEmptyPages();
-    PrintCounts(oa);
-    DumpPages(oa, width);
-
-    delete oa;
-  }
-  catch (const OAException& e)
-  {
-    if (SHOW_EXCEPTIONS)
-      cout << e.what() << endl;
-    else
-      cout << "Exception thrown during TestFreeEmptyPages2."  << endl;
-
-    return;
-  }
-}
-
-void TestFreeEmptyPages3(void)
-{
-  if (!ObjectAllocator::ImplementedExtraCredit())
-    return;
-
-  ObjectAllocator *oa;
-  const int objects = 8;
-  const int pages = 48;
-  const int total = objects * pages;
-  void *ptrs[total];
-  try
-  {
-    bool newdel = false;
-    bool debug = true;
-    unsigned padbytes = 6;
-    OAConfig::HeaderBlockInfo header(OAConfig::hbExtended, 9);
-    unsigned alignment = 0;
-
-    OAConfig config(newdel, objects, pages, debug, padbytes, header, alignment);
-    oa  = new ObjectAllocator(sizeof(Student), config);
-
-    unsigned width = 32; 
-
-    for (int i = 0; i < total; i++)
-    {
-      void *p = oa->Allocate();
-      ptrs[i] = p;
-    }
-    PrintConfig(oa);
-    PrintCounts(oa);
-    //DumpPages(oa, width);
-
-    Shuffle(ptrs, total);
-    for (int i = 0; i < total - 5; i++)
-    {
-      oa->Free(ptrs[i]);
-    }
-    PrintCounts(oa);
-    //DumpPages(oa, width);
-
-    unsigned count = oa->FreeEmptyPages();
-    PrintCounts(oa);
-    DumpPages(oa, width);
-    printf("%i pages freed\n", count);
-
-    delete oa;
-  }
-  catch (const OAException& e)
-  {
-    if (SHOW_EXCEPTIONS)
-      cout << e.what() << endl;
-    else
-      cout << "Exception thrown during TestFreeEmptyPages3."  << endl;
-
-    return;
-  }
-}
-
-void TestFreeEmptyPages4(void)
-{
-  if (!ObjectAllocator::ImplementedExtraCredit())
-    return;
-
-  ObjectAllocator *oa;
-  const int objects = 8;
-  const int pages = 48;
-  const int total = objects * pages;
-  void *ptrs[total];
-  try
-  {
-    bool newdel = false;
-    bool debug = true;
-    unsigned padbytes = 6;
-    OAConfig::HeaderBlockInfo header(OAConfig::hbExtended, 9);
-    unsigned alignment = 0;
-
-    OAConfig config(newdel, objects, pages, debug, padbytes, header, alignment);
-    oa  = new ObjectAllocator(sizeof(Student), config);
-
-    unsigned width = 32; 
-
-    for (int i = 0; i < total; i++)
-    {
-      void *p = oa->Allocate();
-      ptrs[i] = p;
-    }
-    PrintConfig(oa);
-    PrintCounts(oa);
-    DumpPages(oa, width);
-
-    Shuffle(ptrs, total);
-    for (int i = 0; i < total - 5; i++)
-    {
-      oa->Free(ptrs[i]);
-      PrintCounts(oa);
-      DumpPages(oa, width);
-    }
-    //PrintCounts(oa);
-    //DumpPages(oa, width);
-
-    unsigned count = oa->FreeEmptyPages();
-    PrintCounts(oa);
-    DumpPages(oa, width);
-    printf("%i pages freed\n", count);
-
-    delete oa;
-  }
-  catch (const OAException& e)
-  {
-    if (SHOW_EXCEPTIONS)
-      cout << e.what() << endl;
-    else
-      cout << "Exception thrown during TestFreeEmptyPages3."  << endl;
-
-    return;
-  }
-}
-
-//****************************************************************************************************
-//****************************************************************************************************
-void TestBasicHeaderBlocks()
-{
-  ObjectAllocator *oa = 0;
-
-  try 
-  {
-    bool newdel = false;
-    bool debug = true;
-    unsigned padbytes = 2;
-    OAConfig::HeaderBlockInfo header(OAConfig::hbBasic);
-    unsigned alignment = 1;
-
-    OAConfig config(newdel, 4, 2, debug, padbytes, header, alignment);
-    oa = new ObjectAllocator(sizeof(Student), config);
-  }
-  catch (const OAException& e)
-  {
-    if (SHOW_EXCEPTIONS)
-      cout << e.what() << endl;
-    else
-      cout << "Exception thrown during construction in TestBasicHeaderBlocks."  << endl;
-
-    return;
-  }
-
-  unsigned wrap = 32;
-  PrintConfig(oa);
-  PrintCounts(oa);
-  DumpPages(oa, wrap);
-
-  Student *pStudent1 = 0;
-  try
-  {
-    pStudent1 = static_cast<Student *>( oa->Allocate() );
-  }
-  catch (const OAException& e)
-  {
-    if (SHOW_EXCEPTIONS)
-      cout << e.what() << endl;
-    else
-      cout << "Exception thrown from Allocate in TestBasicHeaderBlocks."  << endl;
-  }
-  catch(...)
-  {
-    cout << "Unexpected exception thrown from Allocate in TestBasicHeaderBlocks."  << endl;
-  }
-
-  Student *pStudent2 = 0;
-  try
-  {
-    pStudent2 = static_cast<Student *>( oa->Allocate() );
-  }
-  catch (const OAException& e)
-  {
-    if (SHOW_EXCEPTIONS)
-      cout << e.what() << endl;
-    else
-      cout << "Exception thrown from Allocate in TestBasicHeaderBlocks."  << endl;
-  }
-  catch(...)
-  {
-    cout << "Unexpected exception thrown from Allocate in TestBasicHeaderBlocks."  << endl;
-  }
-
-  DumpPages(oa, wrap);
-
-  try
-  {
-    oa->Free(pStudent1);
-  }
-  catch (const OAException& e)
-  {
-    if (SHOW_EXCEPTIONS) 
-      cout << e.what() << endl;
-    else
-      cout << "Exception thrown from Free in TestBasicHeaderBlocks."  << endl;
-  }
-  catch(...)
-  {
-    cout << "Unexpected exception thrown from Free in TestBasicHeaderBlocks."  << endl;
-  }
-
-  DumpPages(oa, wrap);
-
-  try
-  {
-    oa->Free(pStudent2);
-  }
-  catch (const OAException& e)
-  {
-    if (SHOW_EXCEPTIONS) 
-      cout << e.what() << endl;
-    else
-      cout << "Exception thrown from Free in TestBasicHeaderBlocks."  << endl;
-  }
-  catch(...)
-  {
-    cout << "Unexpected exception thrown from Free in TestBasicHeaderBlocks."  << endl;
-  }
-
-  DumpPages(oa, wrap);
-
-  try
-  {
-    pStudent1 = static_cast<Student *>( oa->Allocate() );
-  }
-  catch (const OAException& e)
-  {
-    if (SHOW_EXCEPTIONS)
-      cout << e.what() << endl;
-    else
-      cout << "Exception thrown from Allocate in TestBasicHeaderBlocks."  << endl;
-  }
-  catch(...)
-  {
-    cout << "Unexpected exception thrown from Allocate in TestBasicHeaderBlocks."  << endl;
-  }
-
-  DumpPages(oa, wrap);
-  delete oa;
-}
-
-//****************************************************************************************************
-//****************************************************************************************************
-void TestExtendedHeaderBlocks(unsigned size)
-{
-  ObjectAllocator *oa = 0;
-  unsigned wrap = 32;
-
-  try 
-  {
-    bool newdel = false;
-    bool debug = true;
-    unsigned padbytes = 2;
-    OAConfig::HeaderBlockInfo header(OAConfig::hbExtended, size);
-    unsigned alignment = 0;
-
-    OAConfig config(newdel, 4, 2, debug, padbytes, header, alignment);
-    oa = new ObjectAllocator(sizeof(Student), config);
-  }
-  catch (const OAException& e)
-  {
-    if (SHOW_EXCEPTIONS)
-      cout << e.what() << endl;
-    else
-      cout << "Exception thrown during construction in TestExtendedHeaderBlocks."  << endl;
-
-    return;
-  }
-
-  PrintConfig(oa);
-  PrintCounts(oa);
-  DumpPages(oa, wrap);
-
-  ///////////////////////////////////////////////////////////////////////////////////////////////
-  ///////////////////////////////////////////////////////////////////////////////////////////////
-  Student *pStudent1 = 0;
-  try
-  {
-    pStudent1 = static_cast<Student *>( oa->Allocate() );
-  }
-  catch (const OAException& e)
-  {
-    if (SHOW_EXCEPTIONS)
-      cout << e.what() << endl;
-    else
-      cout << "Exception thrown from Allocate in TestExtendedHeaderBlocks."  << endl;
-  }
-  catch(...)
-  {
-    cout << "Unexpected exception thrown from Allocate in TestExtendedHeaderBlocks."  << endl;
-  }
-
-  DumpPages(oa, wrap);
-
-  ///////////////////////////////////////////////////////////////////////////////////////////////
-  ///////////////////////////////////////////////////////////////////////////////////////////////
-  Student *pStudent2 = 0;
-  try
-  {
-    pStudent2 = static_cast<Student *>( oa->Allocate() );
-  }
-  catch (const OAException& e)
-  {
-    if (SHOW_EXCEPTIONS)
-      cout << e.what() << endl;
-    else
-      cout << "Exception thrown from Allocate in TestExtendedHeaderBlocks."  << endl;
-  }
-  catch(...)
-  {
-    cout << "Unexpected exception thrown from Allocate in TestExtendedHeaderBlocks."  << endl;
-  }
-
-  DumpPages(oa, wrap);
-
-  ///////////////////////////////////////////////////////////////////////////////////////////////
-  ///////////////////////////////////////////////////////////////////////////////////////////////
-  try
-  {
-    oa->Free(pStudent1);
-  }
-  catch (const OAException& e)
-  {
-    if (SHOW_EXCEPTIONS) 
-      cout << e.what() << endl;
-    else
-      cout << "Exception thrown from Free in TestExtendedHeaderBlocks."  << endl;
-  }
-  catch(...)
-  {
-    cout << "Unexpected exception thrown from Free in TestExtendedHeaderBlocks."  << endl;
-  }
-
-  DumpPages(oa, wrap);
-
-  ///////////////////////////////////////////////////////////////////////////////////////////////
-  ///////////////////////////////////////////////////////////////////////////////////////////////
-  try
-  {
-    oa->Free(pStudent2);
-  }
-  catch (const OAException& e)
-  {
-    if (SHOW_EXCEPTIONS) 
-      cout << e.what() << endl;
-    else
-      cout << "Exception thrown from Free in TestExtendedHeaderBlocks."  << endl;
-  }
-  catch(...)
-  {
-    cout << "Unexpected exception thrown from Free in TestExtendedHeaderBlocks."  << endl;
-  }
-
-  DumpPages(oa, wrap);
-
-  ///////////////////////////////////////////////////////////////////////////////////////////////
-  ///////////////////////////////////////////////////////////////////////////////////////////////
-  try
-  {
-    pStudent1 = static_cast<Student *>( oa->Allocate() );
-    //pStudent2 = static_cast<Student *>( oa->Allocate() );
-  }
-  catch (const OAException& e)
-  {
-    if (SHOW_EXCEPTIONS)
-      cout << e.what() << endl;
-    else
-      cout << "Exception thrown from Allocate in TestExtendedHeaderBlocks."  << endl;
-  }
-  catch(...)
-  {
-    cout << "Unexpected exception thrown from Allocate in TestExtendedHeaderBlocks."  << endl;
-  }
-
-  DumpPages(oa, wrap);
-
-  ///////////////////////////////////////////////////////////////////////////////////////////////
-  ///////////////////////////////////////////////////////////////////////////////////////////////
-  try
-  {
-    for (int i = 0; i < 5; i++)
-    {
-      oa->Free(pStudent1);
-      pStudent1 = static_cast<Student *>( oa->Allocate() );
-    }
-  }
-  catch (const OAException& e)
-  {
-    if (SHOW_EXCEPTIONS)
-      cout << e.what() << endl;
-    else
-      cout << "Exception thrown from Allocate in TestExtendedHeaderBlocks."  << endl;
-  }
-  catch(...)
-  {
-    cout << "Unexpected exception thrown from Allocate in TestExtendedHeaderBlocks."  << endl;
-  }
-
-  DumpPages(oa, wrap);
-
-  ///////////////////////////////////////////////////////////////////////////////////////////////
-  ///////////////////////////////////////////////////////////////////////////////////////////////
-  try
-  {
-    pStudent2 = static_cast<Student *>( oa->Allocate() );
-  }
-  catch (const OAException& e)
-  {
-    if (SHOW_EXCEPTIONS)
-      cout << e.what() << endl;
-    else
-      cout << "Exception thrown from Allocate in TestExtendedHeaderBlocks."  << endl;
-  }
-  catch(...)
-  {
-    cout << "Unexpected exception thrown from Allocate in TestExtendedHeaderBlocks."  << endl;
-  }
-
-  DumpPages(oa, wrap);
-  delete oa;
-}
-
-//****************************************************************************************************
-//****************************************************************************************************
-void TestExternalHeaderBlocks()
-{
-  ObjectAllocator *oa = 0;
-  unsigned wrap = 32;
-
-  try 
-  {
-    bool newdel = false;
-    bool debug = true;
-    unsigned padbytes = 2;
-    OAConfig::HeaderBlockInfo header(OAConfig::hbExternal);
-    unsigned alignment = 0;
-
-    OAConfig config(newdel, 4, 1, debug, padbytes, header, alignment);
-    oa = new ObjectAllocator(sizeof(Student), config);
-  }
-  catch (const OAException& e)
-  {
-    if (SHOW_EXCEPTIONS)
-      cout << e.what() << endl;
-    else
-      cout << "Exception thrown during construction in TestExternalHeaderBlocks."  << endl;
-
-    return;
-  }
-
-  PrintConfig(oa);
-  PrintCounts(oa);
-  DumpPagesEx(oa, wrap);
-
-  Student *pStudent1 = 0;
-  try
-  {
-    pStudent1 = static_cast<Student *>( oa->Allocate("First student") );
-  }
-  catch (const OAException& e)
-  {
-    if (SHOW_EXCEPTIONS)
-      cout << e.what() << endl;
-    else
-      cout << "Exception thrown from Allocate in TestExternalHeaderBlocks."  << endl;
-  }
-  catch(...)
-  {
-    cout << "Unexpected exception thrown from Allocate in TestExternalHeaderBlocks."  << endl;
-  }
-
-  PrintCounts(oa);
-  DumpPagesEx(oa, wrap);
-
-  Student *pStudent2 = 0;
-  try
-  {
-    pStudent2 = static_cast<Student *>( oa->Allocate("Second student") );
-  }
-  catch (const OAException& e)
-  {
-    if (SHOW_EXCEPTIONS)
-      cout << e.what() << endl;
-    else
-      cout << "Exception thrown from Allocate in TestExternalHeaderBlocks."  << endl;
-  }
-  catch(...)
-  {
-    cout << "Unexpected exception thrown from Allocate in TestExternalHeaderBlocks."  << endl;
-  }
-
-  PrintCounts(oa);
-  DumpPagesEx(oa, wrap);
-
-  try
-  {
-    oa->Free(pStudent1);
-  }
-  catch (const OAException& e)
-  {
-    if (SHOW_EXCEPTIONS) 
-      cout << e.what() << endl;
-    else
-      cout << "Exception thrown from Free in TestExternalHeaderBlocks."  << endl;
-  }
-  catch(...)
-  {
-    cout << "Unexpected exception thrown from Free in TestExternalHeaderBlocks."  << endl;
-  }
-
-  PrintCounts(oa);
-  DumpPagesEx(oa, wrap);
-
-  try
-  {
-    oa->Free(pStudent2);
-  }
-  catch (const OAException& e)
-  {
-    if (SHOW_EXCEPTIONS) 
-      cout << e.what() << endl;
-    else
-      cout << "Exception thrown from Free in TestExternalHeaderBlocks."  << endl;
-  }
-  catch(...)
-  {
-    cout << "Unexpected exception thrown from Free in TestExternalHeaderBlocks."  << endl;
-  }
-
-  PrintCounts(oa);
-  DumpPagesEx(oa, wrap);
-
-  delete oa;
-}
-
-//****************************************************************************************************
-//****************************************************************************************************
-void DoStudents(unsigned padding, bool printall)
-{
-  try 
-  {
-    bool newdel = false;
-    bool debug = true;
-    unsigned padbytes = padding;
-    OAConfig::HeaderBlockInfo header(OAConfig::hbNone);
-    unsigned alignment = 0;
-
-    OAConfig config(newdel, 4, 2, debug, padbytes, header, alignment);
-    studentObjectMgr = new ObjectAllocator(sizeof(Student), config);
-  }
-  catch (const OAException& e)
-  {
-    if (SHOW_EXCEPTIONS)
-      cout << e.what() << endl;
-    else
-      cout << "Exception thrown during construction in DoStudents."  << endl;
-    return;
-  }
-  catch(...)
-  {
-    cout << "Unexpected exception thrown from constructor in DoStudents."  << endl;
-  }
-
-  unsigned wrap = 32;
-  PrintConfig(studentObjectMgr);
-  PrintCounts(studentObjectMgr);
-  DumpPages(studentObjectMgr, wrap);
-
-  Student *pStudent1 = 0, *pStudent2 = 0, *pStudent3 = 0;
-  try
-  {
-    pStudent1 = static_cast<Student *>( studentObjectMgr->Allocate() );
-    PrintCounts(studentObjectMgr);
-    if (printall)
-      DumpPages(studentObjectMgr, wrap);
-    pStudent2 = static_cast<Student *>( studentObjectMgr->Allocate() );
-    PrintCounts(studentObjectMgr);
-    if (printall)
-      DumpPages(studentObjectMgr, wrap);
-    pStudent3 = static_cast<Student *>( studentObjectMgr->Allocate() );
-    PrintCounts(studentObjectMgr);
-    if (printall)
-      DumpPages(studentObjectMgr, wrap);
-  }
-  catch (const OAException& e)
-  {
-    if (SHOW_EXCEPTIONS)
-      cout << e.what() << endl;
-    else
-      cout << "Exception thrown from Allocate in DoStudents."  << endl;
-  }
-  catch(...)
-  { 
-    cout << "Unexpected exception thrown from Allocate in DoStudents."  << endl;
-  }
-
-  Student *pStudent4[6];
-  for (int i = 0; i < 6; i++)
-  {
-    try
-    {
-      pStudent4[i] = static_cast<Student *>( studentObjectMgr->Allocate() );
-      if (pStudent4[i] == 0)
-        break;
-    }
-    catch (const OAException& e)
-    {
-    if (SHOW_EXCEPTIONS)
-      cout << e.what() << endl;
-    else
-    {
-      cout << "Exception thrown from Allocate (2) in DoStudents." << endl;
-
-      break;
-    }
-      
-    }
-    catch(...)
-    {
-      cout << "Unexpected exception thrown from Allocate (2) in DoStudents."  << endl;
-    }
-
-  }
-  PrintCounts(studentObjectMgr);
-  if (printall)
-    DumpPages(studentObjectMgr, wrap);
-
-  try
-  {
-    studentObjectMgr->Free(pStudent1);
-    PrintCounts(studentObjectMgr);
-    if (printall)
-      DumpPages(studentObjectMgr, wrap);
-    studentObjectMgr->Free(pStudent2);
-    PrintCounts(studentObjectMgr);
-    if (printall)
-      DumpPages(studentObjectMgr, wrap);
-    studentObjectMgr->Free(pStudent3);
-    PrintCounts(studentObjectMgr);
-    if (printall)
-      DumpPages(studentObjectMgr, wrap);
-  }
-  catch (const OAException& e)
-  {
-    if (SHOW_EXCEPTIONS)
-      cout << e.what() << endl;
-    else
-      cout << "Exception thrown from Free in DoStudents."  << endl;
-
-  }
-  catch(...)
-  {
-    cout << "Unexpected exception thrown from Free in DoStudents."  << endl;
-  }
-
-  cout << "Most students in use: " << studentObjectMgr->GetStats().MostObjects_ << endl;
-  delete studentObjectMgr;
-}
-
-//****************************************************************************************************
-//****************************************************************************************************
-void TestPadding(unsigned size)
-{
-  DoStudents(size);
-}
-
-//****************************************************************************************************
-//****************************************************************************************************
-void DoEmployees(void)
-{
-  try
-  {
-    bool newdel = false;
-    bool debug = true;
-    unsigned padbytes = 0;
-    OAConfig::HeaderBlockInfo header(OAConfig::hbNone);
-    unsigned alignment = 0;
-
-    OAConfig config(newdel, 4, 2, debug, padbytes, header, alignment);
-    employeeObjectMgr = new ObjectAllocator(sizeof(Employee), config);
-  }
-  catch (const OAException& e)
-  {
-    if (SHOW_EXCEPTIONS)
-      cout << e.what() << endl;
-    else
-      cout << "Exception thrown during construction in DoEmployees."  << endl;
-    return;
-  }
-  catch(...)
-  {
-    cout << "Unexpected exception thrown during constructor in DoEmployees."  << endl;
-  }
-
-  PrintConfig(employeeObjectMgr);
-  PrintCounts(employeeObjectMgr);
-
-  Employee *pEmployee1 = 0, *pEmployee2 = 0, *pEmployee3 = 0;
-  try
-  {
-    pEmployee1 = static_cast<Employee *>(employeeObjectMgr->Allocate());
-    PrintCounts(employeeObjectMgr);
-    pEmployee2 = static_cast<Employee *>(employeeObjectMgr->Allocate());
-    PrintCounts(employeeObjectMgr);
-    pEmployee3 = static_cast<Employee *>(employeeObjectMgr->Allocate());
-    PrintCounts(employeeObjectMgr);
-  }
-  catch (const OAException& e)
-  {
-    if (SHOW_EXCEPTIONS)
-      cout << e.what() << endl;
-    else
-      cout << "Exception thrown from Allocate in DoEmployees."  << endl;
-  }
-  catch(...)
-  {
-    cout << "Unexpected exception thrown from Allocate in DoEmployees."  << endl;
-  }
-
-  Employee *pEmployee4[7];
-  for (int i = 0; i < 7; i++)
-  {
-    try 
-    {
-        // Need to use /EHa, not /EHs
-        // ******************************************* Puts &employeeObjMgr in ecx
-      pEmployee4[i] = static_cast<Employee *>(employeeObjectMgr->Allocate());
-    }
-    catch (const OAException& e)
-    {
-      if (SHOW_EXCEPTIONS)
-      {
-          // ******************** Hoses the ecx register containing &employeeObjMgr
-        cout << e.what() << endl;
-      }
-      else
-        cout << "Exception thrown from Allocate (2) in DoEmployees."  << endl;
-
-      break;
-    }
-    catch(...)
-    {
-      cout << "Unexpected exception thrown from Allocate (2) in DoEmployees."  << endl;
-    }
-  }
-    // ************************* blindly pushes ecx as if it still has &empObjMgr
-  PrintCounts(employeeObjectMgr); 
-
-  try
-  {
-    employeeObjectMgr->Free(pEmployee1);
-    PrintCounts(employeeObjectMgr);
-    employeeObjectMgr->Free(pEmployee2);
-    PrintCounts(employeeObjectMgr);
-    employeeObjectMgr->Free(pEmployee3);
-    PrintCounts(employeeObjectMgr);
-  }
-  catch (const OAException& e)
-  {
-    if (SHOW_EXCEPTIONS)
-      cout << e.what() << endl;
-    else
-      cout << "Exception thrown from Free in DoEmployees."  << endl;
-  }
-  catch(...)
-  {
-    cout << "Unexpected exception thrown from Free in DoEmployees."  << endl;
-  }
-
-    // Free an object twice
-  try {
-    employeeObjectMgr->Free(pEmployee1);
-  }
-  catch (const OAException& e) 
-  {
-    if (SHOW_EXCEPTIONS)
-      cout << e.what() << endl;
-    else
-      cout << "Exception thrown from Free (Freeing object twice) in DoEmployees."  << endl;
-  }
-  catch(...)
-  {
-    cout << "Unexpected exception thrown from Free (Freeing object twice) in DoEmployees."  << endl;
-  }
-
-    // Free an invalid pointer (bad boundary condition)
-  try 
-  {
-    employeeObjectMgr->Free(reinterpret_cast<char *>(pEmployee4[0]) + 4);
-  }
-  catch (const OAException& e) 
-  {
-    if (SHOW_EXCEPTIONS)
-      cout << e.what() << endl;
-    else
-      cout << "Exception thrown from Free (Freeing address on bad boundary) in DoEmployees."  << endl;
-  }
-  catch(...)
-  {
-    cout << "Unexpected exception thrown from Free (Freeing address on bad boundary) in DoEmployees."  << endl;
-  }
-
-  cout << "Most employees in use: " << employeeObjectMgr->GetStats().MostObjects_<< endl;
-  delete employeeObjectMgr;
-}
-
-//****************************************************************************************************
-//****************************************************************************************************
-void DisableOA(void)
-{
-  try 
-  {
-    bool newdel = true;
-    bool debug = false;
-    unsigned padbytes = 0;
-    OAConfig::HeaderBlockInfo header(OAConfig::hbNone);
-    unsigned alignment = 0;
-
-    OAConfig config(newdel, 4, 2, debug, padbytes, header, alignment);
-    studentObjectMgr = new ObjectAllocator(sizeof(Student), config);
-  }
-  catch (const OAException& e)
-  {
-    if (SHOW_EXCEPTIONS)
-      cout << e.what() << endl;
-    else
-      cout << "Exception thrown during constructor in DisableOA."  << endl;
-    return;
-  }
-  catch(...)
-  {
-    cout << "Unexpected exception thrown during constructor in DisableOA."  << endl;
-  }
-
-  PrintConfig(studentObjectMgr);
-  PrintCounts2(studentObjectMgr);
-
-  Student *pStudent1 = 0, *pStudent2 = 0, *pStudent3 = 0;
-  try
-  {
-    pStudent1 = static_cast<Student *>( studentObjectMgr->Allocate() );
-    PrintCounts2(studentObjectMgr);
-    pStudent2 = static_cast<Student *>( studentObjectMgr->Allocate() );
-    PrintCounts2(studentObjectMgr);
-    pStudent3 = static_cast<Student *>( studentObjectMgr->Allocate() );
-    PrintCounts2(studentObjectMgr);
-  }
-  catch (const OAException& e)
-  {
-    if (SHOW_EXCEPTIONS)
-      cout << e.what() << endl;
-    else
-      cout << "Exception thrown from Allocate in DisableOA."  << endl;
-  }
-  catch(...)
-  {
-    cout << "Unexpected exception thrown from Allocate in DisableOA."  << endl;
-  }
-
-  Student *pStudent4[6];
-  for (int i = 0; i < 6; i++)
-  {
-    try
-    {
-      pStudent4[i] = static_cast<Student *>( studentObjectMgr->Allocate() );
-    }
-    catch (const OAException& e)
-    {
-      if (SHOW_EXCEPTIONS)
-        cout << e.what() << endl;
-      else
-        cout << "Exception thrown from Allocate (2) in DisableOA."  << endl;
-      break;
-    }
-    catch(...)
-    {
-      cout << "Unexpected exception thrown from Allocate (2) in DisableOA."  << endl;
-    }
-
-  }
-  PrintCounts2(studentObjectMgr);
-
-  try
-  {
-    studentObjectMgr->Free(pStudent1);
-    PrintCounts2(studentObjectMgr);
-    studentObjectMgr->Free(pStudent2);
-    PrintCounts2(studentObjectMgr);
-    studentObjectMgr->Free(pStudent3);
-    PrintCounts2(studentObjectMgr);
-  }
-  catch (const OAException& e)
-  {
-    if (SHOW_EXCEPTIONS)
-      cout << e.what() << endl;
-    else
-      cout << "Exception thrown from Free in DisableOA."  << endl;
-  }
-  catch(...)
-  {
-    cout << "Unexpected exception thrown from Free in DIsableOA."  << endl;
-  }
-
-  for (int i = 0; i < 6; i++)
-  {
-    try
-    {
-      studentObjectMgr->Free(pStudent4[i]);
-    }
-    catch (const OAException& e)
-    {
-      if (SHOW_EXCEPTIONS)
-        cout << e.what() << endl;
-      else
-        cout << "Exception thrown from Free in DisableOA."  << endl;
-      break;
-    }
-    catch(...)
-    {
-      cout << "Unexpected exception thrown from Free in DisableOA."  << endl;
-    }
-
-  }
-  PrintCounts2(studentObjectMgr);
-
-  cout << "Most students in use: " << studentObjectMgr->GetStats().MostObjects_ << endl;
-  delete studentObjectMgr;
-}
-
-//****************************************************************************************************
-//****************************************************************************************************
-void TestCorruption(void)
-{
-  ObjectAllocator *oa = 0;
-  unsigned char *p;
-  unsigned padbytes = 8;
-  unsigned i;
-  unsigned wrap = 32;
-  Student *pStudent1, *pStudent2 = 0;
-  try 
-  {
-    bool newdel = false;
-    bool debug = true;
-    //unsigned header = 0;
-    //OAConfig::HBLOCK_TYPE header = OAConfig::hbNone;
-    OAConfig::HeaderBlockInfo header(OAConfig::hbBasic);
-    unsigned alignment = 0;
-
-    OAConfig config(newdel, 4, 2, debug, padbytes, header, alignment);
-    //OAConfig config(false, 4, 2, true, padbytes);
-    oa = new ObjectAllocator(sizeof(Student), config);
-    pStudent1 = static_cast<Student *>( oa->Allocate() );
-    pStudent2 = static_cast<Student *>( oa->Allocate() );
-    
-    PrintConfig(oa);
-    PrintCounts(oa);
-    DumpPages(oa, wrap);
-  }
-  catch (const OAException& e)
-  {
-    if (SHOW_EXCEPTIONS)
-      cout << e.what() << endl;
-    else
-      cout << "Exception thrown during construction/allocation in TestCorruption."  << endl;
-
-    return;
-  }
-
-    // corrupt left pad bytes
-  p = const_cast<unsigned char*>(reinterpret_cast<const unsigned char *>(pStudent1)) - padbytes;
-  for (i = 0; i < padbytes - 2; i++)
-    *p++ = 0xFF;
-
-    // corrupt right pad bytes
-  p = const_cast<unsigned char*>(reinterpret_cast<const unsigned char *>(pStudent2)) + sizeof(Student);
-  for (i = 0; i < padbytes - 2; i++)
-    *p++ = 0xEE;
-
-  try
-  {
-    oa->Free(pStudent1);
-  }
-  catch (const OAException& e)
-  {
-    if (SHOW_EXCEPTIONS)
-      cout << e.what() << endl;
-    else
-    {
-      if (e.code() == e.E_CORRUPTED_BLOCK)
-        cout << "Exception thrown from Free: E_CORRUPTED_BLOCK on left"  << endl;
-      else
-        cout << "****** Unknown OAException thrown from Free in TestCorruption. ******"  << endl;
-    }
-  }
-  catch(...)
-  {
-    cout << "Unexpected exception thrown from Free in TestCorruption."  << endl;
-  }
-
-  try
-  {
-    oa->Free(pStudent2);
-  }
-  catch (const OAException& e)
-  {
-    if (SHOW_EXCEPTIONS)
-      cout << e.what() << endl;
-    else
-    {
-      if (e.code() == e.E_CORRUPTED_BLOCK)
-        cout << "Exception thrown from Free: E_CORRUPTED_BLOCK on right"  << endl;
-      else
-        cout << "****** Unknown OAException thrown from Free (2) in TestCorruption. ******"  << endl;
-    }
-  }
-  catch(...)
-  {
-    cout << "Unexpected exception thrown from Free (2) in TestCorruption."  << endl;
-  }
-
-  delete oa;
-}
-
-//****************************************************************************************************
-//****************************************************************************************************
-void TestLeak(void)
-{
-  unsigned count = 0;
-  Employee **pEmps = 0;
-
-  try
-  {
-    bool newdel = false;
-    bool debug = true;
-    unsigned padbytes = 0;
-    OAConfig::HeaderBlockInfo header(OAConfig::hbBasic);
-    unsigned alignment = 0;
-
-    OAConfig config(newdel, 4, 8, debug, padbytes, header, alignment);
-    employeeObjectMgr = new ObjectAllocator(sizeof(Employee), config);
-  }
-  catch (const OAException& e)
-  {
-    if (SHOW_EXCEPTIONS)
-      cout << e.what() << endl;
-    else
-      cout << "Exception thrown during constructor in TestLeak."  << endl;
-
-    return;
-  }
-  catch(...)
-  {
-    cout << "Unexpected exception thrown during constructor in TestLeak."  << endl;
-  }
-
-  PrintConfig(employeeObjectMgr);
-  PrintCounts(employeeObjectMgr);
-
-  count = employeeObjectMgr->GetConfig().MaxPages_ * employeeObjectMgr->GetConfig().ObjectsPerPage_;
-  pEmps = new Employee *[count];
-
-  for (unsigned i = 0; i < count; i++)
-  {
-    try 
-    {
-      pEmps[i] = static_cast<Employee *>(employeeObjectMgr->Allocate());
-      FillEmployee(*pEmps[i]);
-    }
-    catch (const OAException& e)
-    {
-      if (SHOW_EXCEPTIONS)
-        cout << e.what() << endl;
-      else
-        cout << "Exception thrown from Allocate in TestLeak."  << endl;
-
-      break;
-    }
-    catch(...)
-    {
-      cout << "Unexpected exception thrown from Allocate in TestLeak."  << endl;
-    }
-  }
-  PrintCounts(employeeObjectMgr); 
-
-  try
-  {
-    for (unsigned i = 0; i < count; i += 2)
-      employeeObjectMgr->Free(pEmps[i]);
-  }
-  catch (const OAException& e)
-  {
-    if (SHOW_EXCEPTIONS)
-      cout << e.what() << endl;
-    else
-      cout << "Exception thrown from Free in TestLeak."  << endl;
-  }
-  catch(...)
-  {
-    cout << "Unexpected exception thrown from Free in TestLeak."  << endl;
-  }
-
-  PrintCounts(employeeObjectMgr);
-
-  cout << "Most employees in use: " << employeeObjectMgr->GetStats().MostObjects_<< endl;
-
-  cout << "\nChecking for leaks...\n";
-  CheckAndDumpLeaks(employeeObjectMgr);
-
-  try
-  {
-    for (unsigned i = 1; i < count; i += 2)
-      employeeObjectMgr->Free(pEmps[i]);
-  }
-  catch (const OAException& e)
-  {
-    if (SHOW_EXCEPTIONS)
-      cout << e.what() << endl;
-    else
-      cout << "Exception thrown from Free (2) in TestLeak."  << endl;
-  }
-  catch(...)
-  {
-    cout << "Unexpected exception thrown from Free (2) in TestLeak."  << endl;
-  }
-
-  cout << "\nChecking for leaks...\n";
-  CheckAndDumpLeaks(employeeObjectMgr);
-
-  delete employeeObjectMgr;
-  delete [] pEmps;
-}
-
-
-//****************************************************************************************************
-//****************************************************************************************************
-void TestValidate(void)
-{
-  ObjectAllocator *oa = 0;
-  unsigned char *p;
-  unsigned i, padbytes = 8;
-  unsigned wrap = 32;
-  Student *pStudent1 = 0, *pStudent2 = 0, *pStudent7 = 0;
-  try 
-  {
-    bool newdel = false;
-    bool debug = true;
-    OAConfig::HeaderBlockInfo header(OAConfig::hbBasic);
-    unsigned alignment = 0;
-
-    OAConfig config(newdel, 4, 2, debug, padbytes, header, alignment);
-    oa = new ObjectAllocator(sizeof(Student), config);
-
-    pStudent1 = static_cast<Student *>( oa->Allocate() );
-    pStudent2 = static_cast<Student *>( oa->Allocate() );
-    oa->Allocate(); // 3
-    oa->Allocate(); // 4
-    oa->Allocate(); // 5
-    oa->Allocate(); // 6
-    pStudent7 = static_cast<Student *>( oa->Allocate() );
-    PrintConfig(oa);
-    PrintCounts(oa);
-    DumpPages(oa, wrap);
-  }
-  catch (const OAException& e)
-  {
-    if (SHOW_EXCEPTIONS)
-      cout << e.what() << endl;
-    else
-      cout << "Exception thrown during construction/allocation in TestValidate."  << endl;
-    return;
-  }
-
-  try
-  {
-      // Validate a good heap
-    unsigned count = oa->ValidatePages(ValidateCallback);
-    cout << "Number of corruptions: " << count << endl << endl;
-  }
-  catch (const OAException& e)
-  {
-    if (SHOW_EXCEPTIONS)
-      cout << e.what() << endl;
-    else
-    {
-      if (e.code() == e.E_CORRUPTED_BLOCK)
-        cout << "Exception thrown from Free: E_CORRUPTED_BLOCK on left"  << endl;
-      else
-        cout << "****** Unknown OAException thrown from Free in TestValidate. ******"  << endl;
-    }
-  }
-  catch(...)
-  {
-    cout << "Unexpected exception thrown from Free in TestValidate."  << endl;
-  }
-
-    // corrupt left pad bytes of 1
-  p = const_cast<unsigned char*>(reinterpret_cast<const unsigned char *>(pStudent1)) - padbytes;
-  for (i = 0; i < padbytes - 2; i++)
-    *p++ = 0xFF;
-
-    // corrupt right pad bytes of 2
-  p = const_cast<unsigned char*>(reinterpret_cast<const unsigned char *>(pStudent2)) + sizeof(Student);
-  for (i = 0; i < padbytes - 2; i++)
-    *p++ = 0xEE;
-
-  PrintCounts(oa);
-  DumpPages(oa, wrap);
-
-  try
-  {
-      // Validate a corrupted heap
-    unsigned count = oa->ValidatePages(ValidateCallback);
-    cout << "Number of corruptions: " << count << endl << endl;
-  }
-  catch (const OAException& e)
-  {
-    if (SHOW_EXCEPTIONS)
-      cout << e.what() << endl;
-    else
-    {
-      if (e.code() == e.E_CORRUPTED_BLOCK)
-        cout << "Exception thrown from Free: E_CORRUPTED_BLOCK on left"  << endl;
-      else
-        cout << "****** Unknown OAException thrown from Free (2) in TestValidate. ******"  << endl;
-    }
-  }
-  catch(...)
-  {
-    cout << "Unexpected exception thrown from Free (2) in TestValidate."  << endl;
-  }
-
-    // corrupt left pad bytes of 7
-  p = const_cast<unsigned char*>(reinterpret_cast<const unsigned char *>(pStudent7)) - padbytes;
-  for (i = 0; i < padbytes - 2; i++)
-    *p++ = 0xFF;
-
-    // corrupt right pad bytes of 7
-  p = const_cast<unsigned char*>(reinterpret_cast<const unsigned char *>(pStudent7)) + sizeof(Student);
-  for (i = 0; i < padbytes - 2; i++)
-    *p++ = 0xEE;
-
-  PrintCounts(oa);
-  DumpPages(oa, wrap);
-
-  try
-  {
-      // Validate a corrupted heap
-    unsigned count = oa->ValidatePages(ValidateCallback);
-    cout << "Number of corruptions: " << count << endl << endl;
-  }
-  catch (const OAException& e)
-  {
-    if (SHOW_EXCEPTIONS)
-      cout << e.what() << endl;
-    else
-    {
-      if (e.code() == e.E_CORRUPTED_BLOCK)
-        cout << "Exception thrown from Free: E_CORRUPTED_BLOCK on left"  << endl;
-      else
-        cout << "****** Unknown OAException thrown from Free (3) in TestValidate. ******"  << endl;
-    }
-  }
-  catch(...)
-  {
-    cout << "Unexpected exception thrown from Free (3) in TestValidate."  << endl;
-  }
-  if (oa)
-    delete oa;
-}
-
-//****************************************************************************************************
-//****************************************************************************************************
-void TestAlignment(void)
-{
-  if (!ObjectAllocator::ImplementedExtraCredit())
-    return;
-
-  ObjectAllocator *oa = 0;
-  try 
-  {
-    unsigned wrap = 32;
-
-    bool newdel = false;
-    bool debug = true;
-    unsigned padbytes = 2;
-    //unsigned header = 0;
-    OAConfig::HeaderBlockInfo header(OAConfig::hbBasic);
-    unsigned alignment = 8;
-
-    OAConfig config(newdel, 3, 2, debug, padbytes, header, alignment);
-
-    if (!oa)
-      oa = new ObjectAllocator(sizeof(Student), config);
-
-    PrintConfig(oa);
-    PrintCounts(oa);
-    DumpPages(oa, wrap);
-
-    oa->Allocate(); // 1
-    oa->Allocate(); // 2
-    oa->Allocate(); // 3
-    oa->Allocate(); // 4
-    oa->Allocate(); // 5
-    oa->Allocate(); // 6
-
-    PrintCounts(oa);
-    DumpPages(oa, wrap);
-  }
-  catch (const OAException& e)
-  {
-    if (SHOW_EXCEPTIONS)
-      cout << e.what() << endl;
-    else
-      cout << "Exception thrown during construction/allocation in TestAlignment."  << endl;
-    return;
-  }
-  if (oa)
-    delete oa;
-}
-
-
-void PrintCounts(const ObjectAllocator *nm)
-{
-  OAStats stats = nm->GetStats();
-  cout << "Pages in use: " << stats.PagesInUse_;
-  cout << ", Objects in use: " << stats.ObjectsInUse_;
-  cout << ", Available objects: " << stats.FreeObjects_;
-  cout << ", Allocs: " << stats.Allocations_;
-  cout << ", Frees: " << stats.Deallocations_ << endl;
-}
-
-void PrintCounts2(const ObjectAllocator *nm)
-{
-  OAStats stats = nm->GetStats();
-  cout << "Allocs: " << stats.Allocations_;
-  cout << ", Frees: " << stats.Deallocations_ << endl;
-}
-
-void PrintConfig(const ObjectAllocator *oa)
-{
-  cout << "Object size = " << oa->GetStats().ObjectSize_;
-  cout << ", Page size = " << oa->GetStats().PageSize_;
-  cout << ", Pad bytes = " << oa->GetConfig().PadBytes_;
-  cout << ", ObjectsPerPage = " << oa->GetConfig().ObjectsPerPage_;
-  cout << ", MaxPages = " << oa->GetConfig().MaxPages_;
-  cout << ", MaxObjects = " <<  oa->GetConfig().ObjectsPerPage_ * oa->GetConfig().MaxPages_;
-  cout << endl;
-  cout << "Alignment = " << oa->GetConfig().Alignment_;
-  cout << ", LeftAlign = " << oa->GetConfig().LeftAlignSize_;
-  cout << ", InterAlign = " << oa->GetConfig().InterAlignSize_;
-  cout << ", HeaderBlocks = ";
-  if (oa->GetConfig().HBlockInfo_.type_ == OAConfig::hbNone)
-    cout << "None";
-  else if (oa->GetConfig().HBlockInfo_.type_ == OAConfig::hbBasic)
-    cout << "Basic";
-  else if (oa->GetConfig().HBlockInfo_.type_ == OAConfig::hbExtended)
-    cout << "Extended";
-  else if (oa->GetConfig().HBlockInfo_.type_ == OAConfig::hbExternal)
-    cout << "External";
-  cout << ", Header size = " << oa->GetConfig().HBlockInfo_.size_;
-  cout << endl;
-}
-
-void DumpPages(const ObjectAllocator *nm, unsigned width)
-{
-  const unsigned char *pages = static_cast<const unsigned char *>(nm->GetPageList());
-  const unsigned char *realpage = pages;
-  
-  size_t header_size = nm->GetConfig().HBlockInfo_.size_;
-
-  while (pages)
-  {
-    unsigned count = 0;
-
-    if (SHOWREAL)
-      printf("%p\n", pages);
-    else
-      printf("XXXXXXXX\n");
-
-          // print column header
-    for (unsigned j = 0; j < width; j++)
-      printf(" %2i", j);
-    printf("\n");
-
-      // "Next page" pointer in the page
-    if (SHOWREAL)
-    {
-      for (unsigned i = 0; i < sizeof(void *); i++, count++)
-        printf(" %02X", *pages++);
-    }
-    else
-    {
-      for (unsigned j = 0; j < sizeof(void *); pages++, count++, j++)
-        printf(" %s", "XX");
-    }
-
-
-      // Left leading alignment bytes
-    if (nm->GetConfig().Alignment_ > 1)
-    {
-        // leading alignment block (if any)
-      for (unsigned j = 0; j < nm->GetConfig().LeftAlignSize_; count++, j++)
-      {
-        if (count >= width)
-        {
-          printf("\n");
-          count = 0;
-        }
-        printf(" %02X", *pages++);
-      }
-    }
-
-      // Dump each object and its associated info
-    for (unsigned int i = 0; i < nm->GetConfig().ObjectsPerPage_ ; i++)
-    {
-        // inter-block alignment (not on first block)
-      if (i > 0)
-      {
-        for (unsigned j = 0; j < nm->GetConfig().InterAlignSize_; count++, j++)
-        {
-          if (count >= width)
-          {
-            printf("\n");
-            count = 0;
-          }
-          printf(" %02X", *pages++);
-        }
-      }
-
-        // header block bytes
-      for (unsigned j = 0; j < header_size; count++, j++)
-      {
-        if (count >= width)
-        {
-          printf("\n");
-          count = 0;
-        }
-        printf(" %02X", *pages++);
-      }
-
-        // left padding
-      for (unsigned j = 0; j < nm->GetConfig().PadBytes_; count++, j++)
-      {
-        if (count >= width)
-        {
-          printf("\n");
-          count = 0;
-        }
-        printf(" %02X", *pages++);
-      }
-
-        // possible next pointer (zero it out)
-      for (unsigned j = 0; j < sizeof(void *); count++, pages++, j++)
-      {
-        if (count >= width)
-        {
-          printf("\n");
-          count = 0;
-        }
-        if (SHOWREAL)
-          printf(" %02X", *pages);
-        else
-          printf(" %s", "XX");
-      }
-        
-        // remaining bytes
-      for (unsigned j = 0; j < nm->GetStats().ObjectSize_ - sizeof(void *); count++, j++)
-      {
-        if (count >= width)
-        {
-          printf("\n");
-          count = 0;
-        }
-        printf(" %02X", *pages++);
-      }
-
-        // right pad bytes
-      for (unsigned j = 0; j < nm->GetConfig().PadBytes_; count++, j++)
-      {
-        if (count >= width)
-        {
-          printf("\n");
-          count = 0;
-        }
-        printf(" %02X", *pages++);
-      }
-
-    }
-    printf("\n\n");
-
-    pages = reinterpret_cast<const unsigned char *>((reinterpret_cast<const GenericObject *>(realpage))->Next);
-    realpage = pages;
-  }
-}
-
-void DumpExternalHeaders(const ObjectAllocator *oa, const unsigned char *p)
-{
-  unsigned char *page = const_cast<unsigned char *>(p);
-
-  unsigned padbytes = oa->GetConfig().PadBytes_;  
-  size_t header_size = oa->GetConfig().HBlockInfo_.size_;
-  unsigned leftalign = oa->GetConfig().LeftAlignSize_;
-  unsigned interalign = oa->GetConfig().InterAlignSize_;
-  unsigned count = oa->GetConfig().ObjectsPerPage_;
-  size_t offset = padbytes * 2 + header_size + interalign + oa->GetStats().ObjectSize_;
-
-  page += sizeof(void *); // the 'next' pointer
-  page += leftalign;      // the left alignment bytes (if any)
-
-    // We're now pointing at the beginning of the header block
-
-  MemBlockInfo *pm = reinterpret_cast<MemBlockInfo *>(*reinterpret_cast<MemBlockInfo **>(page));
-  cout << "  Label: " << (pm && pm->label ? pm->label : "") << std::endl;
-  cout << " In use: " << (pm ? pm->in_use : 0) << std::endl;
-  cout << "Alloc #: " << (pm && pm->in_use ? pm->alloc_num : 0) << std::endl;
-
-  for (unsigned i = 1; i < count; i++)
-  {
-    page += offset;
-    MemBlockInfo *pm = reinterpret_cast<MemBlockInfo *>(*reinterpret_cast<MemBlockInfo **>(page));
-    cout << "  Label: " << (pm && pm->label ? pm->label : "") << std::endl;
-    cout << " In use: " << (pm ? pm->in_use : 0) << std::endl;
-    cout << "Alloc #: " << (pm && pm->in_use ? pm->alloc_num : 0) << std::endl;
-  }
-}
-
-void DumpPagesEx(const ObjectAllocator *nm, unsigned width)
-{
-  const unsigned char *pages = static_cast<const unsigned char *>(nm->GetPageList());
-  const unsigned char *realpage = pages;
-  
-  size_t header_size = nm->GetConfig().HBlockInfo_.size_;
-
-  while (pages)
-  {
-    unsigned count = 0;
-
-    if (SHOWREAL)
-      printf("%p\n", pages);
-    else
-      printf("XXXXXXXX\n");
-
-          // print column header
-    for (unsigned j = 0; j < width; j++)
-      printf(" %2i", j);
-    printf("\n");
-
-    if (SHOWREAL)
-    {
-      for (unsigned i = 0; i < sizeof(void *); i++, count++)
-        printf(" %02X", *pages++);
-    }
-    else
-    {
-      for (unsigned j = 0; j < sizeof(void *); pages++, count++, j++)
-        printf(" %s", "XX");
-    }
-
-
-      // Left leading alignment bytes
-    if (nm->GetConfig().Alignment_ > 1)
-    {
-        // leading alignment block (if any)
-      for (unsigned j = 0; j < nm->GetConfig().LeftAlignSize_; count++, j++)
-      {
-        if (count >= width)
-        {
-          printf("\n");
-          count = 0;
-        }
-        printf(" %02X", *pages++);
-      }
-    }
-
-    for (unsigned int i = 0; i < nm->GetConfig().ObjectsPerPage_ ; i++)
-    {
-        // inter-block alignment (not on first block)
-      if (i > 0)
-      {
-        for (unsigned j = 0; j < nm->GetConfig().InterAlignSize_; count++, j++)
-        {
-          if (count >= width)
-          {
-            printf("\n");
-            count = 0;
-          }
-          printf(" %02X", *pages++);
-        }
-      }
-
-        // header block bytes
-      for (unsigned j = 0; j < header_size; count++, j++, pages++)
-      {
-        if (count >= width)
-        {
-          printf("\n");
-          count = 0;
-        }
-        /*////////////////////======================================================================
-        In external mode, pointer address is embedded into the header memory
-        /////////////////////=======================================================================*/
-        if (SHOWREAL)
-          printf(" %02X", *pages);
-        else
-          printf(" %s", "XX");
-      }
-
-        // left padding
-      for (unsigned j = 0; j < nm->GetConfig().PadBytes_; count++, j++)
-      {
-        if (count >= width)
-        {
-          printf("\n");
-          count = 0;
-        }
-        printf(" %02X", *pages++);
-      }
-
-        // possible next pointer (zero it out)
-      for (unsigned j = 0; j < sizeof(void *); count++, pages++, j++)
-      {
-        if (count >= width)
-        {
-          printf("\n");
-          count = 0;
-        }
-        if (SHOWREAL)
-          printf(" %02X", *pages);
-        else
-          printf(" %s", "XX");
-      }
-        
-        // remaining bytes
-      for (unsigned j = 0; j < nm->GetStats().ObjectSize_ - sizeof(void *); count++, j++)
-      {
-        if (count >= width)
-        {
-          printf("\n");
-          count = 0;
-        }
-        printf(" %02X", *pages++);
-      }
-
-        // right pad bytes
-      for (unsigned j = 0; j < nm->GetConfig().PadBytes_; count++, j++)
-      {
-        if (count >= width)
-        {
-          printf("\n");
-
-
-
-          count = 0;
-        }
-        printf(" %02X", *pages++);
-      }
-
-    }
-    printf("\n");
-    DumpExternalHeaders(nm, realpage);
-    printf("\n");
-
-    pages = reinterpret_cast<const unsigned char *>((reinterpret_cast<const GenericObject *>(realpage))->Next);
-    realpage = pages;
-  }
-}
-
-void Test1(void)
-{
-  ObjectAllocator *oa;
-    
-    bool newdel = false;
-    bool debug = false;
-    unsigned padbytes = 0;
-    OAConfig::HeaderBlockInfo header(OAConfig::hbExternal);
-    unsigned alignment = 0;
-
-    OAConfig config(newdel, 1, 1, debug, padbytes, header, alignment);
-    oa  = new ObjectAllocator(sizeof(Student), config);
-
-    oa->Allocate();
-
-    PrintConfig(oa);
-    PrintCounts(oa);
-    DumpPagesEx(oa, 32);
-
-    delete oa;
-}
-
-
-int main(int argc, char **argv)
-{
-#ifdef _MSC_VER
-    _CrtSetDbgFlag ( _CRTDBG_ALLOC_MEM_DF | _CRTDBG_LEAK_CHECK_DF );
-    _CrtSetReportMode(_CRT_WARN, _CRTDBG_MODE_FILE);
-    _CrtSetReportFile(_CRT_WARN, _CRTDBG_FILE_STDERR);
-#endif
-
-  int test = 0;
-
-  if (argc > 1)
-    test = std::atoi(argv[1]);
-  if (argc > 2)
-    SHOWADDRESS1 = std::atoi(argv[2]);
-  if (argc > 3)
-    SHOWADDRESS2 = std::atoi(argv[3]);
-  if (argc > 4)
-    SHOWREAL = std::atoi(argv[4]);
-  if (argc > 5)
-    SHOW_EXCEPTIONS = std::atoi(argv[5]);
-  if (argc > 6)
-    EXTRA_CREDIT = std::atoi(argv[6]);
-
-  switch (test)
-  {
-    case 1:
-      cout << "============================== Students..." << endl;
-      DoStudents(0, false);
-      cout << endl;
-      break;
-    case 2:
-      cout << "============================== Students..." << endl;
-      DoStudents(0, true);
-      cout << endl;
-      break;
-    case 3:
-      cout << "============================== Employees..." << endl;
-      DoEmployees();
-      cout << endl;
-      break;
-    case 4:
-      cout << "============================== Test padding..." << endl;
-      TestPadding(6);
-      cout << endl;
-      break;
-    case 5:
-      cout << "============================== Test padding..." << endl;
-      TestPadding(10);
-      cout << endl;
-      break;
-    case 6:
-      cout << "============================== Test basic header blocks..." << endl;
-      TestBasicHeaderBlocks();
-      cout << endl;
-      break;
-    case 7:
-      cout << "============================== Test extended header blocks(1)..." << endl;
-      TestExtendedHeaderBlocks(1);
-      cout << endl;
-      break;
-    case 8:
-      cout << "============================== Test external header blocks..." << endl;
-      TestExternalHeaderBlocks();
-      cout << endl;
-      break;
-    case 9:
-      cout << "============================== Test corruption..." << endl;
-      TestCorruption();
-      cout << endl;
-      break;
-    case 10:
-      cout << "============================== Test using new/delete..." << endl;
-      DisableOA();
-      cout << endl;
-      break;
-    case 11:
-      cout << "============================== Test leak..." << endl;
-      TestLeak(); 
-      cout << endl;
-      break;
-    case 12:
-      cout << "============================== Test validate..." << endl;
-      TestValidate();
-      cout << endl;
-      break;
-    case 13:
-      cout << "============================== Test free checking basic (stress)..." << endl;
-      StressFreeChecking(OAConfig::HeaderBlockInfo(OAConfig::hbBasic));
-      cout << endl;
-      break;
-    case 14:
-      cout<< "============================== Test free checking extended (stress)..." << endl;
-      StressFreeChecking(OAConfig::HeaderBlockInfo(OAConfig::hbExtended, 1));
-      cout << endl;
-      break;
-    case 15:
-      cout << "============================== Test free checking external (stress)..." << endl;
-      StressFreeChecking(OAConfig::HeaderBlockInfo(OAConfig::hbExternal));
-      cout << endl;
-      break;
-    case 16:
-      cout << "============================== Test stress using new/delete..." << endl;
-      Stress(true);
-      cout << endl;
-      break;
-    case 17:
-      cout << "============================== Test stress using allocator..." << endl;
-      Stress(false);
-      cout << endl;
-      break;
-    case 18:
-      cout << "============================== Test alignment..." << endl;
-      TestAlignment();
-      cout << endl;
-      break;
-    case 19:
-      cout << "============================== Test free empty pages 1..." << endl;
-      TestFreeEmptyPages1(); 
-      cout << endl;
-      break;
-    case 20:
-      cout << "============================== Test free empty pages 2..." << endl;
-      TestFreeEmptyPages2(); 
-      cout << endl;
-      break;
-    case 21:
-      cout << "============================== Test free empty pages 3..." << endl;
-      TestFreeEmptyPages4(); 
-      cout << endl;
-      break;
-    default:
-      cout << "============================== Students..." << endl;
-      DoStudents(0, false);
-      cout << endl;
-      cout << "============================== Students..." << endl;
-      DoStudents(0, true);
-      cout << endl;
-      cout << "============================== Employees..." << endl;
-      DoEmployees();
-      cout << endl;
-      cout << "============================== Test padding..." << endl;
-      TestPadding(6);
-      cout << endl;
-      cout << "============================== Test padding..." << endl;
-      TestPadding(10);
-      cout << endl;
-      cout << "============================== Test basic header blocks..." << endl;
-      TestBasicHeaderBlocks();
-      cout << endl;
-      cout << "============================== Test extended header blocks(1)..." << endl;
-      TestExtendedHeaderBlocks(1);
-      cout << endl;
-      cout << "============================== Test external header blocks..." << endl;
-      TestExternalHeaderBlocks();
-      cout << endl;
-      cout << "============================== Test corruption..." << endl;
-      TestCorruption();
-      cout << endl;
-      cout << "============================== Test using new/delete..." << endl;
-      DisableOA();
-      cout << endl;
-      cout << "============================== Test leak..." << endl;
-      TestLeak(); 
-      cout << endl;
-      cout << "============================== Test validate..." << endl;
-      TestValidate();
-      cout << endl;
-      cout << "============================== Test free checking basic (stress)..." << endl;
-      StressFreeChecking(OAConfig::HeaderBlockInfo(OAConfig::hbBasic));
-      cout << endl;
-      cout<< "============================== Test free checking extended (stress)..." << endl;
-      StressFreeChecking(OAConfig::HeaderBlockInfo(OAConfig::hbExtended, 1));
-      cout << endl;
-      cout << "============================== Test free checking external (stress)..." << endl;
-      StressFreeChecking(OAConfig::HeaderBlockInfo(OAConfig::hbExternal));
-      cout << endl;
-      cout << "============================== Test stress using new/delete..." << endl;
-      Stress(true);
-      cout << endl;
-      cout << "============================== Test stress using allocator..." << endl;
-      Stress(false);
-      cout << endl;
-      if (EXTRA_CREDIT)
-      {
-        cout << "============================== Test alignment..." << endl;
-        TestAlignment();
-        cout << endl;
-        cout << "============================== Test free empty pages 1..." << endl;
-        TestFreeEmptyPages1(); 
-        cout << endl;
-        cout << "============================== Test free empty pages 2..." << endl;
-        TestFreeEmptyPages2(); 
-        cout << endl;
-        cout << "============================== Test free empty pages 3..." << endl;
-        TestFreeEmptyPages3(); 
-        cout << endl;
-      }
-      break;
-  }
-
-  //OAConfig config(false, 16, 4, false);
-  //ObjectAllocator a(sizeof(Student), config);
-  //ObjectAllocator b(sizeof(Student), config);
-    // These should fail to compile:
-  //ObjectAllocator c(a);
-  //a = b;
-  
-
-  return 0;
-}
+#include <iostream> 
+#include <cstdio>
+#include <cstring>
+#include <cstdlib>
+
+using std::cout;
+using std::endl;
+using std::printf;
+
+int SHOWADDRESS1 = 0;    // DumpCallback
+int SHOWADDRESS2 = 0;    // ValidateCallback
+int SHOWREAL = 0;        // DumpPages, DumpPagesEx
+int SHOW_EXCEPTIONS = 0; // Show student exceptions in all tests
+int EXTRA_CREDIT = 0;    // Run extra credit tests (Alignment, FreeEmptyPages)
+
+#include "ObjectAllocator.h"
+#include "ThreadCachedAllocator.h"
+#include "SizeClassAllocator.h"
+#include "ObjectPool.h"
+#include "PageSource.h"
+#include "PadKernels.h"
+#include "NumaAllocator.h"
+#include "PoolAllocator.h"
+#include "CompactAllocator.h"
+#include "OATrace.h"
+#include "PRNG.h"
+#include <thread>
+#include <list>
+#include <map>
+#include <unordered_map>
+#include <utility>
+
+struct Student
+{
+  int Age;       
+  float GPA;
+  long long Year;
+  long long ID;  
+};
+
+struct Employee
+{
+  Employee *Next;
+  char lastName[12];
+  char firstName[12];
+  float salary;
+  int years;
+};
+
+
+ObjectAllocator *studentObjectMgr;
+ObjectAllocator *employeeObjectMgr;
+
+// Support functions
+void PrintCounts(const ObjectAllocator *nm);
+void PrintCounts2(const ObjectAllocator *nm);
+void PrintConfig(const ObjectAllocator *nm);
+void DumpPages(const ObjectAllocator *nm, unsigned width = 16);
+void DumpPagesEx(const ObjectAllocator *nm, unsigned width = 16);
+
+void DoStudents(unsigned padding = 0, bool printall = false);
+void DoEmployees(void);               
+void TestPadding(unsigned size);      
+void TestBasicHeaderBlocks();         
+void TestCorruption(void);            
+void DisableOA(void);                 
+void TestLeak(void);                  
+void TestValidate(void);              
+void TestAlignment(void);             
+void TestFreeEmptyPages1(void);       
+void TestFreeEmptyPages2(void);       
+void TestFreeEmptyPages3(void);       
+void TestThreadCache(void);           
+void TestLockFree(void);              
+void TestBatches(void);               
+void TestSizeClasses(void);           
+void TestObjectPool(void);            
+void TestPageSources(void);           
+void TestGrowthPolicy(void);          
+void TestExternalRecords(void);       
+void TestLazyPages(void);             
+void TestInstrumentation(void);       
+void TestOccupancy(void);             
+void TestParallelSweeps(void);        
+void TestIncrementalValidation(void); 
+void TestSampledGuards(void);         
+void TestPadKernels(void);            
+void TestPageAffinity(void);          
+void TestBitmapBlocks(void);          
+void TestReleaseAll(void);            
+void TestReserve(void);               
+void TestNumaPools(void);             
+void TestDeferredFrees(void);         
+void TestMoveAndPoolAllocator(void);  
+void TestCompactAllocator(void);      
+void TestTraceRecording(void);        
+void StressFreeChecking(void);        
+void Stress(bool UseNewDelete);       
+
+struct Person
+{
+  char lastName[12];   
+  char firstName[12];  
+  float salary;        
+  int years;           
+};
+
+struct Person PEOPLE[] = {
+  {"Faith", "Ian", 80000, 10},
+  {"Tufnel", "Nigel", 90000, 12},
+  {"Savage", "Viv", 50000, 4},
+  {"Shrimpton", "Mick", 50000, 4},
+  {"Besser", "Joe", 40000, 1},
+  {"Smalls", "Derek", 80000, 10},
+  {"St.Hubbins", "David", 90000, 12},
+  {"Fleckman", "Bobbi", 120000, 8},
+  {"Eton-Hogg", "Denis", 250000, 22},
+  {"Upham", "Denny", 60000, 5},
+  {"McLochness", "Ross", 60000, 5},
+  {"Pudding", "Ronnie", 50000, 2},
+  {"Schindler", "Danny", 60000, 3},
+  {"Pettibone", "Jeanine", 85000, 3},
+  {"Fame", "Duke", 95000, 8},
+  {"Fufkin", "Artie", 45000, 1},
+  {"DiBergi", "Marty", 15000, 7},
+  {"Floyd", "Pink", 25000, 6},
+  {"Zeppelin", "Led", 35000, 3},
+  {"Mason", "Nick", 15000, 7},
+  {"Wright", "Richard", 17000, 9},
+  {"Waters", "Roger", 10000, 3},
+  {"Gilmore", "David", 19000, 5}
+};
+
+void FillEmployee(Employee& emp)
+{
+  static unsigned int index = 0;
+
+  strcpy(emp.firstName, PEOPLE[index].firstName);
+  strcpy(emp.lastName, PEOPLE[index].lastName);
+  emp.salary = PEOPLE[index].salary;
+  emp.years = PEOPLE[index].years;
+  index++;
+  if (index >= sizeof(PEOPLE) / sizeof(*PEOPLE))
+    index = 0;
+}
+
+void DumpCallback(const void *block, size_t actual_size)
+{
+  size_t size = actual_size;
+    // limit to 16 bytes
+  if (actual_size > 16)
+    size = 16;
+
+  unsigned char *data = const_cast<unsigned char*>(static_cast<const unsigned char *>(block));
+
+  if (SHOWADDRESS1)
+    printf("Block at 0x%p, %u bytes long.\n", block, static_cast<unsigned>(actual_size));
+  else
+    printf("Block at 0x00000000, %u bytes long.\n", static_cast<unsigned>(actual_size));
+
+    // If we were passed a NULL pointer, do nothing
+  if (!block)
+    return;
+
+  printf(" Data: <");
+  for (unsigned int i = 0; i < size; i++)
+  {
+    unsigned char c = *data++;
+    if (c > 31 && c < 128) // printable range
+      printf("%c", c);
+    else
+      printf(" ");
+  }
+  printf(">");
+
+  data = const_cast<unsigned char*>(static_cast<const unsigned char *>(block));
+  for (unsigned int i = 0; i < size; i++)
+    printf(" %02X", static_cast<int>(*data++));
+  printf("\n");
+}
+
+void DumpCallback2(const void *, size_t)
+{
+}
+
+void CheckAndDumpLeaks(const ObjectAllocator* oa)
+{
+  if (oa->GetStats().ObjectsInUse_)
+  {
+    printf("Detected memory leaks!\n");
+    printf("Dumping objects ->\n");
+    unsigned leaks = oa->DumpMemoryInUse(DumpCallback);
+    printf("Object dump complete. [%u]\n", leaks);
+  }
+  else
+    printf("No leaks detected.\n");
+}
+
+void ValidateCallback(const void *block, size_t actual_size)
+{
+  if (SHOWADDRESS2)
+    printf("Block at 0x%p, %u bytes long.\n", block, static_cast<unsigned>(actual_size));
+  else
+    printf("Block at 0x00000000, %u bytes long.\n", static_cast<unsigned>(actual_size));
+
+  if (!block)
+    return;
+}
+
+//****************************************************************************************************
+//****************************************************************************************************
+int RandomInt(int low, int high)
+{
+  //return std::rand() % (high - low + 1) + low;
+  return Digipen::Utils::Random(low, high);
+}
+
+template <typename T>
+void SwapT(T &a, T &b)
+{
+  T temp = a;
+  a = b;
+  b = temp;
+}
+
+template <typename T>
+void Shuffle(T *array, unsigned count)
+{
+  for (unsigned int i = 0; i < count; i++)
+  {
+    int r = RandomInt(static_cast<int>(i), static_cast<int>(count) - 1);
+    SwapT(array[i], array[r]);
+  }
+}
+
+template <typename T>
+void PrintArray(T *array, unsigned count)
+{
+  for (unsigned i = 0; i < count; i++)
+    std::cout << array[i] << std::endl;
+}
+
+const unsigned objects = 4096;
+const unsigned pages = 100;
+const unsigned total = objects * pages;
+void *ptrs[total];
+
+#include <ctime>
+void Stress(bool UseNewDelete)
+{
+  ObjectAllocator *oa;
+    
+  try
+  {
+    bool newdel = UseNewDelete;
+    bool debug = false;
+    unsigned padbytes = 0;
+    OAConfig::HeaderBlockInfo header(OAConfig::hbNone);
+    unsigned alignment = 0;
+
+    OAConfig config(newdel, objects, pages, debug, padbytes, header, alignment);
+    oa  = new ObjectAllocator(sizeof(Student), config);
+    for (unsigned i = 0; i < total; i++)
+    {
+      void *p = oa->Allocate();
+      ptrs[i] = p;
+    }
+
+    Shuffle(ptrs, total);
+    for (unsigned i = 0; i < total; i++)
+    {
+      oa->Free(ptrs[i]);
+    }
+
+    delete oa;
+  }
+  catch (const OAException& e)
+  {
+    if (SHOW_EXCEPTIONS)
+      cout << e.what() << endl;
+    else
+      cout << "Exception thrown during construction in Stress."  << endl;
+
+    return;
+  }
+}
+
+void StressFreeChecking(const OAConfig::HeaderBlockInfo& header)
+{
+  unsigned objects;
+  unsigned pages;
+
+  objects = 1000;
+  pages = 10;
+
+  const unsigned total = objects * pages;
+
+  ObjectAllocator *oa;
+    
+  char **ptrs = new char*[total];
+  
+  try
+  { 
+    bool newdel = false;
+    bool debug = true;
+    unsigned padbytes = 0;
+    unsigned alignment = 0;
+
+    OAConfig config(newdel, objects, pages, debug, padbytes, header, alignment);
+    oa  = new ObjectAllocator(sizeof(Student), config);
+
+    for (unsigned int i = 0; i < total; i++)
+    {
+      void *p = oa->Allocate();
+      ptrs[i] = static_cast<char *>(p);
+    }
+
+    PrintConfig(oa);
+    PrintCounts(oa);
+    //DumpPagesEx(oa, 42);
+
+    Shuffle(ptrs, total);
+    for (unsigned int i = 0; i < total; i++)
+    {
+      oa->Free(ptrs[i]);
+    }
+
+    oa->DumpMemoryInUse(DumpCallback2);
+    delete oa;
+  }
+  catch (const OAException& e)
+  {
+    if (SHOW_EXCEPTIONS)
+      cout << e.what() << endl;
+    else
+    {
+      cout << "Exception thrown during StressFreeChecking."  << endl;
+      fflush(stdout);
+    }
+
+    return;
+  }
+  delete [] ptrs;
+}
+
+void TestFreeEmptyPages1(void)
+{
+  if (!ObjectAllocator::ImplementedExtraCredit())
+    return;
+
+  ObjectAllocator *oa;
+  const int objects = 4;
+  const int pages = 3;
+  const int total = objects * pages;
+  void *ptrs[total];
+  try
+  {
+    bool newdel = false;
+    bool debug = true;
+    unsigned padbytes = 2;
+    OAConfig::HeaderBlockInfo header(OAConfig::hbNone);
+    unsigned alignment = 0;
+
+    OAConfig config(newdel, objects, pages, debug, padbytes, header, alignment);
+    oa  = new ObjectAllocator(sizeof(Student), config);
+
+    unsigned width = 32; 
+
+    for (int i = 0; i < total; i++)
+    {
+      void *p = oa->Allocate();
+      ptrs[i] = p;
+    }
+    //****************************************************************************
+    PrintConfig(oa);
+    PrintCounts(oa);
+    DumpPages(oa, width);
+
+    for (int i = 0; i < objects; i++)
+      oa->Free(ptrs[i + 0]);
+
+    for (int i = 0; i < objects; i++)
+      oa->Free(ptrs[i + 8]);
+
+    //****************************************************************************
+    PrintCounts(oa);
+    DumpPages(oa, width);
+
+    //****************************************************************************
+    oa->FreeEmptyPages();
+    PrintCounts(oa);
+    DumpPages(oa, width);
+
+    //****************************************************************************
+    for (int i = 0; i < objects - 1; i++)
+      oa->Free(ptrs[i + 4]);
+    oa->FreeEmptyPages();
+    PrintCounts(oa);
+    DumpPages(oa, width);
+
+    //****************************************************************************
+    oa->Free(ptrs[7]);
+    oa->FreeEmptyPages();
+    PrintCounts(oa);
+    DumpPages(oa, width);
+
+
+    //****************************************************************************
+    printf("\n\n");
+    void *p = oa->Allocate();
+    oa->FreeEmptyPages();
+    PrintCounts(oa);
+    DumpPages(oa, width);
+
+    oa->Free(p);
+    //oa->FreeEmptyPages();
+    PrintCounts(oa);
+    DumpPages(oa, width);
+
+    oa->FreeEmptyPages();
+    PrintCounts(oa);
+    DumpPages(oa, width);
+
+    delete oa;
+  }
+  catch (const OAException& e)
+  {
+    if (SHOW_EXCEPTIONS)
+      cout << e.what() << endl;
+    else
+      cout << "Exception thrown during TestFreeEmptyPages1."  << endl;
+
+    return;
+  }
+}
+
+void TestFreeEmptyPages2(void)
+{
+  if (!ObjectAllocator::ImplementedExtraCredit())
+    return;
+
+  ObjectAllocator *oa;
+  const int objects = 4;
+  const int pages = 3;
+  const int total = objects * pages;
+  void *ptrs[total];
+  try
+  {
+    bool newdel = false;
+    bool debug = true;
+    unsigned padbytes = 2;
+    OAConfig::HeaderBlockInfo header(OAConfig::hbBasic);
+    unsigned alignment = 16;
+
+    OAConfig config(newdel, objects, pages, debug, padbytes, header, alignment);
+    oa  = new ObjectAllocator(sizeof(Student), config);
+
+    unsigned width = 32;
+
+    for (int i = 0; i < total; i++)
+    {
+      void *p = oa->Allocate();
+      ptrs[i] = p;
+    }
+    //****************************************************************************
+    PrintConfig(oa);
+    PrintCounts(oa);
+    DumpPages(oa, width);
+
+    for (int i = 0; i < objects; i++)
+      oa->Free(ptrs[i + 0]);
+
+    for (int i = 0; i < objects; i++)
+      oa->Free(ptrs[i + 8]);
+
+    //****************************************************************************
+    PrintCounts(oa);
+    DumpPages(oa, width);
+
+    //****************************************************************************
+    oa->FreeEmptyPages();
+    PrintCounts(oa);
+    DumpPages(oa, width);
+
+    //****************************************************************************
+    for (int i = 0; i < objects - 1; i++)
+      oa->Free(ptrs[i + 4]);
+    oa->FreeEmptyPages();
+    PrintCounts(oa);
+    DumpPages(oa, width);
+
+    //****************************************************************************
+    oa->Free(ptrs[7]);
+    oa->FreeEmptyPages();
+    PrintCounts(oa);
+    DumpPages(oa, width);
+
+    delete oa;
+  }
+  catch (const OAException& e)
+  {
+    if (SHOW_EXCEPTIONS)
+      cout << e.what() << endl;
+    else
+      cout << "Exception thrown during TestFreeEmptyPages2."  << endl;
+
+    return;
+  }
+}
+
+void TestFreeEmptyPages3(void)
+{
+  if (!ObjectAllocator::ImplementedExtraCredit())
+    return;
+
+  ObjectAllocator *oa;
+  const int objects = 8;
+  const int pages = 48;
+  const int total = objects * pages;
+  void *ptrs[total];
+  try
+  {
+    bool newdel = false;
+    bool debug = true;
+    unsigned padbytes = 6;
+    OAConfig::HeaderBlockInfo header(OAConfig::hbExtended, 9);
+    unsigned alignment = 0;
+
+    OAConfig config(newdel, objects, pages, debug, padbytes, header, alignment);
+    oa  = new ObjectAllocator(sizeof(Student), config);
+
+    unsigned width = 32; 
+
+    for (int i = 0; i < total; i++)
+    {
+      void *p = oa->Allocate();
+      ptrs[i] = p;
+    }
+    PrintConfig(oa);
+    PrintCounts(oa);
+    //DumpPages(oa, width);
+
+    Shuffle(ptrs, total);
+    for (int i = 0; i < total - 5; i++)
+    {
+      oa->Free(ptrs[i]);
+    }
+    PrintCounts(oa);
+    //DumpPages(oa, width);
+
+    unsigned count = oa->FreeEmptyPages();
+    PrintCounts(oa);
+    DumpPages(oa, width);
+    printf("%i pages freed\n", count);
+
+    delete oa;
+  }
+  catch (const OAException& e)
+  {
+    if (SHOW_EXCEPTIONS)
+      cout << e.what() << endl;
+    else
+      cout << "Exception thrown during TestFreeEmptyPages3."  << endl;
+
+    return;
+  }
+}
+
+void TestFreeEmptyPages4(void)
+{
+  if (!ObjectAllocator::ImplementedExtraCredit())
+    return;
+
+  ObjectAllocator *oa;
+  const int objects = 8;
+  const int pages = 48;
+  const int total = objects * pages;
+  void *ptrs[total];
+  try
+  {
+    bool newdel = false;
+    bool debug = true;
+    unsigned padbytes = 6;
+    OAConfig::HeaderBlockInfo header(OAConfig::hbExtended, 9);
+    unsigned alignment = 0;
+
+    OAConfig config(newdel, objects, pages, debug, padbytes, header, alignment);
+    oa  = new ObjectAllocator(sizeof(Student), config);
+
+    unsigned width = 32; 
+
+    for (int i = 0; i < total; i++)
+    {
+      void *p = oa->Allocate();
+      ptrs[i] = p;
+    }
+    PrintConfig(oa);
+    PrintCounts(oa);
+    DumpPages(oa, width);
+
+    Shuffle(ptrs, total);
+    for (int i = 0; i < total - 5; i++)
+    {
+      oa->Free(ptrs[i]);
+      PrintCounts(oa);
+      DumpPages(oa, width);
+    }
+    //PrintCounts(oa);
+    //DumpPages(oa, width);
+
+    unsigned count = oa->FreeEmptyPages();
+    PrintCounts(oa);
+    DumpPages(oa, width);
+    printf("%i pages freed\n", count);
+
+    delete oa;
+  }
+  catch (const OAException& e)
+  {
+    if (SHOW_EXCEPTIONS)
+      cout << e.what() << endl;
+    else
+      cout << "Exception thrown during TestFreeEmptyPages3."  << endl;
+
+    return;
+  }
+}
+
+//****************************************************************************************************
+//****************************************************************************************************
+void ChurnThreadCache(ThreadCachedAllocator *tca, unsigned rounds)
+{
+  Student *students[300];
+  for (unsigned r = 0; r < rounds; r++)
+  {
+    for (unsigned i = 0; i < 300; i++)
+    {
+      students[i] = static_cast<Student *>(tca->Allocate());
+      students[i]->ID = i;
+    }
+    for (unsigned i = 0; i < 300; i++)
+      tca->Free(students[i]);
+  }
+}
+
+void DoubleFreeThreadCache(ThreadCachedAllocator *tca)
+{
+  void *kept = tca->Allocate();
+  void *twice = tca->Allocate();
+  tca->Free(twice);
+  tca->Free(twice);
+  tca->Free(kept);
+}
+
+void TestThreadCache(void)
+{
+  ThreadCachedAllocator *tca;
+  try
+  {
+    bool newdel = false;
+    bool debug = false;
+    unsigned padbytes = 0;
+    OAConfig::HeaderBlockInfo header(OAConfig::hbNone);
+    unsigned alignment = 0;
+    unsigned magazine = 32;
+
+    OAConfig config(newdel, 64, 64, debug, padbytes, header, alignment);
+    tca = new ThreadCachedAllocator(sizeof(Student), config, magazine);
+  }
+  catch (const OAException& e)
+  {
+    if (SHOW_EXCEPTIONS)
+      cout << e.what() << endl;
+    else
+      cout << "Exception thrown during construction in TestThreadCache."  << endl;
+    return;
+  }
+
+  try
+  {
+    const unsigned threads = 4;
+    std::thread workers[threads];
+    for (unsigned i = 0; i < threads; i++)
+      workers[i] = std::thread(ChurnThreadCache, tca, 20);
+    for (unsigned i = 0; i < threads; i++)
+      workers[i].join();
+
+      // whatever the allocator still counts as in use is parked in a magazine
+    OAStats stats = tca->GetStats();
+    cout << "Objects in use == Cached objects: " << (stats.ObjectsInUse_ == tca->CachedObjects()) << endl;
+
+      // the workers have exited, so flushing hands back their magazines too
+    tca->Flush();
+    stats = tca->GetStats();
+    cout << "Objects in use: " << stats.ObjectsInUse_;
+    cout << ", Cached objects: " << tca->CachedObjects();
+    cout << ", Allocs == Frees: " << (stats.Allocations_ == stats.Deallocations_) << endl;
+  }
+  catch (const OAException& e)
+  {
+    if (SHOW_EXCEPTIONS)
+      cout << e.what() << endl;
+    else
+      cout << "Exception thrown during TestThreadCache."  << endl;
+  }
+  delete tca;
+
+    // a block freed twice by a thread that has exited is caught when its
+    // magazine is reclaimed, and the blocks under it still go back
+  try
+  {
+    OAConfig config(false, 64, 64, true, 0, OAConfig::HeaderBlockInfo(OAConfig::hbNone), 0);
+    tca = new ThreadCachedAllocator(sizeof(Student), config, 32);
+  }
+  catch (const OAException& e)
+  {
+    if (SHOW_EXCEPTIONS)
+      cout << e.what() << endl;
+    else
+      cout << "Exception thrown during construction in TestThreadCache."  << endl;
+    return;
+  }
+
+  std::thread(DoubleFreeThreadCache, tca).join();
+  try
+  {
+    tca->Flush();
+    cout << "No exception thrown from Flush (freeing object twice) in TestThreadCache." << endl;
+  }
+  catch (const OAException& e)
+  {
+    if (SHOW_EXCEPTIONS)
+      cout << e.what() << endl;
+    else if (e.code() == e.E_MULTIPLE_FREE)
+      cout << "Exception thrown from Flush: E_MULTIPLE_FREE" << endl;
+    else
+      cout << "****** Unknown OAException thrown from Flush in TestThreadCache. ******"  << endl;
+  }
+  try
+  {
+    tca->Flush();
+    OAStats stats = tca->GetStats();
+    cout << "Cached objects: " << tca->CachedObjects();
+    cout << ", Frees - Allocs (the refused free): " << stats.Deallocations_ - stats.Allocations_ << endl;
+  }
+  catch (const OAException& e)
+  {
+    if (SHOW_EXCEPTIONS)
+      cout << e.what() << endl;
+    else
+      cout << "Exception thrown during TestThreadCache."  << endl;
+  }
+  delete tca;
+}
+
+void ChurnLockFree(ObjectAllocator *oa, unsigned rounds)
+{
+  Student *students[300];
+  for (unsigned r = 0; r < rounds; r++)
+  {
+    for (unsigned i = 0; i < 300; i++)
+    {
+      students[i] = static_cast<Student *>(oa->Allocate());
+      students[i]->ID = i;
+    }
+    for (unsigned i = 0; i < 300; i++)
+      oa->Free(students[i]);
+  }
+}
+
+void TestLockFree(void)
+{
+  ObjectAllocator *oa;
+  try
+  {
+    bool newdel = false;
+    bool debug = true;
+    unsigned padbytes = 4;
+    OAConfig::HeaderBlockInfo header(OAConfig::hbBasic);
+    unsigned alignment = 8;
+    bool lockfree = true;
+
+    OAConfig config(newdel, 64, 64, debug, padbytes, header, alignment, lockfree);
+    oa = new ObjectAllocator(sizeof(Student), config);
+  }
+  catch (const OAException& e)
+  {
+    if (SHOW_EXCEPTIONS)
+      cout << e.what() << endl;
+    else
+      cout << "Exception thrown during construction in TestLockFree."  << endl;
+    return;
+  }
+
+  try
+  {
+    const unsigned threads = 4;
+    std::thread workers[threads];
+    for (unsigned i = 0; i < threads; i++)
+      workers[i] = std::thread(ChurnLockFree, oa, 20);
+    for (unsigned i = 0; i < threads; i++)
+      workers[i].join();
+
+    PrintCounts2(oa);
+    OAStats stats = oa->GetStats();
+    cout << "Objects in use: " << stats.ObjectsInUse_;
+    cout << ", All blocks free: " << (stats.FreeObjects_ == stats.PagesInUse_ * oa->GetConfig().ObjectsPerPage_) << endl;
+    cout << "Corrupted blocks: " << oa->ValidatePages(ValidateCallback) << endl;
+  }
+  catch (const OAException& e)
+  {
+    if (SHOW_EXCEPTIONS)
+      cout << e.what() << endl;
+    else
+      cout << "Exception thrown during TestLockFree."  << endl;
+  }
+
+    // the debug checks still catch a double free, alone or in a batch
+  try
+  {
+    void *student = oa->Allocate();
+    oa->Free(student);
+    oa->Free(student);
+    cout << "No exception thrown from Free (freeing object twice) in TestLockFree." << endl;
+  }
+  catch (const OAException& e)
+  {
+    if (SHOW_EXCEPTIONS)
+      cout << e.what() << endl;
+    else if (e.code() == e.E_MULTIPLE_FREE)
+      cout << "Exception thrown from Free: E_MULTIPLE_FREE" << endl;
+    else
+      cout << "****** Unknown OAException thrown from Free in TestLockFree. ******"  << endl;
+  }
+
+  try
+  {
+    void *batch[2];
+    batch[0] = oa->Allocate();
+    batch[1] = batch[0];
+    oa->FreeBatch(batch, 2);
+    cout << "No exception thrown from FreeBatch (freeing object twice) in TestLockFree." << endl;
+  }
+  catch (const OAException& e)
+  {
+    if (SHOW_EXCEPTIONS)
+      cout << e.what() << endl;
+    else if (e.code() == e.E_MULTIPLE_FREE)
+      cout << "Exception thrown from FreeBatch: E_MULTIPLE_FREE" << endl;
+    else
+      cout << "****** Unknown OAException thrown from FreeBatch in TestLockFree. ******"  << endl;
+  }
+  delete oa;
+}
+
+void TestBatches(void)
+{
+  ObjectAllocator *oa;
+  try
+  {
+    bool newdel = false;
+    bool debug = true;
+    unsigned padbytes = 2;
+    OAConfig::HeaderBlockInfo header(OAConfig::hbBasic);
+    unsigned alignment = 0;
+
+    OAConfig config(newdel, 8, 4, debug, padbytes, header, alignment);
+    oa = new ObjectAllocator(sizeof(Student), config);
+  }
+  catch (const OAException& e)
+  {
+    if (SHOW_EXCEPTIONS)
+      cout << e.what() << endl;
+    else
+      cout << "Exception thrown during construction in TestBatches."  << endl;
+    return;
+  }
+
+  void *batch[32];
+  try
+  {
+    oa->AllocateBatch(batch, 20);
+    PrintCounts(oa);
+    oa->FreeBatch(batch + 10, 10);
+    PrintCounts(oa);
+    oa->DumpMemoryInUse(DumpCallback2);
+    cout << "Objects in use: " << oa->DumpMemoryInUse(DumpCallback2) << endl;
+  }
+  catch (const OAException& e)
+  {
+    if (SHOW_EXCEPTIONS)
+      cout << e.what() << endl;
+    else
+      cout << "Exception thrown from AllocateBatch/FreeBatch in TestBatches."  << endl;
+  }
+
+    // more than the allocator can hold, nothing should be allocated
+  try
+  {
+    oa->AllocateBatch(batch + 10, 23);
+    cout << "No exception thrown from AllocateBatch (too many) in TestBatches." << endl;
+  }
+  catch (const OAException& e)
+  {
+    if (SHOW_EXCEPTIONS)
+      cout << e.what() << endl;
+    else if (e.code() == e.E_NO_PAGES)
+      cout << "Exception thrown from AllocateBatch: E_NO_PAGES" << endl;
+    else
+      cout << "****** Unknown OAException thrown from AllocateBatch in TestBatches. ******"  << endl;
+  }
+  PrintCounts(oa);
+
+    // the same object twice in one batch, the first one is freed
+  try
+  {
+    batch[1] = batch[0];
+    oa->FreeBatch(batch, 2);
+    cout << "No exception thrown from FreeBatch (freeing object twice) in TestBatches." << endl;
+  }
+  catch (const OAException& e)
+  {
+    if (SHOW_EXCEPTIONS)
+      cout << e.what() << endl;
+    else if (e.code() == e.E_MULTIPLE_FREE)
+      cout << "Exception thrown from FreeBatch: E_MULTIPLE_FREE" << endl;
+    else
+      cout << "****** Unknown OAException thrown from FreeBatch in TestBatches. ******"  << endl;
+  }
+  PrintCounts(oa);
+
+  try
+  {
+    oa->FreeBatch(batch + 2, 8);
+    PrintCounts(oa);
+  }
+  catch (const OAException& e)
+  {
+    if (SHOW_EXCEPTIONS)
+      cout << e.what() << endl;
+    else
+      cout << "Exception thrown from FreeBatch in TestBatches."  << endl;
+  }
+  CheckAndDumpLeaks(oa);
+  delete oa;
+}
+
+void TestSizeClasses(void)
+{
+  SizeClassAllocator *sca;
+  try
+  {
+    bool newdel = false;
+    bool debug = true;
+    unsigned padbytes = 2;
+    OAConfig::HeaderBlockInfo header(OAConfig::hbBasic);
+    unsigned alignment = 0;
+
+    OAConfig config(newdel, 4, 2, debug, padbytes, header, alignment);
+    std::vector<size_t> sizes;
+    sizes.push_back(64);
+    sizes.push_back(5);
+    sizes.push_back(24);
+    sizes.push_back(20);
+    sca = new SizeClassAllocator(sizes, config);
+  }
+  catch (const OAException& e)
+  {
+    if (SHOW_EXCEPTIONS)
+      cout << e.what() << endl;
+    else
+      cout << "Exception thrown during construction in TestSizeClasses."  << endl;
+    return;
+  }
+
+  cout << "Size classes:";
+  for (unsigned i = 0; i < sca->ClassCount(); i++)
+    cout << " " << sca->ClassSize(i);
+  cout << endl;
+
+  const size_t requests[] = {1, 8, 9, 16, 17, 24, 25, 64, 65, 500};
+  const unsigned count = sizeof(requests) / sizeof(*requests);
+  void *objects[count];
+  try
+  {
+    for (unsigned i = 0; i < count; i++)
+      objects[i] = sca->Allocate(requests[i]);
+
+    for (unsigned i = 0; i < sca->ClassCount(); i++)
+    {
+      cout << "Class " << sca->ClassSize(i) << ": ";
+      PrintCounts(sca->GetClassAllocator(i));
+    }
+    OAStats stats = sca->GetStats();
+    cout << "Total objects in use: " << stats.ObjectsInUse_;
+    cout << ", Allocs: " << stats.Allocations_;
+    cout << ", Frees: " << stats.Deallocations_ << endl;
+
+    for (unsigned i = 0; i < count; i++)
+      sca->Free(objects[i], requests[i]);
+
+    stats = sca->GetStats();
+    cout << "Total objects in use: " << stats.ObjectsInUse_;
+    cout << ", Allocs: " << stats.Allocations_;
+    cout << ", Frees: " << stats.Deallocations_ << endl;
+    cout << "Empty pages freed: " << sca->FreeEmptyPages() << endl;
+    cout << "Objects in use: " << sca->DumpMemoryInUse(DumpCallback) << endl;
+  }
+  catch (const OAException& e)
+  {
+    if (SHOW_EXCEPTIONS)
+      cout << e.what() << endl;
+    else
+      cout << "Exception thrown during TestSizeClasses."  << endl;
+  }
+  delete sca;
+}
+
+void TestObjectPool(void)
+{
+  typedef PoolConfig<4, 2, true, 2, OAConfig::hbBasic> DebugConfig;
+  typedef ObjectPool<Student, DebugConfig> DebugPool;
+
+  ObjectAllocator *oa;
+  DebugPool *pool;
+  try
+  {
+      // the runtime configuration that DebugConfig spells out
+    OAConfig config(false, 4, 2, true, 2, OAConfig::HeaderBlockInfo(OAConfig::hbBasic), 0);
+    oa = new ObjectAllocator(sizeof(Student), config);
+    pool = new DebugPool;
+  }
+  catch (const OAException& e)
+  {
+    if (SHOW_EXCEPTIONS)
+      cout << e.what() << endl;
+    else
+      cout << "Exception thrown during construction in TestObjectPool."  << endl;
+    return;
+  }
+
+  Student *students[8];
+  try
+  {
+    for (unsigned i = 0; i < 8; i++)
+    {
+      oa->Allocate();
+      students[i] = pool->Allocate();
+    }
+    PrintCounts(oa);
+    OAStats stats = pool->GetStats();
+    cout << "Pool: Pages in use: " << stats.PagesInUse_;
+    cout << ", Objects in use: " << stats.ObjectsInUse_;
+    cout << ", Available objects: " << stats.FreeObjects_;
+    cout << ", Allocs: " << stats.Allocations_;
+    cout << ", Frees: " << stats.Deallocations_ << endl;
+
+      // everything but the next page pointers should match byte for byte
+    const char *oaPage = static_cast<const char *>(oa->GetPageList());
+    const char *poolPage = static_cast<const char *>(pool->GetPageList());
+    bool same = oa->GetStats().PageSize_ == DebugPool::PageSize;
+    while (same && oaPage && poolPage)
+    {
+      same = !std::memcmp(oaPage + sizeof(void *), poolPage + sizeof(void *), DebugPool::PageSize - sizeof(void *));
+      oaPage = *reinterpret_cast<const char * const *>(oaPage);
+      poolPage = *reinterpret_cast<const char * const *>(poolPage);
+    }
+    cout << "Same pages as ObjectAllocator: " << (same && !oaPage && !poolPage ? "yes" : "no") << endl;
+
+    pool->Free(students[3]);
+    pool->Free(students[6]);
+    cout << "Objects in use: " << pool->DumpMemoryInUse(DumpCallback2) << endl;
+  }
+  catch (const OAException& e)
+  {
+    if (SHOW_EXCEPTIONS)
+      cout << e.what() << endl;
+    else
+      cout << "Exception thrown during TestObjectPool."  << endl;
+  }
+
+  try
+  {
+    pool->Free(students[3]);
+    cout << "No exception thrown from Free (freeing object twice) in TestObjectPool." << endl;
+  }
+  catch (const OAException& e)
+  {
+    if (SHOW_EXCEPTIONS)
+      cout << e.what() << endl;
+    else if (e.code() == e.E_MULTIPLE_FREE)
+      cout << "Exception thrown from Free: E_MULTIPLE_FREE" << endl;
+    else
+      cout << "****** Unknown OAException thrown from Free in TestObjectPool. ******"  << endl;
+  }
+
+  try
+  {
+    pool->Free(reinterpret_cast<Student *>(reinterpret_cast<char *>(students[0]) + 4));
+    cout << "No exception thrown from Free (bad boundary) in TestObjectPool." << endl;
+  }
+  catch (const OAException& e)
+  {
+    if (SHOW_EXCEPTIONS)
+      cout << e.what() << endl;
+    else if (e.code() == e.E_BAD_BOUNDARY)
+      cout << "Exception thrown from Free: E_BAD_BOUNDARY" << endl;
+    else
+      cout << "****** Unknown OAException thrown from Free in TestObjectPool. ******"  << endl;
+  }
+
+  try
+  {
+    reinterpret_cast<char *>(students[1])[sizeof(Student)] = 0;
+    cout << "Corrupted blocks: " << pool->ValidatePages(DumpCallback2) << endl;
+    pool->Free(students[1]);
+    cout << "No exception thrown from Free (corrupted block) in TestObjectPool." << endl;
+  }
+  catch (const OAException& e)
+  {
+    if (SHOW_EXCEPTIONS)
+      cout << e.what() << endl;
+    else if (e.code() == e.E_CORRUPTED_BLOCK)
+      cout << "Exception thrown from Free: E_CORRUPTED_BLOCK" << endl;
+    else
+      cout << "****** Unknown OAException thrown from Free in TestObjectPool. ******"  << endl;
+  }
+  delete pool;
+  delete oa;
+
+    // the release pool has no checks or counters, just pages and a free list
+  ObjectPool<Student, PoolConfig<4, 3> > release;
+  try
+  {
+    for (unsigned i = 0; i < 8; i++)
+      students[i] = release.Allocate();
+    for (unsigned i = 0; i < 8; i++)
+      release.Free(students[i]);
+    for (unsigned i = 0; i < 12; i++)
+      release.Allocate();
+    cout << "Release pool: Pages in use: " << release.GetStats().PagesInUse_;
+    cout << ", Allocs: " << release.GetStats().Allocations_ << endl;
+    release.Allocate();
+  }
+  catch (const OAException& e)
+  {
+    if (SHOW_EXCEPTIONS)
+      cout << e.what() << endl;
+    else if (e.code() == e.E_NO_PAGES)
+      cout << "Exception thrown from Allocate: E_NO_PAGES" << endl;
+    else
+      cout << "****** Unknown OAException thrown from Allocate in TestObjectPool. ******"  << endl;
+  }
+}
+
+  // allocates every object twice over, checking the pages' alignment
+void ChurnPageSource(size_t size, const OAConfig &config, size_t alignment)
+{
+  ObjectAllocator *oa;
+  try
+  {
+    oa = new ObjectAllocator(size, config);
+  }
+  catch (const OAException& e)
+  {
+    if (SHOW_EXCEPTIONS)
+      cout << e.what() << endl;
+    else
+      cout << "Exception thrown during construction in TestPageSources."  << endl;
+    return;
+  }
+
+  unsigned count = config.ObjectsPerPage_ * config.MaxPages_;
+  std::vector<void *> objects(count);
+  try
+  {
+    for (unsigned pass = 0; pass < 2; pass++)
+    {
+      for (unsigned i = 0; i < count; i++)
+        objects[i] = oa->Allocate();
+
+      bool aligned = true;
+      for (const GenericObject *page = static_cast<const GenericObject *>(oa->GetPageList()); page; page = page->Next)
+        aligned = aligned && reinterpret_cast<size_t>(page) % alignment == 0;
+      PrintCounts(oa);
+      cout << "Pages aligned: " << (aligned ? "yes" : "no") << endl;
+
+      for (unsigned i = 0; i < count; i++)
+        oa->Free(objects[i]);
+      cout << "Empty pages freed: " << oa->FreeEmptyPages() << endl;
+    }
+    PrintCounts(oa);
+  }
+  catch (const OAException& e)
+  {
+    if (SHOW_EXCEPTIONS)
+      cout << e.what() << endl;
+    else
+      cout << "Exception thrown during TestPageSources."  << endl;
+  }
+  delete oa;
+}
+
+void TestPageSources(void)
+{
+  bool newdel = false;
+  bool debug = true;
+  unsigned padbytes = 2;
+  OAConfig::HeaderBlockInfo header(OAConfig::hbBasic);
+  unsigned alignment = 0;
+
+  MmapPageSource mapped;
+  OAConfig config(newdel, 4, 3, debug, padbytes, header, alignment, false, &mapped);
+  ChurnPageSource(sizeof(Student), config, 4096);
+
+  HugePageSource huge;
+  config = OAConfig(newdel, 8192, 2, debug, padbytes, header, alignment, false, &huge);
+  ChurnPageSource(sizeof(Student), config, HugePageSource::HUGE_PAGE_SIZE);
+}
+
+void TestGrowthPolicy(void)
+{
+  ObjectAllocator *oa;
+  try
+  {
+    bool newdel = false;
+    bool debug = true;
+    unsigned padbytes = 0;
+    OAConfig::HeaderBlockInfo header(OAConfig::hbBasic);
+    unsigned alignment = 8;
+    OAConfig::GrowthPolicy growth(OAConfig::gpGeometric, 16);
+
+    OAConfig config(newdel, 2, 6, debug, padbytes, header, alignment, false, 0, growth);
+    oa = new ObjectAllocator(sizeof(Student), config);
+  }
+  catch (const OAException& e)
+  {
+    if (SHOW_EXCEPTIONS)
+      cout << e.what() << endl;
+    else
+      cout << "Exception thrown during construction in TestGrowthPolicy."  << endl;
+    return;
+  }
+
+  void *objects[46];
+  try
+  {
+    unsigned pages = 0;
+    for (unsigned i = 0; i < 46; i++)
+    {
+      objects[i] = oa->Allocate();
+      OAStats stats = oa->GetStats();
+      if (stats.PagesInUse_ != pages)
+      {
+        pages = stats.PagesInUse_;
+        cout << "Page " << pages << ": capacity " << stats.PageCapacity_ << ", size " << stats.PageSize_ << endl;
+      }
+    }
+    PrintCounts(oa);
+
+      // a byte off a block on the biggest page
+    oa->Free(static_cast<char *>(objects[40]) + 1);
+    cout << "No exception thrown from Free (bad boundary) in TestGrowthPolicy." << endl;
+  }
+  catch (const OAException& e)
+  {
+    if (SHOW_EXCEPTIONS)
+      cout << e.what() << endl;
+    else if (e.code() == e.E_BAD_BOUNDARY)
+      cout << "Exception thrown from Free: E_BAD_BOUNDARY" << endl;
+    else
+      cout << "****** Unknown OAException thrown in TestGrowthPolicy. ******"  << endl;
+  }
+
+  try
+  {
+      // empties the small pages, the two biggest ones keep a block each
+    for (unsigned i = 0; i < 46; i++)
+      if (i != 20 && i != 40)
+        oa->Free(objects[i]);
+    cout << "Objects in use: " << oa->DumpMemoryInUse(DumpCallback2) << endl;
+    cout << "Corrupted blocks: " << oa->ValidatePages(DumpCallback2) << endl;
+    cout << "Empty pages freed: " << oa->FreeEmptyPages() << endl;
+    PrintCounts(oa);
+  }
+  catch (const OAException& e)
+  {
+    if (SHOW_EXCEPTIONS)
+      cout << e.what() << endl;
+    else
+      cout << "Exception thrown during TestGrowthPolicy."  << endl;
+  }
+  delete oa;
+
+    // pages sized to fill a byte target instead of a block count
+  try
+  {
+    OAConfig::GrowthPolicy growth(OAConfig::gpPageBytes, 1024);
+    OAConfig config(false, 4, 2, false, 0, OAConfig::HeaderBlockInfo(), 0, false, 0, growth);
+    ObjectAllocator bytes(sizeof(Student), config);
+    OAStats stats = bytes.GetStats();
+    cout << "Page capacity " << stats.PageCapacity_ << ", size " << stats.PageSize_ << endl;
+  }
+  catch (const OAException& e)
+  {
+    if (SHOW_EXCEPTIONS)
+      cout << e.what() << endl;
+    else
+      cout << "Exception thrown during TestGrowthPolicy."  << endl;
+  }
+
+    // doubling without a cap stops at the default one
+  try
+  {
+    unsigned most = OAConfig::GrowthPolicy::DEFAULT_MAX_OBJECTS;
+    OAConfig::GrowthPolicy growth(OAConfig::gpGeometric);
+    OAConfig config(false, most / 4, 0, false, 0, OAConfig::HeaderBlockInfo(), 0, false, 0, growth);
+    ObjectAllocator doubling(sizeof(Student), config);
+    doubling.Reserve(most / 4 + most / 2 + most * 2);
+    OAStats stats = doubling.GetStats();
+    cout << "Pages " << stats.PagesInUse_ << ", newest capacity " << stats.PageCapacity_ << endl;
+  }
+  catch (const OAException& e)
+  {
+    if (SHOW_EXCEPTIONS)
+      cout << e.what() << endl;
+    else
+      cout << "Exception thrown during TestGrowthPolicy."  << endl;
+  }
+}
+
+  // the external header record of an object
+const MemBlockInfo *ExternalInfo(const ObjectAllocator *oa, const void *object)
+{
+  const char *header = static_cast<const char *>(object) - oa->GetConfig().PadBytes_ - OAConfig::EXTERNAL_HEADER_SIZE;
+  return *reinterpret_cast<const MemBlockInfo * const *>(header);
+}
+
+void TestExternalRecords(void)
+{
+  ObjectAllocator *oa;
+  try
+  {
+    bool newdel = false;
+    bool debug = true;
+    unsigned padbytes = 2;
+    OAConfig::HeaderBlockInfo header(OAConfig::hbExternal);
+    unsigned alignment = 0;
+
+    OAConfig config(newdel, 4, 2, debug, padbytes, header, alignment);
+    oa = new ObjectAllocator(sizeof(Student), config);
+  }
+  catch (const OAException& e)
+  {
+    if (SHOW_EXCEPTIONS)
+      cout << e.what() << endl;
+    else
+      cout << "Exception thrown during construction in TestExternalRecords."  << endl;
+    return;
+  }
+
+  try
+  {
+    char buffer[16];
+    std::strcpy(buffer, "student");
+    void *first = oa->Allocate("student");
+    void *second = oa->Allocate(buffer);
+    void *third = oa->Allocate("teacher");
+    void *fourth = oa->Allocate();
+
+    const MemBlockInfo *info = ExternalInfo(oa, second);
+    cout << "Label: " << info->label << ", Alloc #: " << info->alloc_num << endl;
+    cout << "Labels shared: " << (ExternalInfo(oa, first)->label == info->label ? "yes" : "no") << endl;
+    cout << "No label: " << (ExternalInfo(oa, fourth)->label ? "no" : "yes") << endl;
+
+      // the record comes back for the next allocation
+    oa->Free(second);
+    cout << "Freed header: " << (ExternalInfo(oa, second) ? "set" : "cleared") << endl;
+    void *fifth = oa->Allocate("teacher");
+    cout << "Record reused: " << (ExternalInfo(oa, fifth) == info ? "yes" : "no") << endl;
+    cout << "Labels shared: " << (ExternalInfo(oa, third)->label == ExternalInfo(oa, fifth)->label ? "yes" : "no") << endl;
+
+    cout << "Objects in use: " << oa->DumpMemoryInUse(DumpCallback2) << endl;
+    oa->Free(first);
+    oa->Free(third);
+    oa->Free(fourth);
+    oa->Free(fifth);
+    cout << "Objects in use: " << oa->DumpMemoryInUse(DumpCallback2) << endl;
+  }
+  catch (const OAException& e)
+  {
+    if (SHOW_EXCEPTIONS)
+      cout << e.what() << endl;
+    else
+      cout << "Exception thrown during TestExternalRecords."  << endl;
+  }
+  delete oa;
+}
+
+void TestLazyPages(void)
+{
+  ObjectAllocator *oa;
+  try
+  {
+    bool newdel = false;
+    bool debug = true;
+    unsigned padbytes = 2;
+    OAConfig::HeaderBlockInfo header(OAConfig::hbBasic);
+    unsigned alignment = 8;
+
+    OAConfig config(newdel, 1024, 2, debug, padbytes, header, alignment, false, 0,
+                    OAConfig::GrowthPolicy(), true);
+    oa = new ObjectAllocator(sizeof(Student), config);
+  }
+  catch (const OAException& e)
+  {
+    if (SHOW_EXCEPTIONS)
+      cout << e.what() << endl;
+    else
+      cout << "Exception thrown during construction in TestLazyPages."  << endl;
+    return;
+  }
+
+  std::vector<void *> objects;
+  try
+  {
+    PrintCounts(oa);
+    cout << "Free list empty: " << (oa->GetFreeList() ? "no" : "yes") << endl;
+
+    for (unsigned i = 0; i < 3; i++)
+      objects.push_back(oa->Allocate());
+    PrintCounts(oa);
+    cout << "Objects in use: " << oa->DumpMemoryInUse(DumpCallback2) << endl;
+    cout << "Corrupted blocks: " << oa->ValidatePages(DumpCallback2) << endl;
+
+      // only returned blocks go on the free list
+    oa->Free(objects[1]);
+    cout << "Free list holds the freed block: " << (oa->GetFreeList() == objects[1] ? "yes" : "no") << endl;
+    objects[1] = oa->Allocate();
+    cout << "Freed block reused: " << (oa->GetFreeList() ? "no" : "yes") << endl;
+
+    while (objects.size() < 1500)
+      objects.push_back(oa->Allocate());
+    PrintCounts(oa);
+    cout << "Objects in use: " << oa->DumpMemoryInUse(DumpCallback2) << endl;
+    cout << "Corrupted blocks: " << oa->ValidatePages(DumpCallback2) << endl;
+
+    for (size_t i = 0; i < objects.size(); i++)
+      oa->Free(objects[i]);
+    cout << "Empty pages freed: " << oa->FreeEmptyPages() << endl;
+    PrintCounts(oa);
+
+    objects[0] = oa->Allocate();
+    PrintCounts(oa);
+    oa->Free(objects[0]);
+  }
+  catch (const OAException& e)
+  {
+    if (SHOW_EXCEPTIONS)
+      cout << e.what() << endl;
+    else
+      cout << "Exception thrown during TestLazyPages."  << endl;
+  }
+  delete oa;
+}
+
+void PrintHistogram(const char *name, const OAHistogram &histogram)
+{
+  unsigned long long timed = 0;
+  for (unsigned i = 0; i < OAHistogram::BUCKETS; i++)
+    timed += histogram.Buckets_[i];
+  cout << name << ": " << histogram.Calls_ << " calls, " << (timed == histogram.Calls_ ? "all" : "not all") << " bucketed" << endl;
+}
+
+void TestInstrumentation(void)
+{
+  ObjectAllocator *oa;
+  try
+  {
+    bool newdel = false;
+    bool debug = true;
+    unsigned padbytes = 2;
+    OAConfig::HeaderBlockInfo header(OAConfig::hbBasic);
+    unsigned alignment = 0;
+
+    OAConfig config(newdel, 4, 3, debug, padbytes, header, alignment);
+    oa = new ObjectAllocator(sizeof(Student), config);
+  }
+  catch (const OAException& e)
+  {
+    if (SHOW_EXCEPTIONS)
+      cout << e.what() << endl;
+    else
+      cout << "Exception thrown during construction in TestInstrumentation."  << endl;
+    return;
+  }
+
+  try
+  {
+    void *objects[10];
+    for (unsigned i = 0; i < 10; i++)
+      objects[i] = oa->Allocate(i % 3 ? "student" : (i ? "teacher" : 0));
+    for (unsigned i = 0; i < 10; i++)
+      oa->Free(objects[i]);
+  }
+  catch (const OAException& e)
+  {
+    if (SHOW_EXCEPTIONS)
+      cout << e.what() << endl;
+    else
+      cout << "Exception thrown during TestInstrumentation."  << endl;
+  }
+
+  OAInstrumentation instrumentation = oa->GetInstrumentation();
+  if (!instrumentation.Enabled_)
+  {
+    cout << "Instrumentation not built in (OA_INSTRUMENT)" << endl;
+  }
+  else
+  {
+    PrintHistogram("Allocate", instrumentation.Allocate_);
+    PrintHistogram("Free", instrumentation.Free_);
+    PrintHistogram("Page growth", instrumentation.PageGrowth_);
+    PrintHistogram("Validation", instrumentation.Validation_);
+    PrintHistogram("Header setup", instrumentation.HeaderSetup_);
+    std::map<std::string, unsigned>::const_iterator it;
+    for (it = instrumentation.LabelCounts_.begin(); it != instrumentation.LabelCounts_.end(); ++it)
+      cout << "Label " << it->first << ": " << it->second << endl;
+  }
+  delete oa;
+}
+
+void PrintOccupancy(const OAOccupancy &report)
+{
+  for (size_t i = 0; i < report.Pages_.size(); i++)
+  {
+    const OAPageOccupancy &page = report.Pages_[i];
+    cout << "Page " << i << ": " << page.InUse_ << "/" << page.Capacity_ << " in use, free list rank ";
+    if (page.FreeListRank_ == OAOccupancy::NOT_ON_FREE_LIST)
+      cout << "-";
+    else
+      cout << page.FreeListRank_;
+    cout << endl;
+  }
+  cout << "Histogram:";
+  for (unsigned i = 0; i < OAOccupancy::BUCKETS; i++)
+    cout << " " << report.Histogram_[i];
+  cout << endl;
+  cout << "Empty pages: " << report.EmptyPages_ << ", full pages: " << report.FullPages_
+       << ", free list runs: " << report.FreeListRuns_ << endl;
+}
+
+void TestOccupancy(void)
+{
+  ObjectAllocator *oa;
+  try
+  {
+    bool newdel = false;
+    bool debug = true;
+    unsigned padbytes = 0;
+    OAConfig::HeaderBlockInfo header(OAConfig::hbNone);
+    unsigned alignment = 0;
+
+    OAConfig config(newdel, 4, 3, debug, padbytes, header, alignment);
+    oa = new ObjectAllocator(sizeof(Student), config);
+  }
+  catch (const OAException& e)
+  {
+    if (SHOW_EXCEPTIONS)
+      cout << e.what() << endl;
+    else
+      cout << "Exception thrown during construction in TestOccupancy."  << endl;
+    return;
+  }
+
+  try
+  {
+    void *objects[10];
+    for (unsigned i = 0; i < 10; i++)
+      objects[i] = oa->Allocate();
+
+    cout << "After 10 allocations:" << endl;
+    PrintOccupancy(oa->GetOccupancy());
+
+      // empties the oldest page and frees half of the next one
+    oa->Free(objects[0]);
+    oa->Free(objects[4]);
+    oa->Free(objects[1]);
+    oa->Free(objects[2]);
+    oa->Free(objects[6]);
+    oa->Free(objects[3]);
+    cout << "After 6 frees:" << endl;
+    OAOccupancy report = oa->GetOccupancy();
+    PrintOccupancy(report);
+
+    size_t pageSize = oa->GetStats().PageSize_;
+    cout << "Reclaimable pages: " << report.ReclaimableBytes_ / pageSize << endl;
+    cout << "Pages freed: " << oa->FreeEmptyPages() << endl;
+    cout << "After FreeEmptyPages:" << endl;
+    PrintOccupancy(oa->GetOccupancy());
+
+    oa->Free(objects[5]);
+    oa->Free(objects[7]);
+    oa->Free(objects[8]);
+    oa->Free(objects[9]);
+
+      // without debugging the counts are only worked out when asked for
+    oa->SetDebugState(false);
+    for (unsigned i = 0; i < 6; i++)
+      objects[i] = oa->Allocate();
+    oa->Free(objects[1]);
+    oa->Free(objects[4]);
+    cout << "Debugging off, after 6 allocations and 2 frees:" << endl;
+    PrintOccupancy(oa->GetOccupancy());
+
+      // turning it back on still knows which blocks were freed while it was off
+    oa->SetDebugState(true);
+    try
+    {
+      oa->Free(objects[4]);
+      cout << "No exception thrown from Free (freeing object twice) in TestOccupancy." << endl;
+    }
+    catch (const OAException& e)
+    {
+      if (SHOW_EXCEPTIONS)
+        cout << e.what() << endl;
+      else if (e.code() == e.E_MULTIPLE_FREE)
+        cout << "Exception thrown from Free: E_MULTIPLE_FREE" << endl;
+      else
+        cout << "****** Unknown OAException thrown from Free in TestOccupancy. ******"  << endl;
+    }
+    oa->Free(objects[0]);
+    oa->Free(objects[2]);
+    oa->Free(objects[3]);
+    oa->Free(objects[5]);
+    cout << "Pages freed: " << oa->FreeEmptyPages() << endl;
+  }
+  catch (const OAException& e)
+  {
+    if (SHOW_EXCEPTIONS)
+      cout << e.what() << endl;
+    else
+      cout << "Exception thrown during TestOccupancy."  << endl;
+  }
+
+  delete oa;
+}
+
+std::vector<const void *> SweptBlocks;
+std::atomic<unsigned> ConcurrentHits(0);
+
+void RecordBlock(const void *block, size_t)
+{
+  SweptBlocks.push_back(block);
+}
+
+void CountBlock(const void *, size_t)
+{
+  ConcurrentHits++;
+}
+
+void TestParallelSweeps(void)
+{
+  ObjectAllocator *oa;
+  try
+  {
+    bool newdel = false;
+    bool debug = true;
+    unsigned padbytes = 2;
+    OAConfig::HeaderBlockInfo header(OAConfig::hbBasic);
+    unsigned alignment = 0;
+
+    OAConfig config(newdel, 64, 8, debug, padbytes, header, alignment);
+    oa = new ObjectAllocator(sizeof(Student), config);
+  }
+  catch (const OAException& e)
+  {
+    if (SHOW_EXCEPTIONS)
+      cout << e.what() << endl;
+    else
+      cout << "Exception thrown during construction in TestParallelSweeps."  << endl;
+    return;
+  }
+
+  try
+  {
+    std::vector<void *> objects;
+    for (unsigned i = 0; i < 500; i++)
+      objects.push_back(oa->Allocate());
+    for (unsigned i = 0; i < 500; i += 3)
+      oa->Free(objects[i]);
+
+      // runs over the pads of a few blocks
+    for (unsigned i = 1; i < 500; i += 50)
+      std::memset(objects[i], 0, sizeof(Student) + 1);
+
+    SweptBlocks.clear();
+    unsigned leaks = oa->DumpMemoryInUse(RecordBlock);
+    std::vector<const void *> serialLeaks = SweptBlocks;
+    SweptBlocks.clear();
+    unsigned corrupted = oa->ValidatePages(RecordBlock);
+    std::vector<const void *> serialCorrupted = SweptBlocks;
+    cout << "Serial: " << leaks << " in use, " << corrupted << " corrupted" << endl;
+
+    unsigned threadCounts[] = {1, 3, 4, 16};
+    for (unsigned t = 0; t < 4; t++)
+    {
+      SweptBlocks.clear();
+      unsigned parallelLeaks = oa->DumpMemoryInUseParallel(RecordBlock, threadCounts[t]);
+      bool leaksMatch = SweptBlocks == serialLeaks;
+      SweptBlocks.clear();
+      unsigned parallelCorrupted = oa->ValidatePagesParallel(RecordBlock, threadCounts[t]);
+      bool corruptedMatch = SweptBlocks == serialCorrupted;
+      cout << threadCounts[t] << " threads in page order: " << parallelLeaks << " in use, " 
+           << parallelCorrupted << " corrupted, callbacks " 
+           << (leaksMatch && corruptedMatch ? "match" : "differ") << endl;
+    }
+
+    ConcurrentHits = 0;
+    unsigned concurrentLeaks = oa->DumpMemoryInUseParallel(CountBlock, 4, ObjectAllocator::coConcurrent);
+    cout << "4 threads concurrently: " << concurrentLeaks << " in use, " << ConcurrentHits << " callbacks" << endl;
+    ConcurrentHits = 0;
+    unsigned concurrentCorrupted = oa->ValidatePagesParallel(CountBlock, 0, ObjectAllocator::coConcurrent);
+    cout << "all cores concurrently: " << concurrentCorrupted << " corrupted, " << ConcurrentHits << " callbacks" << endl;
+  }
+  catch (const OAException& e)
+  {
+    if (SHOW_EXCEPTIONS)
+      cout << e.what() << endl;
+    else
+      cout << "Exception thrown during TestParallelSweeps."  << endl;
+  }
+
+  delete oa;
+}
+
+void TestIncrementalValidation(void)
+{
+  ObjectAllocator *oa;
+  try
+  {
+    bool newdel = false;
+    bool debug = true;
+    unsigned padbytes = 2;
+    OAConfig::HeaderBlockInfo header(OAConfig::hbNone);
+    unsigned alignment = 0;
+
+    OAConfig config(newdel, 4, 4, debug, padbytes, header, alignment);
+    oa = new ObjectAllocator(sizeof(Student), config);
+  }
+  catch (const OAException& e)
+  {
+    if (SHOW_EXCEPTIONS)
+      cout << e.what() << endl;
+    else
+      cout << "Exception thrown during construction in TestIncrementalValidation."  << endl;
+    return;
+  }
+
+  try
+  {
+      // objects 0-3 are on the older page, 4-7 on the newer one
+    void *objects[12];
+    for (unsigned i = 0; i < 8; i++)
+      objects[i] = oa->Allocate();
+    std::memset(objects[1], 0, sizeof(Student) + 1);
+    std::memset(objects[2], 0, sizeof(Student) + 1);
+
+    cout << "A pass 3 blocks at a time:";
+    for (unsigned call = 0; call < 3; call++)
+      cout << " " << oa->ValidatePagesIncremental(DumpCallback2, 3);
+    cout << endl;
+
+      // leaves the cursor half way through the newer page, then frees it
+    oa->ValidatePagesIncremental(DumpCallback2, 2);
+    for (unsigned i = 4; i < 8; i++)
+      oa->Free(objects[i]);
+    cout << "Pages freed: " << oa->FreeEmptyPages() << endl;
+    cout << "Resumes on the older page: " << oa->ValidatePagesIncremental(DumpCallback2, 3) << endl;
+    cout << "Finishes the pass: " << oa->ValidatePagesIncremental(DumpCallback2, 100) << endl;
+
+      // a page added between calls is part of the next pass
+    for (unsigned i = 8; i < 12; i++)
+      objects[i] = oa->Allocate();
+    std::memset(objects[8], 0, sizeof(Student) + 1);
+    cout << "After adding a page: " << oa->ValidatePagesIncremental(DumpCallback2, 100)
+         << " (ValidatePages: " << oa->ValidatePages(DumpCallback2) << ")" << endl;
+  }
+  catch (const OAException& e)
+  {
+    if (SHOW_EXCEPTIONS)
+      cout << e.what() << endl;
+    else
+      cout << "Exception thrown during TestIncrementalValidation."  << endl;
+  }
+
+  delete oa;
+}
+
+void TestSampledGuards(void)
+{
+  ObjectAllocator *oa;
+  try
+  {
+    bool newdel = false;
+    bool debug = true;
+    unsigned padbytes = 2;
+    OAConfig::HeaderBlockInfo header(OAConfig::hbBasic);
+    unsigned alignment = 0;
+    unsigned sampleRate = 8;
+
+    OAConfig config(newdel, 16, 4, debug, padbytes, header, alignment, false, 0, 
+                    OAConfig::GrowthPolicy(), false, sampleRate);
+    oa = new ObjectAllocator(sizeof(Student), config);
+  }
+  catch (const OAException& e)
+  {
+    if (SHOW_EXCEPTIONS)
+      cout << e.what() << endl;
+    else
+      cout << "Exception thrown during construction in TestSampledGuards."  << endl;
+    return;
+  }
+
+  try
+  {
+    void *objects[64];
+    unsigned guarded = 0;
+    for (unsigned i = 0; i < 64; i++)
+    {
+      objects[i] = oa->Allocate();
+      // the last byte, since the first word of an unguarded block is its
+      // old free list link, which can happen to end in the pattern
+      if (static_cast<unsigned char *>(objects[i])[sizeof(Student) - 1] == ObjectAllocator::ALLOCATED_PATTERN)
+        guarded++;
+    }
+    cout << "Guarded allocations: " << guarded << " of 64" << endl;
+
+      // every block runs over its pad, but only the guarded frees look
+    for (unsigned i = 0; i < 64; i++)
+      std::memset(objects[i], 0, sizeof(Student) + 1);
+    cout << "Corrupted blocks found by ValidatePages: " << oa->ValidatePages(DumpCallback2) << endl;
+
+    unsigned caught = 0;
+    for (unsigned i = 0; i < 64; i++)
+    {
+      try
+      {
+        oa->Free(objects[i]);
+      }
+      catch (const OAException &e)
+      {
+        if (e.code() == OAException::E_CORRUPTED_BLOCK)
+          caught++;
+      }
+    }
+    cout << "Corrupted frees caught: " << caught << endl;
+
+      // the unguarded blocks went back, and freeing them again is always caught
+    unsigned doubled = 0;
+    for (unsigned i = 0; i < 64; i++)
+    {
+      try
+      {
+        oa->Free(objects[i]);
+      }
+      catch (const OAException &e)
+      {
+        if (e.code() == OAException::E_MULTIPLE_FREE)
+          doubled++;
+      }
+    }
+    cout << "Double frees caught: " << doubled << " (" << 64 - guarded << " unguarded)" << endl;
+  }
+  catch (const OAException& e)
+  {
+    if (SHOW_EXCEPTIONS)
+      cout << e.what() << endl;
+    else
+      cout << "Exception thrown during TestSampledGuards."  << endl;
+  }
+
+  delete oa;
+}
+
+void TestPadKernels(void)
+{
+  const PadKernels::KERNEL_TYPE kernels[] = {PadKernels::kScalar, PadKernels::kSSE2,
+                                             PadKernels::kAVX2, PadKernels::kNEON};
+  const unsigned char pattern = ObjectAllocator::PAD_PATTERN;
+  unsigned char buffer[160];
+  unsigned disagreements = 0;
+
+    // every length at every alignment, intact and with each byte wrong in turn
+  for (unsigned k = 0; k < 4; k++)
+  {
+    if (!PadKernels::Supported(kernels[k]))
+      continue;
+    for (unsigned offset = 0; offset < 32; offset++)
+    {
+      for (unsigned size = 0; size <= 128; size++)
+      {
+        std::memset(buffer, pattern, sizeof(buffer));
+        if (!PadKernels::MatchesWith(kernels[k], buffer + offset, size, pattern) ||
+            !PadKernels::Matches(buffer + offset, size, pattern))
+          disagreements++;
+        for (unsigned wrong = 0; wrong < size; wrong++)
+        {
+          buffer[offset + wrong] = 0;
+          if (PadKernels::MatchesWith(kernels[k], buffer + offset, size, pattern) ||
+              PadKernels::Matches(buffer + offset, size, pattern))
+            disagreements++;
+          buffer[offset + wrong] = pattern;
+        }
+      }
+    }
+  }
+  cout << "Kernel disagreements: " << disagreements << endl;
+
+    // the fills write every byte of the run and nothing either side of it
+  unsigned badFills = 0;
+  for (unsigned k = 0; k < 4; k++)
+  {
+    if (!PadKernels::Supported(kernels[k]))
+      continue;
+    for (unsigned offset = 0; offset < 32; offset++)
+    {
+      for (unsigned size = 0; size <= 128; size++)
+      {
+        for (unsigned dispatched = 0; dispatched < 2; dispatched++)
+        {
+          std::memset(buffer, 0, sizeof(buffer));
+          if (dispatched)
+            PadKernels::Fill(buffer + offset, size, pattern);
+          else
+            PadKernels::FillWith(kernels[k], buffer + offset, size, pattern);
+          for (unsigned i = 0; i < sizeof(buffer); i++)
+            if ((buffer[i] == pattern) != (i >= offset && i < offset + size))
+            {
+              badFills++;
+              break;
+            }
+        }
+      }
+    }
+  }
+  cout << "Bad fills: " << badFills << endl;
+
+  ObjectAllocator *oa;
+  try
+  {
+    bool newdel = false;
+    bool debug = true;
+    unsigned padbytes = 40;
+    OAConfig::HeaderBlockInfo header(OAConfig::hbBasic);
+    unsigned alignment = 0;
+
+    OAConfig config(newdel, 4, 2, debug, padbytes, header, alignment);
+    oa = new ObjectAllocator(sizeof(Student), config);
+  }
+  catch (const OAException& e)
+  {
+    if (SHOW_EXCEPTIONS)
+      cout << e.what() << endl;
+    else
+      cout << "Exception thrown during construction in TestPadKernels."  << endl;
+    return;
+  }
+
+  try
+  {
+      // one byte past the end of one object and one before the start of another
+    void *objects[4];
+    for (unsigned i = 0; i < 4; i++)
+      objects[i] = oa->Allocate();
+    static_cast<unsigned char *>(objects[1])[sizeof(Student) + 39] = 0;
+    static_cast<unsigned char *>(objects[2])[-1] = 0;
+    cout << "Corrupted blocks with 40 pad bytes: " << oa->ValidatePages(DumpCallback2) << endl;
+    oa->Free(objects[0]);
+    oa->Free(objects[3]);
+  }
+  catch (const OAException& e)
+  {
+    if (SHOW_EXCEPTIONS)
+      cout << e.what() << endl;
+    else
+      cout << "Exception thrown during TestPadKernels."  << endl;
+  }
+
+  delete oa;
+}
+
+void PageAffinityRun(bool affine, bool debug)
+{
+  ObjectAllocator *oa;
+  try
+  {
+    bool newdel = false;
+    unsigned padbytes = debug ? 2 : 0;
+    OAConfig::HeaderBlockInfo header(debug ? OAConfig::hbBasic : OAConfig::hbNone);
+    unsigned alignment = 0;
+
+    OAConfig config(newdel, 8, 8, debug, padbytes, header, alignment, false, 0, 
+                    OAConfig::GrowthPolicy(), false, 0, affine);
+    oa = new ObjectAllocator(sizeof(Student), config);
+  }
+  catch (const OAException& e)
+  {
+    if (SHOW_EXCEPTIONS)
+      cout << e.what() << endl;
+    else
+      cout << "Exception thrown during construction in TestPageAffinity."  << endl;
+    return;
+  }
+
+  try
+  {
+    void *objects[64];
+    oa->AllocateBatch(objects, 64);
+
+      // frees a random half, like the shuffle in Stress
+    bool freed[64] = {false};
+    Digipen::Utils::srand(7, 11);
+    for (unsigned count = 0; count < 32; )
+    {
+      unsigned i = Digipen::Utils::rand() % 64;
+      if (!freed[i])
+      {
+        oa->Free(objects[i]);
+        freed[i] = true;
+        count++;
+      }
+    }
+
+    void *fresh[16];
+    for (unsigned i = 0; i < 16; i++)
+      fresh[i] = oa->Allocate();
+
+    OAOccupancy report = oa->GetOccupancy();
+    unsigned full = report.FullPages_;
+
+      // frees the survivors of the first round, keeping the 16 new objects
+    for (unsigned i = 0; i < 64; i++)
+      if (!freed[i])
+        oa->Free(objects[i]);
+    unsigned pagesFreed = oa->FreeEmptyPages();
+
+    cout << (affine ? "page-affine" : "global list") << (debug ? " (debug)" : "") 
+         << ": full pages after refilling " << full << ", pages freed " << pagesFreed 
+         << ", free list runs " << oa->GetOccupancy().FreeListRuns_ << endl;
+
+    oa->FreeBatch(fresh, 16);
+    cout << "  after freeing the rest: " << oa->GetStats().ObjectsInUse_ << " in use, " 
+         << oa->FreeEmptyPages() << " more pages freed" << endl;
+  }
+  catch (const OAException& e)
+  {
+    if (SHOW_EXCEPTIONS)
+      cout << e.what() << endl;
+    else
+      cout << "Exception thrown during TestPageAffinity."  << endl;
+  }
+
+  delete oa;
+}
+
+void TestPageAffinity(void)
+{
+  PageAffinityRun(false, false);
+  PageAffinityRun(true, false);
+  PageAffinityRun(true, true);
+}
+
+void TestBitmapBlocks(void)
+{
+  ObjectAllocator *oa;
+  try
+  {
+    bool newdel = false;
+    bool debug = false;
+    unsigned padbytes = 0;
+    OAConfig::HeaderBlockInfo header(OAConfig::hbNone);
+    unsigned alignment = 0;
+
+    OAConfig config(newdel, 100, 2, debug, padbytes, header, alignment, false, 0, 
+                    OAConfig::GrowthPolicy(), false, 0, false, true);
+    oa = new ObjectAllocator(sizeof(Student), config);
+  }
+  catch (const OAException& e)
+  {
+    if (SHOW_EXCEPTIONS)
+      cout << e.what() << endl;
+    else
+      cout << "Exception thrown during construction in TestBitmapBlocks."  << endl;
+    return;
+  }
+
+  try
+  {
+      // the first page is filled in address order, across the 64-bit words
+    std::vector<void *> objects;
+    bool ascending = true;
+    for (unsigned i = 0; i < 150; i++)
+    {
+      objects.push_back(oa->Allocate());
+      if (i && i < 100 && objects[i] <= objects[i - 1])
+        ascending = false;
+    }
+    cout << "Blocks handed out in address order: " << (ascending ? "yes" : "no") << endl;
+
+    for (unsigned i = 0; i < 150; i += 2)
+      oa->Free(objects[i]);
+    cout << "Leaks found without headers: " << oa->DumpMemoryInUse(DumpCallback2) 
+         << " (in use: " << oa->GetStats().ObjectsInUse_ << ")" << endl;
+
+    try
+    {
+      oa->Free(objects[70]);
+    }
+    catch (const OAException &e)
+    {
+      if (e.code() == OAException::E_MULTIPLE_FREE)
+        cout << "Double free caught without debugging: " << e.what() << endl;
+    }
+
+      // the fullest page gets the next block, the lowest free one on it
+    void *again = oa->Allocate();
+    cout << "Reuses the first page's lowest free block: " << (again == objects[0] ? "yes" : "no") << endl;
+    oa->Free(again);
+
+    for (unsigned i = 1; i < 150; i += 2)
+      oa->Free(objects[i]);
+    cout << "Leaks after freeing everything: " << oa->DumpMemoryInUse(DumpCallback2) 
+         << ", pages freed: " << oa->FreeEmptyPages() << endl;
+  }
+  catch (const OAException& e)
+  {
+    if (SHOW_EXCEPTIONS)
+      cout << e.what() << endl;
+    else
+      cout << "Exception thrown during TestBitmapBlocks."  << endl;
+  }
+
+  delete oa;
+}
+
+void ReleaseAllRun(const char *name, OAConfig::HBLOCK_TYPE type, bool lazy, bool affine, bool bitmap)
+{
+  ObjectAllocator *oa;
+  try
+  {
+    bool newdel = false;
+    bool debug = true;
+    unsigned padbytes = 2;
+    OAConfig::HeaderBlockInfo header(type);
+    unsigned alignment = 0;
+
+    OAConfig config(newdel, 8, 4, debug, padbytes, header, alignment, false, 0, 
+                    OAConfig::GrowthPolicy(), lazy, 0, affine, bitmap);
+    oa = new ObjectAllocator(sizeof(Student), config);
+  }
+  catch (const OAException& e)
+  {
+    if (SHOW_EXCEPTIONS)
+      cout << e.what() << endl;
+    else
+      cout << "Exception thrown during construction in TestReleaseAll."  << endl;
+    return;
+  }
+
+  try
+  {
+      // three requests of 20 objects each, cleaned up with one call
+    unsigned released = 0;
+    for (unsigned request = 0; request < 3; request++)
+    {
+      void *objects[20];
+      for (unsigned i = 0; i < 20; i++)
+        objects[i] = oa->Allocate("request");
+      if (request == 2)
+        oa->Free(objects[7]);
+      released += oa->ReleaseAll();
+    }
+
+    OAStats stats = oa->GetStats();
+    cout << name << ": released " << released << ", pages " << stats.PagesInUse_ 
+         << ", in use " << stats.ObjectsInUse_ << ", free " << stats.FreeObjects_
+         << ", allocations " << stats.Allocations_ << ", deallocations " << stats.Deallocations_ 
+         << ", leaks " << oa->DumpMemoryInUse(DumpCallback2) 
+         << ", corrupted " << oa->ValidatePages(DumpCallback2) << endl;
+
+      // a released block can't be freed again, and the pages fill up once more
+    void *objects[32];
+    oa->AllocateBatch(objects, 32);
+    try
+    {
+      oa->Free(objects[0]);
+      oa->Free(objects[0]);
+    }
+    catch (const OAException &e)
+    {
+      if (e.code() == OAException::E_MULTIPLE_FREE)
+        cout << "  double free after the release caught" << endl;
+    }
+    cout << "  after refilling: pages " << oa->GetStats().PagesInUse_ 
+         << ", leaks " << oa->DumpMemoryInUse(DumpCallback2) << endl;
+    oa->ReleaseAll();
+    cout << "  pages freed after the last release: " << oa->FreeEmptyPages() << endl;
+  }
+  catch (const OAException& e)
+  {
+    if (SHOW_EXCEPTIONS)
+      cout << e.what() << endl;
+    else
+      cout << "Exception thrown during TestReleaseAll."  << endl;
+  }
+
+  delete oa;
+}
+
+void TestReleaseAll(void)
+{
+  ReleaseAllRun("basic", OAConfig::hbBasic, false, false, false);
+  ReleaseAllRun("external", OAConfig::hbExternal, false, false, false);
+  ReleaseAllRun("lazy", OAConfig::hbExtended, true, false, false);
+  ReleaseAllRun("page-affine", OAConfig::hbBasic, false, true, false);
+  ReleaseAllRun("bitmap", OAConfig::hbNone, false, false, true);
+}
+
+void ReserveRun(const char *name, unsigned maxPages, bool lazy, bool lockFree, unsigned reserve)
+{
+  ObjectAllocator *oa;
+  try
+  {
+    bool newdel = false;
+    bool debug = false;
+    unsigned padbytes = 0;
+    OAConfig::HeaderBlockInfo header(OAConfig::hbNone);
+    unsigned alignment = 0;
+
+    OAConfig config(newdel, 8, maxPages, debug, padbytes, header, alignment, lockFree, 0, 
+                    OAConfig::GrowthPolicy(), lazy);
+    oa = new ObjectAllocator(sizeof(Student), config);
+  }
+  catch (const OAException& e)
+  {
+    if (SHOW_EXCEPTIONS)
+      cout << e.what() << endl;
+    else
+      cout << "Exception thrown during construction in TestReserve."  << endl;
+    return;
+  }
+
+  try
+  {
+    cout << name << ": ";
+    unsigned ready = oa->Reserve(reserve);
+    unsigned pages = oa->GetStats().PagesInUse_;
+    cout << "reserved " << ready << " on " << pages << " pages";
+
+    std::vector<void *> objects;
+    for (unsigned i = 0; i < reserve; i++)
+      objects.push_back(oa->Allocate());
+    cout << ", grew " << oa->GetStats().PagesInUse_ - pages << " pages for " << reserve << " objects" << endl;
+    for (unsigned i = 0; i < reserve; i++)
+      oa->Free(objects[i]);
+  }
+  catch (const OAException& e)
+  {
+    if (e.code() == OAException::E_NO_PAGES)
+      cout << e.what() << ", kept " << oa->GetStats().PagesInUse_ << " pages" << endl;
+    else if (SHOW_EXCEPTIONS)
+      cout << e.what() << endl;
+    else
+      cout << "Exception thrown during TestReserve."  << endl;
+  }
+
+  delete oa;
+}
+
+void TestReserve(void)
+{
+  ReserveRun("unlimited", 0, false, false, 1000);
+  ReserveRun("limited", 20, false, false, 100);
+  ReserveRun("lazy", 0, true, false, 100);
+  ReserveRun("lock-free", 0, false, true, 100);
+  ReserveRun("too many", 4, false, false, 100);
+
+    // a pool with no page limit grows as far as it's asked to
+  ObjectPool<Student, PoolConfig<4, 0> > pool;
+  std::vector<Student *> students;
+  for (unsigned i = 0; i < 40; i++)
+    students.push_back(pool.Allocate());
+  cout << "unlimited pool: " << pool.GetStats().PagesInUse_ << " pages" << endl;
+  for (unsigned i = 0; i < 40; i++)
+    pool.Free(students[i]);
+
+    // another thread keeps using the blocks while more pages are reserved
+  try
+  {
+    OAConfig config(false, 64, 0, true, 2, OAConfig::HeaderBlockInfo(OAConfig::hbBasic), 0, true);
+    ObjectAllocator shared(sizeof(Student), config);
+    std::thread worker(ChurnLockFree, &shared, 50);
+    shared.Reserve(64 * 40);
+    worker.join();
+    cout << "reserved while in use: " << (shared.GetStats().FreeObjects_ >= 64 * 40 ? "yes" : "no");
+    cout << ", corrupted blocks: " << shared.ValidatePages(DumpCallback2) << endl;
+  }
+  catch (const OAException& e)
+  {
+    if (SHOW_EXCEPTIONS)
+      cout << e.what() << endl;
+    else
+      cout << "Exception thrown during TestReserve."  << endl;
+  }
+}
+
+void TestNumaPools(void)
+{
+  NumaAllocator *na;
+  try
+  {
+    bool newdel = false;
+    bool debug = true;
+    unsigned padbytes = 2;
+    OAConfig::HeaderBlockInfo header(OAConfig::hbBasic);
+    unsigned alignment = 0;
+
+      // two pools whatever the machine has (binding to a missing node just fails)
+    OAConfig config(newdel, 4, 0, debug, padbytes, header, alignment);
+    na = new NumaAllocator(sizeof(Student), config, 2);
+  }
+  catch (const OAException& e)
+  {
+    if (SHOW_EXCEPTIONS)
+      cout << e.what() << endl;
+    else
+      cout << "Exception thrown during construction in TestNumaPools."  << endl;
+    return;
+  }
+
+  try
+  {
+    cout << "nodes: " << na->NodeCount() << endl;
+
+      // five blocks from each node's pool
+    void *objects[10];
+    for (unsigned i = 0; i < 10; i++)
+      objects[i] = na->AllocateOn(i % 2);
+    for (unsigned node = 0; node < 2; node++)
+    {
+      OAStats stats = na->GetNodeAllocator(node)->GetStats();
+      cout << "node " << node << ": " << stats.ObjectsInUse_ << " in use on " 
+           << stats.PagesInUse_ << " pages" << endl;
+    }
+    cout << "owners:";
+    for (unsigned i = 0; i < 10; i++)
+      cout << " " << na->NodeOf(objects[i]);
+    cout << endl;
+
+      // half of them belong to the other node, whichever one this thread is on
+    for (unsigned i = 0; i < 10; i++)
+      na->Free(objects[i]);
+    cout << "remote frees: " << na->RemoteFrees() << ", in use: " 
+         << na->GetNodeAllocator(0)->GetStats().ObjectsInUse_ << " and " 
+         << na->GetNodeAllocator(1)->GetStats().ObjectsInUse_ << endl;
+
+      // threads allocating locally and freeing each other's blocks
+    const unsigned threadCount = 4, perThread = 50;
+    std::vector<void *> blocks(threadCount * perThread);
+    std::vector<std::thread> threads;
+    for (unsigned t = 0; t < threadCount; t++)
+      threads.push_back(std::thread([&, t]() {
+        for (unsigned i = 0; i < perThread; i++)
+          blocks[t * perThread + i] = na->Allocate();
+      }));
+    for (unsigned t = 0; t < threadCount; t++)
+      threads[t].join();
+    threads.clear();
+    for (unsigned t = 0; t < threadCount; t++)
+      threads.push_back(std::thread([&, t]() {
+        for (unsigned i = 0; i < perThread; i++)
+          na->Free(blocks[((t + 1) % threadCount) * perThread + i]);
+      }));
+    for (unsigned t = 0; t < threadCount; t++)
+      threads[t].join();
+    OAStats total = na->GetStats();
+    cout << "threads: " << total.Allocations_ << " allocations, " << total.Deallocations_ 
+         << " frees, " << total.ObjectsInUse_ << " in use, leaks " 
+         << na->DumpMemoryInUse(DumpCallback2) << endl;
+
+      // a block no node owns is still rejected (with its pads intact, so
+      // it's the location check that catches it)
+    unsigned char stray[64];
+    std::memset(stray, ObjectAllocator::PAD_PATTERN, sizeof(stray));
+    try
+    {
+      na->Free(stray + 32);
+    }
+    catch (const OAException &e)
+    {
+      if (e.code() == OAException::E_BAD_BOUNDARY)
+        cout << "stray block rejected" << endl;
+    }
+    cout << "pages freed: " << na->FreeEmptyPages() << endl;
+  }
+  catch (const OAException& e)
+  {
+    if (SHOW_EXCEPTIONS)
+      cout << e.what() << endl;
+    else
+      cout << "Exception thrown during TestNumaPools."  << endl;
+  }
+
+  delete na;
+}
+
+void TestDeferredFrees(void)
+{
+  ObjectAllocator *oa;
+  try
+  {
+    bool newdel = false;
+    bool debug = true;
+    unsigned padbytes = 2;
+    OAConfig::HeaderBlockInfo header(OAConfig::hbBasic);
+    unsigned alignment = 0;
+
+    OAConfig config(newdel, 8, 0, debug, padbytes, header, alignment);
+    oa = new ObjectAllocator(sizeof(Student), config);
+  }
+  catch (const OAException& e)
+  {
+    if (SHOW_EXCEPTIONS)
+      cout << e.what() << endl;
+    else
+      cout << "Exception thrown during construction in TestDeferredFrees."  << endl;
+    return;
+  }
+
+  try
+  {
+      // three threads hand back 30 of the owner's 32 blocks at once
+    void *objects[32];
+    for (unsigned i = 0; i < 32; i++)
+      objects[i] = oa->Allocate();
+    std::vector<std::thread> threads;
+    for (unsigned t = 0; t < 3; t++)
+      threads.push_back(std::thread([&, t]() {
+        for (unsigned i = 0; i < 10; i++)
+          oa->FreeDeferred(objects[t * 10 + i]);
+      }));
+    for (unsigned t = 0; t < 3; t++)
+      threads[t].join();
+    cout << "queued: " << oa->GetStats().ObjectsInUse_ << " in use" << endl;
+    objects[0] = oa->Allocate();
+    OAStats stats = oa->GetStats();
+    cout << "after one Allocate: " << stats.ObjectsInUse_ << " in use, " << stats.FreeObjects_ 
+         << " free, " << stats.Deallocations_ << " frees, " << stats.PagesInUse_ << " pages" << endl;
+
+      // a corrupted block throws from the drain, the rest wait for the next one
+    for (unsigned i = 1; i < 4; i++)
+      objects[i] = oa->Allocate();
+    static_cast<unsigned char *>(objects[2])[-1] = 0;
+    for (unsigned i = 1; i < 4; i++)
+      oa->FreeDeferred(objects[i]);
+    try
+    {
+      oa->Allocate();
+    }
+    catch (const OAException &e)
+    {
+      if (e.code() == OAException::E_CORRUPTED_BLOCK)
+        cout << "corrupted block caught by the drain" << endl;
+    }
+    cout << "in use after the drain threw: " << oa->GetStats().ObjectsInUse_ << endl;
+    oa->Allocate();
+    cout << "in use after the next Allocate: " << oa->GetStats().ObjectsInUse_ << endl;
+  }
+  catch (const OAException& e)
+  {
+    if (SHOW_EXCEPTIONS)
+      cout << e.what() << endl;
+    else
+      cout << "Exception thrown during TestDeferredFrees."  << endl;
+  }
+
+  delete oa;
+
+    // remote frees wait on the owning node until it allocates
+  NumaAllocator *na;
+  try
+  {
+    OAConfig config(false, 4, 0, false, 0, OAConfig::HeaderBlockInfo(OAConfig::hbNone), 0);
+    na = new NumaAllocator(sizeof(Student), config, 2);
+  }
+  catch (const OAException& e)
+  {
+    if (SHOW_EXCEPTIONS)
+      cout << e.what() << endl;
+    else
+      cout << "Exception thrown during construction in TestDeferredFrees."  << endl;
+    return;
+  }
+
+  try
+  {
+    void *objects[10];
+    for (unsigned i = 0; i < 10; i++)
+      objects[i] = na->AllocateOn(i % 2);
+    for (unsigned i = 0; i < 10; i++)
+      na->Free(objects[i]);
+    cout << "numa: " << na->RemoteFrees() << " remote frees, " << na->GetStats().ObjectsInUse_ 
+         << " still queued" << endl;
+    na->AllocateOn(0);
+    na->AllocateOn(1);
+    cout << "numa after allocating on both: " << na->GetNodeAllocator(0)->GetStats().ObjectsInUse_ 
+         << " and " << na->GetNodeAllocator(1)->GetStats().ObjectsInUse_ << " in use" << endl;
+  }
+  catch (const OAException& e)
+  {
+    if (SHOW_EXCEPTIONS)
+      cout << e.what() << endl;
+    else
+      cout << "Exception thrown during TestDeferredFrees."  << endl;
+  }
+
+  delete na;
+}
+
+void TestMoveAndPoolAllocator(void)
+{
+  try
+  {
+    bool newdel = false;
+    bool debug = true;
+    unsigned padbytes = 2;
+    OAConfig::HeaderBlockInfo header(OAConfig::hbExternal);
+    unsigned alignment = 0;
+    OAConfig config(newdel, 4, 10, debug, padbytes, header, alignment);
+
+      // the pages and the blocks on them go with the move
+    ObjectAllocator first(sizeof(Student), config);
+    void *objects[6];
+    for (unsigned i = 0; i < 6; i++)
+      objects[i] = first.Allocate("moved");
+    ObjectAllocator second(std::move(first));
+    cout << "moved: " << second.GetStats().ObjectsInUse_ << " in use on " 
+         << second.GetStats().PagesInUse_ << " pages, left behind: " 
+         << first.GetStats().PagesInUse_ << " pages" << endl;
+    cout << "leaks: " << second.DumpMemoryInUse(DumpCallback2) << " and " 
+         << first.DumpMemoryInUse(DumpCallback2) << endl;
+    for (unsigned i = 0; i < 3; i++)
+      second.Free(objects[i]);
+
+      // assigning gives back the target's own pages first
+    ObjectAllocator third(sizeof(Student), config);
+    third.Allocate();
+    third = std::move(second);
+    for (unsigned i = 3; i < 6; i++)
+      third.Free(objects[i]);
+    cout << "assigned: " << third.GetStats().ObjectsInUse_ << " in use on " 
+         << third.GetStats().PagesInUse_ << " pages, " << third.GetStats().Deallocations_ 
+         << " frees" << endl;
+
+      // allocators can live in a vector that grows
+    std::vector<ObjectAllocator> allocators;
+    std::vector<void *> blocks;
+    for (unsigned i = 0; i < 5; i++)
+    {
+      allocators.push_back(ObjectAllocator(sizeof(Student), config));
+      blocks.push_back(allocators.back().Allocate());
+    }
+    unsigned inUse = 0;
+    for (unsigned i = 0; i < 5; i++)
+    {
+      allocators[i].Free(blocks[i]);
+      inUse += allocators[i].GetStats().ObjectsInUse_;
+    }
+    cout << "vector of " << allocators.size() << " allocators, " << inUse << " in use" << endl;
+  }
+  catch (const OAException& e)
+  {
+    if (SHOW_EXCEPTIONS)
+      cout << e.what() << endl;
+    else
+      cout << "Exception thrown during TestMoveAndPoolAllocator."  << endl;
+  }
+
+    // node-based containers on the shared pools
+  std::list<Student, PoolAllocator<Student> > students;
+  for (int i = 0; i < 100; i++)
+  {
+    Student student = {i, 3.5f, 2000 + i, i};
+    students.push_back(student);
+  }
+  students.remove_if([](const Student &student) { return student.Age % 2 != 0; });
+  long long years = 0;
+  for (std::list<Student, PoolAllocator<Student> >::const_iterator it = students.begin(); it != students.end(); ++it)
+    years += it->Year;
+  cout << "list: " << students.size() << " students, years " << years << endl;
+
+  typedef std::pair<const int, int> Entry;
+  std::map<int, int, std::less<int>, PoolAllocator<Entry> > squares;
+  std::unordered_map<int, int, std::hash<int>, std::equal_to<int>, PoolAllocator<Entry> > cubes;
+  for (int i = 0; i < 50; i++)
+  {
+    squares[i] = i * i;
+    cubes[i] = i * i * i;
+  }
+  for (int i = 0; i < 50; i += 5)
+  {
+    squares.erase(i);
+    cubes.erase(i);
+  }
+  long long total = 0;
+  for (int i = 0; i < 50; i++)
+    total += (squares.count(i) ? squares[i] : 0) + (cubes.count(i) ? cubes[i] : 0);
+  cout << "map: " << squares.size() << ", unordered_map: " << cubes.size() << ", total " 
+       << total << endl;
+
+    // single objects come from the pool for their size
+  PoolAllocator<Student> allocator;
+  unsigned before = PoolAllocator<Student>::Pool().GetStats().ObjectsInUse_;
+  Student *student = allocator.allocate(1);
+  cout << "pool: " << PoolAllocator<Student>::Pool().GetStats().ObjectsInUse_ - before 
+       << " more in use";
+  allocator.deallocate(student, 1);
+  cout << ", then " << PoolAllocator<Student>::Pool().GetStats().ObjectsInUse_ - before << endl;
+}
+
+  // churns 10000 handles, comparing the page bytes per object with ObjectAllocator
+void CompactRun(size_t size, unsigned objectsPerPage)
+{
+  try
+  {
+    OAConfig config(false, objectsPerPage, 0, false, 0, OAConfig::HeaderBlockInfo(), 0);
+    CompactAllocator ca(size, config);
+    ObjectAllocator oa(size < sizeof(void *) ? sizeof(void *) : size, config);
+
+    std::vector<void *> handles;
+    for (unsigned i = 0; i < 10000; i++)
+      handles.push_back(ca.Allocate());
+    for (unsigned i = 0; i < 10000; i += 2)
+      ca.Free(handles[i]);
+    for (unsigned i = 0; i < 10000; i += 2)
+      handles[i] = ca.Allocate();
+
+    OAStats compact = ca.GetStats();
+    OAStats normal = oa.GetStats();
+    cout << size << " bytes: block " << ca.BlockSize() << ", links " << ca.IndexBytes() 
+         << ", " << static_cast<double>(compact.PageSize_) / compact.PageCapacity_ << " vs " 
+         << static_cast<double>(normal.PageSize_) / normal.PageCapacity_ << " bytes per object, " 
+         << compact.PagesInUse_ << " pages, " << compact.ObjectsInUse_ << " in use" << endl;
+    for (unsigned i = 0; i < 10000; i++)
+      ca.Free(handles[i]);
+    cout << "  leaks " << ca.DumpMemoryInUse(DumpCallback2) << ", pages freed " 
+         << ca.FreeEmptyPages() << endl;
+  }
+  catch (const OAException& e)
+  {
+    if (SHOW_EXCEPTIONS)
+      cout << e.what() << endl;
+    else
+      cout << "Exception thrown during TestCompactAllocator."  << endl;
+  }
+}
+
+void TestCompactAllocator(void)
+{
+  CompactRun(1, 1024);
+  CompactRun(4, 1024);
+  CompactRun(6, 1024);
+  CompactRun(3, 70000);
+
+    // the debug checks
+  CompactAllocator *ca;
+  try
+  {
+    OAConfig config(false, 8, 2, true, 0, OAConfig::HeaderBlockInfo(), 0);
+    ca = new CompactAllocator(6, config);
+  }
+  catch (const OAException& e)
+  {
+    if (SHOW_EXCEPTIONS)
+      cout << e.what() << endl;
+    else
+      cout << "Exception thrown during construction in TestCompactAllocator."  << endl;
+    return;
+  }
+
+  std::vector<char *> handles;
+  try
+  {
+    for (unsigned i = 0; i < 17; i++)
+      handles.push_back(static_cast<char *>(ca->Allocate()));
+  }
+  catch (const OAException &e)
+  {
+    if (e.code() == OAException::E_NO_PAGES)
+      cout << "out of pages after " << handles.size() << " handles" << endl;
+  }
+
+  const OAException::OA_EXCEPTION expected[] = {OAException::E_MULTIPLE_FREE, 
+                                                OAException::E_BAD_BOUNDARY,
+                                                OAException::E_BAD_BOUNDARY};
+  const char *names[] = {"double free", "misaligned free", "stray free"};
+  char stray[8];
+  char *bad[] = {handles[3], handles[5] + 1, stray};
+  ca->Free(handles[3]);
+  for (unsigned i = 0; i < 3; i++)
+  {
+    try
+    {
+      ca->Free(bad[i]);
+      cout << names[i] << " not caught" << endl;
+    }
+    catch (const OAException &e)
+    {
+      cout << names[i] << (e.code() == expected[i] ? " caught" : " caught as the wrong error") << endl;
+    }
+  }
+  cout << "reused: " << (ca->Allocate() == handles[3] ? "yes" : "no") << ", in use " 
+       << ca->GetStats().ObjectsInUse_ << endl;
+  delete ca;
+}
+
+void TestTraceRecording(void)
+{
+  const char *path = "oa-test45.trace";
+  ObjectAllocator *oa;
+  try
+  {
+    bool newdel = false;
+    bool debug = true;
+    unsigned padbytes = 0;
+    OAConfig::HeaderBlockInfo header(OAConfig::hbExternal);
+    unsigned alignment = 0;
+
+    OAConfig config(newdel, 8, 0, debug, padbytes, header, alignment);
+    oa = new ObjectAllocator(sizeof(Student), config);
+  }
+  catch (const OAException& e)
+  {
+    if (SHOW_EXCEPTIONS)
+      cout << e.what() << endl;
+    else
+      cout << "Exception thrown during construction in TestTraceRecording."  << endl;
+    return;
+  }
+
+  try
+  {
+    OATraceWriter writer(path);
+    oa->SetTrace(&writer);
+
+      // singles, a batch, a bad free (not recorded) and a release
+    void *objects[20];
+    for (unsigned i = 0; i < 10; i++)
+      objects[i] = oa->Allocate(i % 2 ? "odd" : "even");
+    for (unsigned i = 0; i < 10; i += 3)
+      oa->Free(objects[i]);
+    oa->AllocateBatch(objects + 10, 10);
+    oa->FreeBatch(objects + 10, 5);
+    try
+    {
+      oa->Free(objects[0]);
+    }
+    catch (const OAException &)
+    {
+    }
+
+      // a batch that fails on its first block frees (and records) none of it
+    void *bad[2] = {objects[0], objects[17]};
+    try
+    {
+      oa->FreeBatch(bad, 2);
+    }
+    catch (const OAException &)
+    {
+    }
+    oa->ReleaseAll();
+    objects[0] = oa->Allocate("after");
+    oa->Free(objects[0]);
+    oa->SetTrace(0);
+    oa->Allocate();
+    writer.Flush();
+    cout << "recorded " << writer.Events() << " events" << endl;
+  }
+  catch (const OAException& e)
+  {
+    if (SHOW_EXCEPTIONS)
+      cout << e.what() << endl;
+    else
+      cout << "Exception thrown during TestTraceRecording."  << endl;
+  }
+  delete oa;
+
+    // reads it back
+  OATraceReader reader(path);
+  unsigned counts[5] = {0, 0, 0, 0, 0};
+  unsigned labelled = 0;
+  std::string labels;
+  OATraceEvent event;
+  while (reader.Next(event))
+  {
+    counts[event.type]++;
+    if (event.label)
+    {
+      labelled++;
+      if (labels.find(event.label) == std::string::npos)
+        labels += std::string(" ") + event.label;
+    }
+  }
+  cout << "object size " << reader.ObjectSize() << ": " << counts[teAllocate] << " allocations, " 
+       << counts[teFree] << " frees, " << counts[teReleaseAll] << " release, " << labelled 
+       << " labelled (" << labels.substr(1) << "), ids " << reader.IdCount() << endl;
+  std::remove(path);
+}
+
+//****************************************************************************************************
+//****************************************************************************************************
+void TestBasicHeaderBlocks()
+{
+  ObjectAllocator *oa = 0;
+
+  try 
+  {
+    bool newdel = false;
+    bool debug = true;
+    unsigned padbytes = 2;
+    OAConfig::HeaderBlockInfo header(OAConfig::hbBasic);
+    unsigned alignment = 1;
+
+    OAConfig config(newdel, 4, 2, debug, padbytes, header, alignment);
+    oa = new ObjectAllocator(sizeof(Student), config);
+  }
+  catch (const OAException& e)
+  {
+    if (SHOW_EXCEPTIONS)
+      cout << e.what() << endl;
+    else
+      cout << "Exception thrown during construction in TestBasicHeaderBlocks."  << endl;
+
+    return;
+  }
+
+  unsigned wrap = 32;
+  PrintConfig(oa);
+  PrintCounts(oa);
+  DumpPages(oa, wrap);
+
+  Student *pStudent1 = 0;
+  try
+  {
+    pStudent1 = static_cast<Student *>( oa->Allocate() );
+  }
+  catch (const OAException& e)
+  {
+    if (SHOW_EXCEPTIONS)
+      cout << e.what() << endl;
+    else
+      cout << "Exception thrown from Allocate in TestBasicHeaderBlocks."  << endl;
+  }
+  catch(...)
+  {
+    cout << "Unexpected exception thrown from Allocate in TestBasicHeaderBlocks."  << endl;
+  }
+
+  Student *pStudent2 = 0;
+  try
+  {
+    pStudent2 = static_cast<Student *>( oa->Allocate() );
+  }
+  catch (const OAException& e)
+  {
+    if (SHOW_EXCEPTIONS)
+      cout << e.what() << endl;
+    else
+      cout << "Exception thrown from Allocate in TestBasicHeaderBlocks."  << endl;
+  }
+  catch(...)
+  {
+    cout << "Unexpected exception thrown from Allocate in TestBasicHeaderBlocks."  << endl;
+  }
+
+  DumpPages(oa, wrap);
+
+  try
+  {
+    oa->Free(pStudent1);
+  }
+  catch (const OAException& e)
+  {
+    if (SHOW_EXCEPTIONS) 
+      cout << e.what() << endl;
+    else
+      cout << "Exception thrown from Free in TestBasicHeaderBlocks."  << endl;
+  }
+  catch(...)
+  {
+    cout << "Unexpected exception thrown from Free in TestBasicHeaderBlocks."  << endl;
+  }
+
+  DumpPages(oa, wrap);
+
+  try
+  {
+    oa->Free(pStudent2);
+  }
+  catch (const OAException& e)
+  {
+    if (SHOW_EXCEPTIONS) 
+      cout << e.what() << endl;
+    else
+      cout << "Exception thrown from Free in TestBasicHeaderBlocks."  << endl;
+  }
+  catch(...)
+  {
+    cout << "Unexpected exception thrown from Free in TestBasicHeaderBlocks."  << endl;
+  }
+
+  DumpPages(oa, wrap);
+
+  try
+  {
+    pStudent1 = static_cast<Student *>( oa->Allocate() );
+  }
+  catch (const OAException& e)
+  {
+    if (SHOW_EXCEPTIONS)
+      cout << e.what() << endl;
+    else
+      cout << "Exception thrown from Allocate in TestBasicHeaderBlocks."  << endl;
+  }
+  catch(...)
+  {
+    cout << "Unexpected exception thrown from Allocate in TestBasicHeaderBlocks."  << endl;
+  }
+
+  DumpPages(oa, wrap);
+  delete oa;
+}
+
+//****************************************************************************************************
+//****************************************************************************************************
+void TestExtendedHeaderBlocks(unsigned size)
+{
+  ObjectAllocator *oa = 0;
+  unsigned wrap = 32;
+
+  try 
+  {
+    bool newdel = false;
+    bool debug = true;
+    unsigned padbytes = 2;
+    OAConfig::HeaderBlockInfo header(OAConfig::hbExtended, size);
+    unsigned alignment = 0;
+
+    OAConfig config(newdel, 4, 2, debug, padbytes, header, alignment);
+    oa = new ObjectAllocator(sizeof(Student), config);
+  }
+  catch (const OAException& e)
+  {
+    if (SHOW_EXCEPTIONS)
+      cout << e.what() << endl;
+    else
+      cout << "Exception thrown during construction in TestExtendedHeaderBlocks."  << endl;
+
+    return;
+  }
+
+  PrintConfig(oa);
+  PrintCounts(oa);
+  DumpPages(oa, wrap);
+
+  ///////////////////////////////////////////////////////////////////////////////////////////////
+  ///////////////////////////////////////////////////////////////////////////////////////////////
+  Student *pStudent1 = 0;
+  try
+  {
+    pStudent1 = static_cast<Student *>( oa->Allocate() );
+  }
+  catch (const OAException& e)
+  {
+    if (SHOW_EXCEPTIONS)
+      cout << e.what() << endl;
+    else
+      cout << "Exception thrown from Allocate in TestExtendedHeaderBlocks."  << endl;
+  }
+  catch(...)
+  {
+    cout << "Unexpected exception thrown from Allocate in TestExtendedHeaderBlocks."  << endl;
+  }
+
+  DumpPages(oa, wrap);
+
+  ///////////////////////////////////////////////////////////////////////////////////////////////
+  ///////////////////////////////////////////////////////////////////////////////////////////////
+  Student *pStudent2 = 0;
+  try
+  {
+    pStudent2 = static_cast<Student *>( oa->Allocate() );
+  }
+  catch (const OAException& e)
+  {
+    if (SHOW_EXCEPTIONS)
+      cout << e.what() << endl;
+    else
+      cout << "Exception thrown from Allocate in TestExtendedHeaderBlocks."  << endl;
+  }
+  catch(...)
+  {
+    cout << "Unexpected exception thrown from Allocate in TestExtendedHeaderBlocks."  << endl;
+  }
+
+  DumpPages(oa, wrap);
+
+  ///////////////////////////////////////////////////////////////////////////////////////////////
+  ///////////////////////////////////////////////////////////////////////////////////////////////
+  try
+  {
+    oa->Free(pStudent1);
+  }
+  catch (const OAException& e)
+  {
+    if (SHOW_EXCEPTIONS) 
+      cout << e.what() << endl;
+    else
+      cout << "Exception thrown from Free in TestExtendedHeaderBlocks."  << endl;
+  }
+  catch(...)
+  {
+    cout << "Unexpected exception thrown from Free in TestExtendedHeaderBlocks."  << endl;
+  }
+
+  DumpPages(oa, wrap);
+
+  ///////////////////////////////////////////////////////////////////////////////////////////////
+  ///////////////////////////////////////////////////////////////////////////////////////////////
+  try
+  {
+    oa->Free(pStudent2);
+  }
+  catch (const OAException& e)
+  {
+    if (SHOW_EXCEPTIONS) 
+      cout << e.what() << endl;
+    else
+      cout << "Exception thrown from Free in TestExtendedHeaderBlocks."  << endl;
+  }
+  catch(...)
+  {
+    cout << "Unexpected exception thrown from Free in TestExtendedHeaderBlocks."  << endl;
+  }
+
+  DumpPages(oa, wrap);
+
+  ///////////////////////////////////////////////////////////////////////////////////////////////
+  ///////////////////////////////////////////////////////////////////////////////////////////////
+  try
+  {
+    pStudent1 = static_cast<Student *>( oa->Allocate() );
+    //pStudent2 = static_cast<Student *>( oa->Allocate() );
+  }
+  catch (const OAException& e)
+  {
+    if (SHOW_EXCEPTIONS)
+      cout << e.what() << endl;
+    else
+      cout << "Exception thrown from Allocate in TestExtendedHeaderBlocks."  << endl;
+  }
+  catch(...)
+  {
+    cout << "Unexpected exception thrown from Allocate in TestExtendedHeaderBlocks."  << endl;
+  }
+
+  DumpPages(oa, wrap);
+
+  ///////////////////////////////////////////////////////////////////////////////////////////////
+  ///////////////////////////////////////////////////////////////////////////////////////////////
+  try
+  {
+    for (int i = 0; i < 5; i++)
+    {
+      oa->Free(pStudent1);
+      pStudent1 = static_cast<Student *>( oa->Allocate() );
+    }
+  }
+  catch (const OAException& e)
+  {
+    if (SHOW_EXCEPTIONS)
+      cout << e.what() << endl;
+    else
+      cout << "Exception thrown from Allocate in TestExtendedHeaderBlocks."  << endl;
+  }
+  catch(...)
+  {
+    cout << "Unexpected exception thrown from Allocate in TestExtendedHeaderBlocks."  << endl;
+  }
+
+  DumpPages(oa, wrap);
+
+  ///////////////////////////////////////////////////////////////////////////////////////////////
+  ///////////////////////////////////////////////////////////////////////////////////////////////
+  try
+  {
+    pStudent2 = static_cast<Student *>( oa->Allocate() );
+  }
+  catch (const OAException& e)
+  {
+    if (SHOW_EXCEPTIONS)
+      cout << e.what() << endl;
+    else
+      cout << "Exception thrown from Allocate in TestExtendedHeaderBlocks."  << endl;
+  }
+  catch(...)
+  {
+    cout << "Unexpected exception thrown from Allocate in TestExtendedHeaderBlocks."  << endl;
+  }
+
+  DumpPages(oa, wrap);
+  delete oa;
+}
+
+//****************************************************************************************************
+//****************************************************************************************************
+void TestExternalHeaderBlocks()
+{
+  ObjectAllocator *oa = 0;
+  unsigned wrap = 32;
+
+  try 
+  {
+    bool newdel = false;
+    bool debug = true;
+    unsigned padbytes = 2;
+    OAConfig::HeaderBlockInfo header(OAConfig::hbExternal);
+    unsigned alignment = 0;
+
+    OAConfig config(newdel, 4, 1, debug, padbytes, header, alignment);
+    oa = new ObjectAllocator(sizeof(Student), config);
+  }
+  catch (const OAException& e)
+  {
+    if (SHOW_EXCEPTIONS)
+      cout << e.what() << endl;
+    else
+      cout << "Exception thrown during construction in TestExternalHeaderBlocks."  << endl;
+
+    return;
+  }
+
+  PrintConfig(oa);
+  PrintCounts(oa);
+  DumpPagesEx(oa, wrap);
+
+  Student *pStudent1 = 0;
+  try
+  {
+    pStudent1 = static_cast<Student *>( oa->Allocate("First student") );
+  }
+  catch (const OAException& e)
+  {
+    if (SHOW_EXCEPTIONS)
+      cout << e.what() << endl;
+    else
+      cout << "Exception thrown from Allocate in TestExternalHeaderBlocks."  << endl;
+  }
+  catch(...)
+  {
+    cout << "Unexpected exception thrown from Allocate in TestExternalHeaderBlocks."  << endl;
+  }
+
+  PrintCounts(oa);
+  DumpPagesEx(oa, wrap);
+
+  Student *pStudent2 = 0;
+  try
+  {
+    pStudent2 = static_cast<Student *>( oa->Allocate("Second student") );
+  }
+  catch (const OAException& e)
+  {
+    if (SHOW_EXCEPTIONS)
+      cout << e.what() << endl;
+    else
+      cout << "Exception thrown from Allocate in TestExternalHeaderBlocks."  << endl;
+  }
+  catch(...)
+  {
+    cout << "Unexpected exception thrown from Allocate in TestExternalHeaderBlocks."  << endl;
+  }
+
+  PrintCounts(oa);
+  DumpPagesEx(oa, wrap);
+
+  try
+  {
+    oa->Free(pStudent1);
+  }
+  catch (const OAException& e)
+  {
+    if (SHOW_EXCEPTIONS) 
+      cout << e.what() << endl;
+    else
+      cout << "Exception thrown from Free in TestExternalHeaderBlocks."  << endl;
+  }
+  catch(...)
+  {
+    cout << "Unexpected exception thrown from Free in TestExternalHeaderBlocks."  << endl;
+  }
+
+  PrintCounts(oa);
+  DumpPagesEx(oa, wrap);
+
+  try
+  {
+    oa->Free(pStudent2);
+  }
+  catch (const OAException& e)
+  {
+    if (SHOW_EXCEPTIONS) 
+      cout << e.what() << endl;
+    else
+      cout << "Exception thrown from Free in TestExternalHeaderBlocks."  << endl;
+  }
+  catch(...)
+  {
+    cout << "Unexpected exception thrown from Free in TestExternalHeaderBlocks."  << endl;
+  }
+
+  PrintCounts(oa);
+  DumpPagesEx(oa, wrap);
+
+  delete oa;
+}
+
+//****************************************************************************************************
+//****************************************************************************************************
+void DoStudents(unsigned padding, bool printall)
+{
+  try 
+  {
+    bool newdel = false;
+    bool debug = true;
+    unsigned padbytes = padding;
+    OAConfig::HeaderBlockInfo header(OAConfig::hbNone);
+    unsigned alignment = 0;
+
+    OAConfig config(newdel, 4, 2, debug, padbytes, header, alignment);
+    studentObjectMgr = new ObjectAllocator(sizeof(Student), config);
+  }
+  catch (const OAException& e)
+  {
+    if (SHOW_EXCEPTIONS)
+      cout << e.what() << endl;
+    else
+      cout << "Exception thrown during construction in DoStudents."  << endl;
+    return;
+  }
+  catch(...)
+  {
+    cout << "Unexpected exception thrown from constructor in DoStudents."  << endl;
+  }
+
+  unsigned wrap = 32;
+  PrintConfig(studentObjectMgr);
+  PrintCounts(studentObjectMgr);
+  DumpPages(studentObjectMgr, wrap);
+
+  Student *pStudent1 = 0, *pStudent2 = 0, *pStudent3 = 0;
+  try
+  {
+    pStudent1 = static_cast<Student *>( studentObjectMgr->Allocate() );
+    PrintCounts(studentObjectMgr);
+    if (printall)
+      DumpPages(studentObjectMgr, wrap);
+    pStudent2 = static_cast<Student *>( studentObjectMgr->Allocate() );
+    PrintCounts(studentObjectMgr);
+    if (printall)
+      DumpPages(studentObjectMgr, wrap);
+    pStudent3 = static_cast<Student *>( studentObjectMgr->Allocate() );
+    PrintCounts(studentObjectMgr);
+    if (printall)
+      DumpPages(studentObjectMgr, wrap);
+  }
+  catch (const OAException& e)
+  {
+    if (SHOW_EXCEPTIONS)
+      cout << e.what() << endl;
+    else
+      cout << "Exception thrown from Allocate in DoStudents."  << endl;
+  }
+  catch(...)
+  { 
+    cout << "Unexpected exception thrown from Allocate in DoStudents."  << endl;
+  }
+
+  Student *pStudent4[6];
+  for (int i = 0; i < 6; i++)
+  {
+    try
+    {
+      pStudent4[i] = static_cast<Student *>( studentObjectMgr->Allocate() );
+      if (pStudent4[i] == 0)
+        break;
+    }
+    catch (const OAException& e)
+    {
+    if (SHOW_EXCEPTIONS)
+      cout << e.what() << endl;
+    else
+    {
+      cout << "Exception thrown from Allocate (2) in DoStudents." << endl;
+
+      break;
+    }
+      
+    }
+    catch(...)
+    {
+      cout << "Unexpected exception thrown from Allocate (2) in DoStudents."  << endl;
+    }
+
+  }
+  PrintCounts(studentObjectMgr);
+  if (printall)
+    DumpPages(studentObjectMgr, wrap);
+
+  try
+  {
+    studentObjectMgr->Free(pStudent1);
+    PrintCounts(studentObjectMgr);
+    if (printall)
+      DumpPages(studentObjectMgr, wrap);
+    studentObjectMgr->Free(pStudent2);
+    PrintCounts(studentObjectMgr);
+    if (printall)
+      DumpPages(studentObjectMgr, wrap);
+    studentObjectMgr->Free(pStudent3);
+    PrintCounts(studentObjectMgr);
+    if (printall)
+      DumpPages(studentObjectMgr, wrap);
+  }
+  catch (const OAException& e)
+  {
+    if (SHOW_EXCEPTIONS)
+      cout << e.what() << endl;
+    else
+      cout << "Exception thrown from Free in DoStudents."  << endl;
+
+  }
+  catch(...)
+  {
+    cout << "Unexpected exception thrown from Free in DoStudents."  << endl;
+  }
+
+  cout << "Most students in use: " << studentObjectMgr->GetStats().MostObjects_ << endl;
+  delete studentObjectMgr;
+}
+
+//****************************************************************************************************
+//****************************************************************************************************
+void TestPadding(unsigned size)
+{
+  DoStudents(size);
+}
+
+//****************************************************************************************************
+//****************************************************************************************************
+void DoEmployees(void)
+{
+  try
+  {
+    bool newdel = false;
+    bool debug = true;
+    unsigned padbytes = 0;
+    OAConfig::HeaderBlockInfo header(OAConfig::hbNone);
+    unsigned alignment = 0;
+
+    OAConfig config(newdel, 4, 2, debug, padbytes, header, alignment);
+    employeeObjectMgr = new ObjectAllocator(sizeof(Employee), config);
+  }
+  catch (const OAException& e)
+  {
+    if (SHOW_EXCEPTIONS)
+      cout << e.what() << endl;
+    else
+      cout << "Exception thrown during construction in DoEmployees."  << endl;
+    return;
+  }
+  catch(...)
+  {
+    cout << "Unexpected exception thrown during constructor in DoEmployees."  << endl;
+  }
+
+  PrintConfig(employeeObjectMgr);
+  PrintCounts(employeeObjectMgr);
+
+  Employee *pEmployee1 = 0, *pEmployee2 = 0, *pEmployee3 = 0;
+  try
+  {
+    pEmployee1 = static_cast<Employee *>(employeeObjectMgr->Allocate());
+    PrintCounts(employeeObjectMgr);
+    pEmployee2 = static_cast<Employee *>(employeeObjectMgr->Allocate());
+    PrintCounts(employeeObjectMgr);
+    pEmployee3 = static_cast<Employee *>(employeeObjectMgr->Allocate());
+    PrintCounts(employeeObjectMgr);
+  }
+  catch (const OAException& e)
+  {
+    if (SHOW_EXCEPTIONS)
+      cout << e.what() << endl;
+    else
+      cout << "Exception thrown from Allocate in DoEmployees."  << endl;
+  }
+  catch(...)
+  {
+    cout << "Unexpected exception thrown from Allocate in DoEmployees."  << endl;
+  }
+
+  Employee *pEmployee4[7];
+  for (int i = 0; i < 7; i++)
+  {
+    try 
+    {
+        // Need to use /EHa, not /EHs
+        // ******************************************* Puts &employeeObjMgr in ecx
+      pEmployee4[i] = static_cast<Employee *>(employeeObjectMgr->Allocate());
+    }
+    catch (const OAException& e)
+    {
+      if (SHOW_EXCEPTIONS)
+      {
+          // ******************** Hoses the ecx register containing &employeeObjMgr
+        cout << e.what() << endl;
+      }
+      else
+        cout << "Exception thrown from Allocate (2) in DoEmployees."  << endl;
+
+      break;
+    }
+    catch(...)
+    {
+      cout << "Unexpected exception thrown from Allocate (2) in DoEmployees."  << endl;
+    }
+  }
+    // ************************* blindly pushes ecx as if it still has &empObjMgr
+  PrintCounts(employeeObjectMgr); 
+
+  try
+  {
+    employeeObjectMgr->Free(pEmployee1);
+    PrintCounts(employeeObjectMgr);
+    employeeObjectMgr->Free(pEmployee2);
+    PrintCounts(employeeObjectMgr);
+    employeeObjectMgr->Free(pEmployee3);
+    PrintCounts(employeeObjectMgr);
+  }
+  catch (const OAException& e)
+  {
+    if (SHOW_EXCEPTIONS)
+      cout << e.what() << endl;
+    else
+      cout << "Exception thrown from Free in DoEmployees."  << endl;
+  }
+  catch(...)
+  {
+    cout << "Unexpected exception thrown from Free in DoEmployees."  << endl;
+  }
+
+    // Free an object twice
+  try {
+    employeeObjectMgr->Free(pEmployee1);
+  }
+  catch (const OAException& e) 
+  {
+    if (SHOW_EXCEPTIONS)
+      cout << e.what() << endl;
+    else
+      cout << "Exception thrown from Free (Freeing object twice) in DoEmployees."  << endl;
+  }
+  catch(...)
+  {
+    cout << "Unexpected exception thrown from Free (Freeing object twice) in DoEmployees."  << endl;
+  }
+
+    // Free an invalid pointer (bad boundary condition)
+  try 
+  {
+    employeeObjectMgr->Free(reinterpret_cast<char *>(pEmployee4[0]) + 4);
+  }
+  catch (const OAException& e) 
+  {
+    if (SHOW_EXCEPTIONS)
+      cout << e.what() << endl;
+    else
+      cout << "Exception thrown from Free (Freeing address on bad boundary) in DoEmployees."  << endl;
+  }
+  catch(...)
+  {
+    cout << "Unexpected exception thrown from Free (Freeing address on bad boundary) in DoEmployees."  << endl;
+  }
+
+  cout << "Most employees in use: " << employeeObjectMgr->GetStats().MostObjects_<< endl;
+  delete employeeObjectMgr;
+}
+
+//****************************************************************************************************
+//****************************************************************************************************
+void DisableOA(void)
+{
+  try 
+  {
+    bool newdel = true;
+    bool debug = false;
+    unsigned padbytes = 0;
+    OAConfig::HeaderBlockInfo header(OAConfig::hbNone);
+    unsigned alignment = 0;
+
+    OAConfig config(newdel, 4, 2, debug, padbytes, header, alignment);
+    studentObjectMgr = new ObjectAllocator(sizeof(Student), config);
+  }
+  catch (const OAException& e)
+  {
+    if (SHOW_EXCEPTIONS)
+      cout << e.what() << endl;
+    else
+      cout << "Exception thrown during constructor in DisableOA."  << endl;
+    return;
+  }
+  catch(...)
+  {
+    cout << "Unexpected exception thrown during constructor in DisableOA."  << endl;
+  }
+
+  PrintConfig(studentObjectMgr);
+  PrintCounts2(studentObjectMgr);
+
+  Student *pStudent1 = 0, *pStudent2 = 0, *pStudent3 = 0;
+  try
+  {
+    pStudent1 = static_cast<Student *>( studentObjectMgr->Allocate() );
+    PrintCounts2(studentObjectMgr);
+    pStudent2 = static_cast<Student *>( studentObjectMgr->Allocate() );
+    PrintCounts2(studentObjectMgr);
+    pStudent3 = static_cast<Student *>( studentObjectMgr->Allocate() );
+    PrintCounts2(studentObjectMgr);
+  }
+  catch (const OAException& e)
+  {
+    if (SHOW_EXCEPTIONS)
+      cout << e.what() << endl;
+    else
+      cout << "Exception thrown from Allocate in DisableOA."  << endl;
+  }
+  catch(...)
+  {
+    cout << "Unexpected exception thrown from Allocate in DisableOA."  << endl;
+  }
+
+  Student *pStudent4[6];
+  for (int i = 0; i < 6; i++)
+  {
+    try
+    {
+      pStudent4[i] = static_cast<Student *>( studentObjectMgr->Allocate() );
+    }
+    catch (const OAException& e)
+    {
+      if (SHOW_EXCEPTIONS)
+        cout << e.what() << endl;
+      else
+        cout << "Exception thrown from Allocate (2) in DisableOA."  << endl;
+      break;
+    }
+    catch(...)
+    {
+      cout << "Unexpected exception thrown from Allocate (2) in DisableOA."  << endl;
+    }
+
+  }
+  PrintCounts2(studentObjectMgr);
+
+  try
+  {
+    studentObjectMgr->Free(pStudent1);
+    PrintCounts2(studentObjectMgr);
+    studentObjectMgr->Free(pStudent2);
+    PrintCounts2(studentObjectMgr);
+    studentObjectMgr->Free(pStudent3);
+    PrintCounts2(studentObjectMgr);
+  }
+  catch (const OAException& e)
+  {
+    if (SHOW_EXCEPTIONS)
+      cout << e.what() << endl;
+    else
+      cout << "Exception thrown from Free in DisableOA."  << endl;
+  }
+  catch(...)
+  {
+    cout << "Unexpected exception thrown from Free in DIsableOA."  << endl;
+  }
+
+  for (int i = 0; i < 6; i++)
+  {
+    try
+    {
+      studentObjectMgr->Free(pStudent4[i]);
+    }
+    catch (const OAException& e)
+    {
+      if (SHOW_EXCEPTIONS)
+        cout << e.what() << endl;
+      else
+        cout << "Exception thrown from Free in DisableOA."  << endl;
+      break;
+    }
+    catch(...)
+    {
+      cout << "Unexpected exception thrown from Free in DisableOA."  << endl;
+    }
+
+  }
+  PrintCounts2(studentObjectMgr);
+
+  cout << "Most students in use: " << studentObjectMgr->GetStats().MostObjects_ << endl;
+  delete studentObjectMgr;
+}
+
+//****************************************************************************************************
+//****************************************************************************************************
+void TestCorruption(void)
+{
+  ObjectAllocator *oa = 0;
+  unsigned char *p;
+  unsigned padbytes = 8;
+  unsigned i;
+  unsigned wrap = 32;
+  Student *pStudent1, *pStudent2 = 0;
+  try 
+  {
+    bool newdel = false;
+    bool debug = true;
+    //unsigned header = 0;
+    //OAConfig::HBLOCK_TYPE header = OAConfig::hbNone;
+    OAConfig::HeaderBlockInfo header(OAConfig::hbBasic);
+    unsigned alignment = 0;
+
+    OAConfig config(newdel, 4, 2, debug, padbytes, header, alignment);
+    //OAConfig config(false, 4, 2, true, padbytes);
+    oa = new ObjectAllocator(sizeof(Student), config);
+    pStudent1 = static_cast<Student *>( oa->Allocate() );
+    pStudent2 = static_cast<Student *>( oa->Allocate() );
+    
+    PrintConfig(oa);
+    PrintCounts(oa);
+    DumpPages(oa, wrap);
+  }
+  catch (const OAException& e)
+  {
+    if (SHOW_EXCEPTIONS)
+      cout << e.what() << endl;
+    else
+      cout << "Exception thrown during construction/allocation in TestCorruption."  << endl;
+
+    return;
+  }
+
+    // corrupt left pad bytes
+  p = const_cast<unsigned char*>(reinterpret_cast<const unsigned char *>(pStudent1)) - padbytes;
+  for (i = 0; i < padbytes - 2; i++)
+    *p++ = 0xFF;
+
+    // corrupt right pad bytes
+  p = const_cast<unsigned char*>(reinterpret_cast<const unsigned char *>(pStudent2)) + sizeof(Student);
+  for (i = 0; i < padbytes - 2; i++)
+    *p++ = 0xEE;
+
+  try
+  {
+    oa->Free(pStudent1);
+  }
+  catch (const OAException& e)
+  {
+    if (SHOW_EXCEPTIONS)
+      cout << e.what() << endl;
+    else
+    {
+      if (e.code() == e.E_CORRUPTED_BLOCK)
+        cout << "Exception thrown from Free: E_CORRUPTED_BLOCK on left"  << endl;
+      else
+        cout << "****** Unknown OAException thrown from Free in TestCorruption. ******"  << endl;
+    }
+  }
+  catch(...)
+  {
+    cout << "Unexpected exception thrown from Free in TestCorruption."  << endl;
+  }
+
+  try
+  {
+    oa->Free(pStudent2);
+  }
+  catch (const OAException& e)
+  {
+    if (SHOW_EXCEPTIONS)
+      cout << e.what() << endl;
+    else
+    {
+      if (e.code() == e.E_CORRUPTED_BLOCK)
+        cout << "Exception thrown from Free: E_CORRUPTED_BLOCK on right"  << endl;
+      else
+        cout << "****** Unknown OAException thrown from Free (2) in TestCorruption. ******"  << endl;
+    }
+  }
+  catch(...)
+  {
+    cout << "Unexpected exception thrown from Free (2) in TestCorruption."  << endl;
+  }
+
+  delete oa;
+}
+
+//****************************************************************************************************
+//****************************************************************************************************
+void TestLeak(void)
+{
+  unsigned count = 0;
+  Employee **pEmps = 0;
+
+  try
+  {
+    bool newdel = false;
+    bool debug = true;
+    unsigned padbytes = 0;
+    OAConfig::HeaderBlockInfo header(OAConfig::hbBasic);
+    unsigned alignment = 0;
+
+    OAConfig config(newdel, 4, 8, debug, padbytes, header, alignment);
+    employeeObjectMgr = new ObjectAllocator(sizeof(Employee), config);
+  }
+  catch (const OAException& e)
+  {
+    if (SHOW_EXCEPTIONS)
+      cout << e.what() << endl;
+    else
+      cout << "Exception thrown during constructor in TestLeak."  << endl;
+
+    return;
+  }
+  catch(...)
+  {
+    cout << "Unexpected exception thrown during constructor in TestLeak."  << endl;
+  }
+
+  PrintConfig(employeeObjectMgr);
+  PrintCounts(employeeObjectMgr);
+
+  count = employeeObjectMgr->GetConfig().MaxPages_ * employeeObjectMgr->GetConfig().ObjectsPerPage_;
+  pEmps = new Employee *[count];
+
+  for (unsigned i = 0; i < count; i++)
+  {
+    try 
+    {
+      pEmps[i] = static_cast<Employee *>(employeeObjectMgr->Allocate());
+      FillEmployee(*pEmps[i]);
+    }
+    catch (const OAException& e)
+    {
+      if (SHOW_EXCEPTIONS)
+        cout << e.what() << endl;
+      else
+        cout << "Exception thrown from Allocate in TestLeak."  << endl;
+
+      break;
+    }
+    catch(...)
+    {
+      cout << "Unexpected exception thrown from Allocate in TestLeak."  << endl;
+    }
+  }
+  PrintCounts(employeeObjectMgr); 
+
+  try
+  {
+    for (unsigned i = 0; i < count; i += 2)
+      employeeObjectMgr->Free(pEmps[i]);
+  }
+  catch (const OAException& e)
+  {
+    if (SHOW_EXCEPTIONS)
+      cout << e.what() << endl;
+    else
+      cout << "Exception thrown from Free in TestLeak."  << endl;
+  }
+  catch(...)
+  {
+    cout << "Unexpected exception thrown from Free in TestLeak."  << endl;
+  }
+
+  PrintCounts(employeeObjectMgr);
+
+  cout << "Most employees in use: " << employeeObjectMgr->GetStats().MostObjects_<< endl;
+
+  cout << "\nChecking for leaks...\n";
+  CheckAndDumpLeaks(employeeObjectMgr);
+
+  try
+  {
+    for (unsigned i = 1; i < count; i += 2)
+      employeeObjectMgr->Free(pEmps[i]);
+  }
+  catch (const OAException& e)
+  {
+    if (SHOW_EXCEPTIONS)
+      cout << e.what() << endl;
+    else
+      cout << "Exception thrown from Free (2) in TestLeak."  << endl;
+  }
+  catch(...)
+  {
+    cout << "Unexpected exception thrown from Free (2) in TestLeak."  << endl;
+  }
+
+  cout << "\nChecking for leaks...\n";
+  CheckAndDumpLeaks(employeeObjectMgr);
+
+  delete employeeObjectMgr;
+  delete [] pEmps;
+}
+
+
+//****************************************************************************************************
+//****************************************************************************************************
+void TestValidate(void)
+{
+  ObjectAllocator *oa = 0;
+  unsigned char *p;
+  unsigned i, padbytes = 8;
+  unsigned wrap = 32;
+  Student *pStudent1 = 0, *pStudent2 = 0, *pStudent7 = 0;
+  try 
+  {
+    bool newdel = false;
+    bool debug = true;
+    OAConfig::HeaderBlockInfo header(OAConfig::hbBasic);
+    unsigned alignment = 0;
+
+    OAConfig config(newdel, 4, 2, debug, padbytes, header, alignment);
+    oa = new ObjectAllocator(sizeof(Student), config);
+
+    pStudent1 = static_cast<Student *>( oa->Allocate() );
+    pStudent2 = static_cast<Student *>( oa->Allocate() );
+    oa->Allocate(); // 3
+    oa->Allocate(); // 4
+    oa->Allocate(); // 5
+    oa->Allocate(); // 6
+    pStudent7 = static_cast<Student *>( oa->Allocate() );
+    PrintConfig(oa);
+    PrintCounts(oa);
+    DumpPages(oa, wrap);
+  }
+  catch (const OAException& e)
+  {
+    if (SHOW_EXCEPTIONS)
+      cout << e.what() << endl;
+    else
+      cout << "Exception thrown during construction/allocation in TestValidate."  << endl;
+    return;
+  }
+
+  try
+  {
+      // Validate a good heap
+    unsigned count = oa->ValidatePages(ValidateCallback);
+    cout << "Number of corruptions: " << count << endl << endl;
+  }
+  catch (const OAException& e)
+  {
+    if (SHOW_EXCEPTIONS)
+      cout << e.what() << endl;
+    else
+    {
+      if (e.code() == e.E_CORRUPTED_BLOCK)
+        cout << "Exception thrown from Free: E_CORRUPTED_BLOCK on left"  << endl;
+      else
+        cout << "****** Unknown OAException thrown from Free in TestValidate. ******"  << endl;
+    }
+  }
+  catch(...)
+  {
+    cout << "Unexpected exception thrown from Free in TestValidate."  << endl;
+  }
+
+    // corrupt left pad bytes of 1
+  p = const_cast<unsigned char*>(reinterpret_cast<const unsigned char *>(pStudent1)) - padbytes;
+  for (i = 0; i < padbytes - 2; i++)
+    *p++ = 0xFF;
+
+    // corrupt right pad bytes of 2
+  p = const_cast<unsigned char*>(reinterpret_cast<const unsigned char *>(pStudent2)) + sizeof(Student);
+  for (i = 0; i < padbytes - 2; i++)
+    *p++ = 0xEE;
+
+  PrintCounts(oa);
+  DumpPages(oa, wrap);
+
+  try
+  {
+      // Validate a corrupted heap
+    unsigned count = oa->ValidatePages(ValidateCallback);
+    cout << "Number of corruptions: " << count << endl << endl;
+  }
+  catch (const OAException& e)
+  {
+    if (SHOW_EXCEPTIONS)
+      cout << e.what() << endl;
+    else
+    {
+      if (e.code() == e.E_CORRUPTED_BLOCK)
+        cout << "Exception thrown from Free: E_CORRUPTED_BLOCK on left"  << endl;
+      else
+        cout << "****** Unknown OAException thrown from Free (2) in TestValidate. ******"  << endl;
+    }
+  }
+  catch(...)
+  {
+    cout << "Unexpected exception thrown from Free (2) in TestValidate."  << endl;
+  }
+
+    // corrupt left pad bytes of 7
+  p = const_cast<unsigned char*>(reinterpret_cast<const unsigned char *>(pStudent7)) - padbytes;
+  for (i = 0; i < padbytes - 2; i++)
+    *p++ = 0xFF;
+
+    // corrupt right pad bytes of 7
+  p = const_cast<unsigned char*>(reinterpret_cast<const unsigned char *>(pStudent7)) + sizeof(Student);
+  for (i = 0; i < padbytes - 2; i++)
+    *p++ = 0xEE;
+
+  PrintCounts(oa);
+  DumpPages(oa, wrap);
+
+  try
+  {
+      // Validate a corrupted heap
+    unsigned count = oa->ValidatePages(ValidateCallback);
+    cout << "Number of corruptions: " << count << endl << endl;
+  }
+  catch (const OAException& e)
+  {
+    if (SHOW_EXCEPTIONS)
+      cout << e.what() << endl;
+    else
+    {
+      if (e.code() == e.E_CORRUPTED_BLOCK)
+        cout << "Exception thrown from Free: E_CORRUPTED_BLOCK on left"  << endl;
+      else
+        cout << "****** Unknown OAException thrown from Free (3) in TestValidate. ******"  << endl;
+    }
+  }
+  catch(...)
+  {
+    cout << "Unexpected exception thrown from Free (3) in TestValidate."  << endl;
+  }
+  if (oa)
+    delete oa;
+}
+
+//****************************************************************************************************
+//****************************************************************************************************
+void TestAlignment(void)
+{
+  if (!ObjectAllocator::ImplementedExtraCredit())
+    return;
+
+  ObjectAllocator *oa = 0;
+  try 
+  {
+    unsigned wrap = 32;
+
+    bool newdel = false;
+    bool debug = true;
+    unsigned padbytes = 2;
+    //unsigned header = 0;
+    OAConfig::HeaderBlockInfo header(OAConfig::hbBasic);
+    unsigned alignment = 8;
+
+    OAConfig config(newdel, 3, 2, debug, padbytes, header, alignment);
+
+    if (!oa)
+      oa = new ObjectAllocator(sizeof(Student), config);
+
+    PrintConfig(oa);
+    PrintCounts(oa);
+    DumpPages(oa, wrap);
+
+    oa->Allocate(); // 1
+    oa->Allocate(); // 2
+    oa->Allocate(); // 3
+    oa->Allocate(); // 4
+    oa->Allocate(); // 5
+    oa->Allocate(); // 6
+
+    PrintCounts(oa);
+    DumpPages(oa, wrap);
+  }
+  catch (const OAException& e)
+  {
+    if (SHOW_EXCEPTIONS)
+      cout << e.what() << endl;
+    else
+      cout << "Exception thrown during construction/allocation in TestAlignment."  << endl;
+    return;
+  }
+  if (oa)
+    delete oa;
+}
+
+
+void PrintCounts(const ObjectAllocator *nm)
+{
+  OAStats stats = nm->GetStats();
+  cout << "Pages in use: " << stats.PagesInUse_;
+  cout << ", Objects in use: " << stats.ObjectsInUse_;
+  cout << ", Available objects: " << stats.FreeObjects_;
+  cout << ", Allocs: " << stats.Allocations_;
+  cout << ", Frees: " << stats.Deallocations_ << endl;
+}
+
+void PrintCounts2(const ObjectAllocator *nm)
+{
+  OAStats stats = nm->GetStats();
+  cout << "Allocs: " << stats.Allocations_;
+  cout << ", Frees: " << stats.Deallocations_ << endl;
+}
+
+void PrintConfig(const ObjectAllocator *oa)
+{
+  cout << "Object size = " << oa->GetStats().ObjectSize_;
+  cout << ", Page size = " << oa->GetStats().PageSize_;
+  cout << ", Pad bytes = " << oa->GetConfig().PadBytes_;
+  cout << ", ObjectsPerPage = " << oa->GetConfig().ObjectsPerPage_;
+  cout << ", MaxPages = " << oa->GetConfig().MaxPages_;
+  cout << ", MaxObjects = " <<  oa->GetConfig().ObjectsPerPage_ * oa->GetConfig().MaxPages_;
+  cout << endl;
+  cout << "Alignment = " << oa->GetConfig().Alignment_;
+  cout << ", LeftAlign = " << oa->GetConfig().LeftAlignSize_;
+  cout << ", InterAlign = " << oa->GetConfig().InterAlignSize_;
+  cout << ", HeaderBlocks = ";
+  if (oa->GetConfig().HBlockInfo_.type_ == OAConfig::hbNone)
+    cout << "None";
+  else if (oa->GetConfig().HBlockInfo_.type_ == OAConfig::hbBasic)
+    cout << "Basic";
+  else if (oa->GetConfig().HBlockInfo_.type_ == OAConfig::hbExtended)
+    cout << "Extended";
+  else if (oa->GetConfig().HBlockInfo_.type_ == OAConfig::hbExternal)
+    cout << "External";
+  cout << ", Header size = " << oa->GetConfig().HBlockInfo_.size_;
+  cout << endl;
+}
+
+void DumpPages(const ObjectAllocator *nm, unsigned width)
+{
+  const unsigned char *pages = static_cast<const unsigned char *>(nm->GetPageList());
+  const unsigned char *realpage = pages;
+  
+  size_t header_size = nm->GetConfig().HBlockInfo_.size_;
+
+  while (pages)
+  {
+    unsigned count = 0;
+
+    if (SHOWREAL)
+      printf("%p\n", pages);
+    else
+      printf("XXXXXXXX\n");
+
+          // print column header
+    for (unsigned j = 0; j < width; j++)
+      printf(" %2i", j);
+    printf("\n");
+
+      // "Next page" pointer in the page
+    if (SHOWREAL)
+    {
+      for (unsigned i = 0; i < sizeof(void *); i++, count++)
+        printf(" %02X", *pages++);
+    }
+    else
+    {
+      for (unsigned j = 0; j < sizeof(void *); pages++, count++, j++)
+        printf(" %s", "XX");
+    }
+
+
+      // Left leading alignment bytes
+    if (nm->GetConfig().Alignment_ > 1)
+    {
+        // leading alignment block (if any)
+      for (unsigned j = 0; j < nm->GetConfig().LeftAlignSize_; count++, j++)
+      {
+        if (count >= width)
+        {
+          printf("\n");
+          count = 0;
+        }
+        printf(" %02X", *pages++);
+      }
+    }
+
+      // Dump each object and its associated info
+    for (unsigned int i = 0; i < nm->GetConfig().ObjectsPerPage_ ; i++)
+    {
+        // inter-block alignment (not on first block)
+      if (i > 0)
+      {
+        for (unsigned j = 0; j < nm->GetConfig().InterAlignSize_; count++, j++)
+        {
+          if (count >= width)
+          {
+            printf("\n");
+            count = 0;
+          }
+          printf(" %02X", *pages++);
+        }
+      }
+
+        // header block bytes
+      for (unsigned j = 0; j < header_size; count++, j++)
+      {
+        if (count >= width)
+        {
+          printf("\n");
+          count = 0;
+        }
+        printf(" %02X", *pages++);
+      }
+
+        // left padding
+      for (unsigned j = 0; j < nm->GetConfig().PadBytes_; count++, j++)
+      {
+        if (count >= width)
+        {
+          printf("\n");
+          count = 0;
+        }
+        printf(" %02X", *pages++);
+      }
+
+        // possible next pointer (zero it out)
+      for (unsigned j = 0; j < sizeof(void *); count++, pages++, j++)
+      {
+        if (count >= width)
+        {
+          printf("\n");
+          count = 0;
+        }
+        if (SHOWREAL)
+          printf(" %02X", *pages);
+        else
+          printf(" %s", "XX");
+      }
+        
+        // remaining bytes
+      for (unsigned j = 0; j < nm->GetStats().ObjectSize_ - sizeof(void *); count++, j++)
+      {
+        if (count >= width)
+        {
+          printf("\n");
+          count = 0;
+        }
+        printf(" %02X", *pages++);
+      }
+
+        // right pad bytes
+      for (unsigned j = 0; j < nm->GetConfig().PadBytes_; count++, j++)
+      {
+        if (count >= width)
+        {
+          printf("\n");
+          count = 0;
+        }
+        printf(" %02X", *pages++);
+      }
+
+    }
+    printf("\n\n");
+
+    pages = reinterpret_cast<const unsigned char *>((reinterpret_cast<const GenericObject *>(realpage))->Next);
+    realpage = pages;
+  }
+}
+
+void DumpExternalHeaders(const ObjectAllocator *oa, const unsigned char *p)
+{
+  unsigned char *page = const_cast<unsigned char *>(p);
+
+  unsigned padbytes = oa->GetConfig().PadBytes_;  
+  size_t header_size = oa->GetConfig().HBlockInfo_.size_;
+  unsigned leftalign = oa->GetConfig().LeftAlignSize_;
+  unsigned interalign = oa->GetConfig().InterAlignSize_;
+  unsigned count = oa->GetConfig().ObjectsPerPage_;
+  size_t offset = padbytes * 2 + header_size + interalign + oa->GetStats().ObjectSize_;
+
+  page += sizeof(void *); // the 'next' pointer
+  page += leftalign;      // the left alignment bytes (if any)
+
+    // We're now pointing at the beginning of the header block
+
+  MemBlockInfo *pm = reinterpret_cast<MemBlockInfo *>(*reinterpret_cast<MemBlockInfo **>(page));
+  cout << "  Label: " << (pm && pm->label ? pm->label : "") << std::endl;
+  cout << " In use: " << (pm ? pm->in_use : 0) << std::endl;
+  cout << "Alloc #: " << (pm && pm->in_use ? pm->alloc_num : 0) << std::endl;
+
+  for (unsigned i = 1; i < count; i++)
+  {
+    page += offset;
+    MemBlockInfo *pm = reinterpret_cast<MemBlockInfo *>(*reinterpret_cast<MemBlockInfo **>(page));
+    cout << "  Label: " << (pm && pm->label ? pm->label : "") << std::endl;
+    cout << " In use: " << (pm ? pm->in_use : 0) << std::endl;
+    cout << "Alloc #: " << (pm && pm->in_use ? pm->alloc_num : 0) << std::endl;
+  }
+}
+
+void DumpPagesEx(const ObjectAllocator *nm, unsigned width)
+{
+  const unsigned char *pages = static_cast<const unsigned char *>(nm->GetPageList());
+  const unsigned char *realpage = pages;
+  
+  size_t header_size = nm->GetConfig().HBlockInfo_.size_;
+
+  while (pages)
+  {
+    unsigned count = 0;
+
+    if (SHOWREAL)
+      printf("%p\n", pages);
+    else
+      printf("XXXXXXXX\n");
+
+          // print column header
+    for (unsigned j = 0; j < width; j++)
+      printf(" %2i", j);
+    printf("\n");
+
+    if (SHOWREAL)
+    {
+      for (unsigned i = 0; i < sizeof(void *); i++, count++)
+        printf(" %02X", *pages++);
+    }
+    else
+    {
+      for (unsigned j = 0; j < sizeof(void *); pages++, count++, j++)
+        printf(" %s", "XX");
+    }
+
+
+      // Left leading alignment bytes
+    if (nm->GetConfig().Alignment_ > 1)
+    {
+        // leading alignment block (if any)
+      for (unsigned j = 0; j < nm->GetConfig().LeftAlignSize_; count++, j++)
+      {
+        if (count >= width)
+        {
+          printf("\n");
+          count = 0;
+        }
+        printf(" %02X", *pages++);
+      }
+    }
+
+    for (unsigned int i = 0; i < nm->GetConfig().ObjectsPerPage_ ; i++)
+    {
+        // inter-block alignment (not on first block)
+      if (i > 0)
+      {
+        for (unsigned j = 0; j < nm->GetConfig().InterAlignSize_; count++, j++)
+        {
+          if (count >= width)
+          {
+            printf("\n");
+            count = 0;
+          }
+          printf(" %02X", *pages++);
+        }
+      }
+
+        // header block bytes
+      for (unsigned j = 0; j < header_size; count++, j++, pages++)
+      {
+        if (count >= width)
+        {
+          printf("\n");
+          count = 0;
+        }
+        /*////////////////////======================================================================
+        In external mode, pointer address is embedded into the header memory
+        /////////////////////=======================================================================*/
+        if (SHOWREAL)
+          printf(" %02X", *pages);
+        else
+          printf(" %s", "XX");
+      }
+
+        // left padding
+      for (unsigned j = 0; j < nm->GetConfig().PadBytes_; count++, j++)
+      {
+        if (count >= width)
+        {
+          printf("\n");
+          count = 0;
+        }
+        printf(" %02X", *pages++);
+      }
+
+        // possible next pointer (zero it out)
+      for (unsigned j = 0; j < sizeof(void *); count++, pages++, j++)
+      {
+        if (count >= width)
+        {
+          printf("\n");
+          count = 0;
+        }
+        if (SHOWREAL)
+          printf(" %02X", *pages);
+        else
+          printf(" %s", "XX");
+      }
+        
+        // remaining bytes
+      for (unsigned j = 0; j < nm->GetStats().ObjectSize_ - sizeof(void *); count++, j++)
+      {
+        if (count >= width)
+        {
+          printf("\n");
+          count = 0;
+        }
+        printf(" %02X", *pages++);
+      }
+
+        // right pad bytes
+      for (unsigned j = 0; j < nm->GetConfig().PadBytes_; count++, j++)
+      {
+        if (count >= width)
+        {
+          printf("\n");
+
+
+
+          count = 0;
+        }
+        printf(" %02X", *pages++);
+      }
+
+    }
+    printf("\n");
+    DumpExternalHeaders(nm, realpage);
+    printf("\n");
+
+    pages = reinterpret_cast<const unsigned char *>((reinterpret_cast<const GenericObject *>(realpage))->Next);
+    realpage = pages;
+  }
+}
+
+void Test1(void)
+{
+  ObjectAllocator *oa;
+    
+    bool newdel = false;
+    bool debug = false;
+    unsigned padbytes = 0;
+    OAConfig::HeaderBlockInfo header(OAConfig::hbExternal);
+    unsigned alignment = 0;
+
+    OAConfig config(newdel, 1, 1, debug, padbytes, header, alignment);
+    oa  = new ObjectAllocator(sizeof(Student), config);
+
+    oa->Allocate();
+
+    PrintConfig(oa);
+    PrintCounts(oa);
+    DumpPagesEx(oa, 32);
+
+    delete oa;
+}
+
+
+int main(int argc, char **argv)
+{
+#ifdef _MSC_VER
+    _CrtSetDbgFlag ( _CRTDBG_ALLOC_MEM_DF | _CRTDBG_LEAK_CHECK_DF );
+    _CrtSetReportMode(_CRT_WARN, _CRTDBG_MODE_FILE);
+    _CrtSetReportFile(_CRT_WARN, _CRTDBG_FILE_STDERR);
+#endif
+
+  int test = 0;
+
+  if (argc > 1)
+    test = std::atoi(argv[1]);
+  if (argc > 2)
+    SHOWADDRESS1 = std::atoi(argv[2]);
+  if (argc > 3)
+    SHOWADDRESS2 = std::atoi(argv[3]);
+  if (argc > 4)
+    SHOWREAL = std::atoi(argv[4]);
+  if (argc > 5)
+    SHOW_EXCEPTIONS = std::atoi(argv[5]);
+  if (argc > 6)
+    EXTRA_CREDIT = std::atoi(argv[6]);
+
+  switch (test)
+  {
+    case 1:
+      cout << "============================== Students..." << endl;
+      DoStudents(0, false);
+      cout << endl;
+      break;
+    case 2:
+      cout << "============================== Students..." << endl;
+      DoStudents(0, true);
+      cout << endl;
+      break;
+    case 3:
+      cout << "============================== Employees..." << endl;
+      DoEmployees();
+      cout << endl;
+      break;
+    case 4:
+      cout << "============================== Test padding..." << endl;
+      TestPadding(6);
+      cout << endl;
+      break;
+    case 5:
+      cout << "============================== Test padding..." << endl;
+      TestPadding(10);
+      cout << endl;
+      break;
+    case 6:
+      cout << "============================== Test basic header blocks..." << endl;
+      TestBasicHeaderBlocks();
+      cout << endl;
+      break;
+    case 7:
+      cout << "============================== Test extended header blocks(1)..." << endl;
+      TestExtendedHeaderBlocks(1);
+      cout << endl;
+      break;
+    case 8:
+      cout << "============================== Test external header blocks..." << endl;
+      TestExternalHeaderBlocks();
+      cout << endl;
+      break;
+    case 9:
+      cout << "============================== Test corruption..." << endl;
+      TestCorruption();
+      cout << endl;
+      break;
+    case 10:
+      cout << "============================== Test using new/delete..." << endl;
+      DisableOA();
+      cout << endl;
+      break;
+    case 11:
+      cout << "============================== Test leak..." << endl;
+      TestLeak(); 
+      cout << endl;
+      break;
+    case 12:
+      cout << "============================== Test validate..." << endl;
+      TestValidate();
+      cout << endl;
+      break;
+    case 13:
+      cout << "============================== Test free checking basic (stress)..." << endl;
+      StressFreeChecking(OAConfig::HeaderBlockInfo(OAConfig::hbBasic));
+      cout << endl;
+      break;
+    case 14:
+      cout<< "============================== Test free checking extended (stress)..." << endl;
+      StressFreeChecking(OAConfig::HeaderBlockInfo(OAConfig::hbExtended, 1));
+      cout << endl;
+      break;
+    case 15:
+      cout << "============================== Test free checking external (stress)..." << endl;
+      StressFreeChecking(OAConfig::HeaderBlockInfo(OAConfig::hbExternal));
+      cout << endl;
+      break;
+    case 16:
+      cout << "============================== Test stress using new/delete..." << endl;
+      Stress(true);
+      cout << endl;
+      break;
+    case 17:
+      cout << "============================== Test stress using allocator..." << endl;
+      Stress(false);
+      cout << endl;
+      break;
+    case 18:
+      cout << "============================== Test alignment..." << endl;
+      TestAlignment();
+      cout << endl;
+      break;
+    case 19:
+      cout << "============================== Test free empty pages 1..." << endl;
+      TestFreeEmptyPages1(); 
+      cout << endl;
+      break;
+    case 20:
+      cout << "============================== Test free empty pages 2..." << endl;
+      TestFreeEmptyPages2(); 
+      cout << endl;
+      break;
+    case 21:
+      cout << "============================== Test free empty pages 3..." << endl;
+      TestFreeEmptyPages4(); 
+      cout << endl;
+      break;
+    case 22:
+      cout << "============================== Test thread cache..." << endl;
+      TestThreadCache(); 
+      cout << endl;
+      break;
+    case 23:
+      cout << "============================== Test lock-free free list..." << endl;
+      TestLockFree(); 
+      cout << endl;
+      break;
+    case 24:
+      cout << "============================== Test batch allocate/free..." << endl;
+      TestBatches(); 
+      cout << endl;
+      break;
+    case 25:
+      cout << "============================== Test size classes..." << endl;
+      TestSizeClasses(); 
+      cout << endl;
+      break;
+    case 26:
+      cout << "============================== Test object pool..." << endl;
+      TestObjectPool(); 
+      cout << endl;
+      break;
+    case 27:
+      cout << "============================== Test page sources..." << endl;
+      TestPageSources(); 
+      cout << endl;
+      break;
+    case 28:
+      cout << "============================== Test growth policy..." << endl;
+      TestGrowthPolicy(); 
+      cout << endl;
+      break;
+    case 29:
+      cout << "============================== Test external header records..." << endl;
+      TestExternalRecords(); 
+      cout << endl;
+      break;
+    case 30:
+      cout << "============================== Test lazy pages..." << endl;
+      TestLazyPages(); 
+      cout << endl;
+      break;
+    case 31:
+      cout << "============================== Test instrumentation..." << endl;
+      TestInstrumentation(); 
+      cout << endl;
+      break;
+    case 32:
+      cout << "============================== Test page occupancy..." << endl;
+      TestOccupancy(); 
+      cout << endl;
+      break;
+    case 33:
+      cout << "============================== Test parallel sweeps..." << endl;
+      TestParallelSweeps(); 
+      cout << endl;
+      break;
+    case 34:
+      cout << "============================== Test incremental validation..." << endl;
+      TestIncrementalValidation(); 
+      cout << endl;
+      break;
+    case 35:
+      cout << "============================== Test sampled guards..." << endl;
+      TestSampledGuards(); 
+      cout << endl;
+      break;
+    case 36:
+      cout << "============================== Test pad kernels..." << endl;
+      TestPadKernels(); 
+      cout << endl;
+      break;
+    case 37:
+      cout << "============================== Test page-affine allocation..." << endl;
+      TestPageAffinity(); 
+      cout << endl;
+      break;
+    case 38:
+      cout << "============================== Test bitmap blocks..." << endl;
+      TestBitmapBlocks(); 
+      cout << endl;
+      break;
+    case 39:
+      cout << "============================== Test ReleaseAll..." << endl;
+      TestReleaseAll(); 
+      cout << endl;
+      break;
+    case 40:
+      cout << "============================== Test Reserve and unlimited pages..." << endl;
+      TestReserve(); 
+      cout << endl;
+      break;
+    case 41:
+      cout << "============================== Test NUMA page pools..." << endl;
+      TestNumaPools(); 
+      cout << endl;
+      break;
+    case 42:
+      cout << "============================== Test deferred frees..." << endl;
+      TestDeferredFrees(); 
+      cout << endl;
+      break;
+    case 43:
+      cout << "============================== Test moves and the STL adapter..." << endl;
+      TestMoveAndPoolAllocator(); 
+      cout << endl;
+      break;
+    case 44:
+      cout << "============================== Test compact allocator..." << endl;
+      TestCompactAllocator(); 
+      cout << endl;
+      break;
+    case 45:
+      cout << "============================== Test trace recording..." << endl;
+      TestTraceRecording(); 
+      cout << endl;
+      break;
+    default:
+      cout << "============================== Students..." << endl;
+      DoStudents(0, false);
+      cout << endl;
+      cout << "============================== Students..." << endl;
+      DoStudents(0, true);
+      cout << endl;
+      cout << "============================== Employees..." << endl;
+      DoEmployees();
+      cout << endl;
+      cout << "============================== Test padding..." << endl;
+      TestPadding(6);
+      cout << endl;
+      cout << "============================== Test padding..." << endl;
+      TestPadding(10);
+      cout << endl;
+      cout << "============================== Test basic header blocks..." << endl;
+      TestBasicHeaderBlocks();
+      cout << endl;
+      cout << "============================== Test extended header blocks(1)..." << endl;
+      TestExtendedHeaderBlocks(1);
+      cout << endl;
+      cout << "============================== Test external header blocks..." << endl;
+      TestExternalHeaderBlocks();
+      cout << endl;
+      cout << "============================== Test corruption..." << endl;
+      TestCorruption();
+      cout << endl;
+      cout << "============================== Test using new/delete..." << endl;
+      DisableOA();
+      cout << endl;
+      cout << "============================== Test leak..." << endl;
+      TestLeak(); 
+      cout << endl;
+      cout << "============================== Test validate..." << endl;
+      TestValidate();
+      cout << endl;
+      cout << "============================== Test free checking basic (stress)..." << endl;
+      StressFreeChecking(OAConfig::HeaderBlockInfo(OAConfig::hbBasic));
+      cout << endl;
+      cout<< "============================== Test free checking extended (stress)..." << endl;
+      StressFreeChecking(OAConfig::HeaderBlockInfo(OAConfig::hbExtended, 1));
+      cout << endl;
+      cout << "============================== Test free checking external (stress)..." << endl;
+      StressFreeChecking(OAConfig::HeaderBlockInfo(OAConfig::hbExternal));
+      cout << endl;
+      cout << "============================== Test stress using new/delete..." << endl;
+      Stress(true);
+      cout << endl;
+      cout << "============================== Test stress using allocator..." << endl;
+      Stress(false);
+      cout << endl;
+      if (EXTRA_CREDIT)
+      {
+        cout << "============================== Test alignment..." << endl;
+        TestAlignment();
+        cout << endl;
+        cout << "============================== Test free empty pages 1..." << endl;
+        TestFreeEmptyPages1(); 
+        cout << endl;
+        cout << "============================== Test free empty pages 2..." << endl;
+        TestFreeEmptyPages2(); 
+        cout << endl;
+        cout << "============================== Test free empty pages 3..." << endl;
+        TestFreeEmptyPages3(); 
+        cout << endl;
+      }
+      break;
+  }
+
+  //OAConfig config(false, 16, 4, false);
+  //ObjectAllocator a(sizeof(Student), config);
+  //ObjectAllocator b(sizeof(Student), config);
+    // These should fail to compile:
+  //ObjectAllocator c(a);
+  //a = b;
+  
+
+  return 0;
+}
@@ -0,0 +1,109 @@
+// Pad-byte kernel benchmarks
+//
+//   make padbench PRG=padbench        (-O2, or BENCHOPT=-O3)
+//   ./padbench [regions]
+//
+// Times each PadKernels kernel this CPU supports checking pad regions of
+// a range of sizes (all of them intact, the way ValidatePages finds them
+// in a healthy heap), then filling them, with memset alongside the fills.
+// Every region sits at a different alignment, as pads do between blocks.
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+#include <chrono>
+
+#include "ObjectAllocator.h"
+#include "PadKernels.h"
+
+using std::printf;
+
+typedef std::chrono::steady_clock Clock;
+
+// nanoseconds per region for fn over every region of the buffer
+template <typename Fn>
+double TimeRegions(unsigned regions, size_t stride, Fn fn)
+{
+  Clock::time_point start = Clock::now();
+  for (unsigned i = 0; i < regions; i++)
+    fn(i * stride);
+  double ns = std::chrono::duration<double, std::nano>(Clock::now() - start).count();
+  return ns / regions;
+}
+
+int main(int argc, char **argv)
+{
+  unsigned regions = 1000000;
+  if (argc > 1)
+    regions = static_cast<unsigned>(std::atoi(argv[1]));
+
+  const size_t sizes[] = {2, 8, 16, 32, 64, 256};
+  const PadKernels::KERNEL_TYPE kernels[] = {PadKernels::kScalar, PadKernels::kSSE2,
+                                             PadKernels::kAVX2, PadKernels::kNEON};
+  const unsigned char pattern = ObjectAllocator::PAD_PATTERN;
+
+  printf("regions: %u, Matches and Fill use %s\n", regions, PadKernels::Name(PadKernels::Active()));
+
+  unsigned failures = 0;
+  for (unsigned fills = 0; fills < 2; fills++)
+  {
+    printf("%-8s", fills ? "fill" : "match");
+    for (unsigned k = 0; k < 4; k++)
+      if (PadKernels::Supported(kernels[k]))
+        printf(" %9s", PadKernels::Name(kernels[k]));
+    printf(" %9s", fills ? "Fill" : "Matches");
+    if (fills)
+      printf(" %9s", "memset");
+    printf("\n");
+
+    for (unsigned s = 0; s < sizeof(sizes) / sizeof(*sizes); s++)
+    {
+        // an odd stride walks the regions through every alignment
+      size_t size = sizes[s];
+      size_t stride = size + 7;
+      std::vector<unsigned char> buffer(stride * regions + size, pattern);
+      unsigned char *base = &buffer[0];
+
+      printf("%-8u", static_cast<unsigned>(size));
+      for (unsigned k = 0; k < 4; k++)
+      {
+        if (!PadKernels::Supported(kernels[k]))
+          continue;
+        double ns = fills
+          ? TimeRegions(regions, stride, [&](size_t offset) {
+              PadKernels::FillWith(kernels[k], base + offset, size, pattern);
+            })
+          : TimeRegions(regions, stride, [&](size_t offset) {
+              failures += !PadKernels::MatchesWith(kernels[k], base + offset, size, pattern);
+            });
+        printf(" %9.2f", ns);
+      }
+
+      if (!fills)
+      {
+        printf(" %9.2f\n", TimeRegions(regions, stride, [&](size_t offset) {
+          failures += !PadKernels::Matches(base + offset, size, pattern);
+        }));
+        continue;
+      }
+
+      double fill = TimeRegions(regions, stride, [&](size_t offset) {
+        PadKernels::Fill(base + offset, size, pattern);
+      });
+      double libc = TimeRegions(regions, stride, [&](size_t offset) {
+        std::memset(base + offset, pattern, size);
+      });
+      printf(" %9.2f %9.2f\n", fill, libc);
+
+        // the fills wrote the pattern over itself, so it must still be there
+      failures += !PadKernels::Matches(base, buffer.size(), pattern);
+    }
+  }
+
+  // every region is intact, so a kernel that says otherwise is broken
+  if (failures)
+    printf("%u regions wrongly reported corrupted\n", failures);
+  printf("(ns per region)\n");
+  return failures != 0;
+}
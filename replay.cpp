@@ -0,0 +1,310 @@
+// Replays an allocation trace (see OATrace.h and ObjectAllocator::SetTrace)
+//
+//   make replay PRG=replay            (-O2, or BENCHOPT=-O3)
+//   ./replay trace [options]
+//
+//   -n         use new/delete (UseCPPMemManager_)
+//   -d         debug on (signatures and checks)
+//   -h type    header: none, basic, extended or external
+//   -o count   objects per page (default 1024)
+//   -m count   max pages (default 0, unlimited)
+//   -p bytes   pad bytes
+//   -a bytes   alignment
+//   -x         lock-free
+//   -l         lazy pages
+//   -f         page-affine
+//   -b         bitmap blocks
+//   -s rate    sample 1 in rate blocks for guarding
+//   -r count   rounds (default 10)
+//
+// The trace is decoded up front, then replayed once untimed to warm up
+// and rounds times for throughput, through a new allocator each time.
+// Pages are only given back by FreeEmptyPages, which a replay never
+// calls, so PagesInUse_ at the end of a round is its peak. The cache
+// counters (Linux perf events, user space only) cover the timed rounds;
+// they show n/a where perf events aren't allowed.
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+#include <chrono>
+
+#include "ObjectAllocator.h"
+#include "OATrace.h"
+
+#if defined(__linux__)
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#define HAVE_PERF_EVENTS 1
+#else
+#define HAVE_PERF_EVENTS 0
+#endif
+
+using std::printf;
+
+typedef std::chrono::steady_clock Clock;
+
+// What a CacheCounter counts
+enum COUNTER_TYPE {ctReferences, ctMisses, ctL1Misses};
+
+// One hardware counter, or nothing where perf events aren't allowed
+class CacheCounter
+{
+  public:
+    explicit CacheCounter(COUNTER_TYPE counter) : fd(-1)
+    {
+#if HAVE_PERF_EVENTS
+      perf_event_attr attr;
+      std::memset(&attr, 0, sizeof(attr));
+      attr.size = sizeof(attr);
+      attr.type = counter == ctL1Misses ? PERF_TYPE_HW_CACHE : PERF_TYPE_HARDWARE;
+      attr.config = counter == ctReferences ? PERF_COUNT_HW_CACHE_REFERENCES :
+                    counter == ctMisses ? PERF_COUNT_HW_CACHE_MISSES :
+                    PERF_COUNT_HW_CACHE_L1D | (PERF_COUNT_HW_CACHE_OP_READ << 8) |
+                    (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+      attr.disabled = 1;
+      attr.exclude_kernel = 1;
+      attr.exclude_hv = 1;
+      fd = static_cast<int>(syscall(__NR_perf_event_open, &attr, 0, -1, -1, 0));
+#else
+      (void)counter;
+#endif
+    }
+
+    ~CacheCounter()
+    {
+#if HAVE_PERF_EVENTS
+      if (fd >= 0)
+        close(fd);
+#endif
+    }
+
+    void start(void)
+    {
+#if HAVE_PERF_EVENTS
+      if (fd >= 0)
+      {
+        ioctl(fd, PERF_EVENT_IOC_RESET, 0);
+        ioctl(fd, PERF_EVENT_IOC_ENABLE, 0);
+      }
+#endif
+    }
+
+    void stop(void)
+    {
+#if HAVE_PERF_EVENTS
+      if (fd >= 0)
+        ioctl(fd, PERF_EVENT_IOC_DISABLE, 0);
+#endif
+    }
+
+      // the count so far (-1 if there's no counter)
+    long long value(void) const
+    {
+      long long count = -1;
+#if HAVE_PERF_EVENTS
+      if (fd < 0 || read(fd, &count, sizeof(count)) != static_cast<ssize_t>(sizeof(count)))
+        count = -1;
+#endif
+      return count;
+    }
+
+  private:
+    int fd;
+
+    CacheCounter(const CacheCounter &);
+    CacheCounter &operator=(const CacheCounter &);
+};
+
+// What a round of the replay found
+struct RoundResult
+{
+  unsigned pages;      // PagesInUse_ at the end (the peak)
+  unsigned mostInUse;  // most blocks live at once
+};
+
+// Feeds every event through a new allocator
+RoundResult Replay(const std::vector<OATraceEvent> &events, unsigned ids, size_t size,
+                   const OAConfig &config)
+{
+  ObjectAllocator oa(size, config);
+  std::vector<void *> live(ids, 0);
+  unsigned inUse = 0;
+  RoundResult result = {0, 0};
+
+  for (size_t i = 0; i < events.size(); i++)
+  {
+    const OATraceEvent &event = events[i];
+    switch (event.type)
+    {
+      case teAllocate:
+        live[event.id] = oa.Allocate(event.label);
+        if (++inUse > result.mostInUse)
+          result.mostInUse = inUse;
+        break;
+      case teFree:
+        oa.Free(live[event.id]);
+        live[event.id] = 0;
+        inUse--;
+        break;
+      case teReleaseAll:
+          // new/delete keeps no pages to take back, so those are freed one by one
+        for (size_t id = 0; config.UseCPPMemManager_ && id < live.size(); id++)
+          if (live[id])
+            oa.Free(live[id]);
+        oa.ReleaseAll();
+        live.assign(live.size(), 0);
+        inUse = 0;
+        break;
+      default:
+        break;
+    }
+  }
+
+  result.pages = oa.GetStats().PagesInUse_;
+  for (size_t id = 0; id < live.size(); id++)
+    if (live[id])
+      oa.Free(live[id]);
+  return result;
+}
+
+// the value of an option that takes one (0 if it's missing)
+const char *OptionValue(int argc, char **argv, int &i)
+{
+  return i + 1 < argc ? argv[++i] : 0;
+}
+
+int main(int argc, char **argv)
+{
+  if (argc < 2)
+  {
+    printf("usage: %s trace [-n] [-d] [-h none|basic|extended|external] [-o objects] [-m pages]\n"
+           "       [-p pad] [-a alignment] [-x] [-l] [-f] [-b] [-s rate] [-r rounds]\n", argv[0]);
+    return 1;
+  }
+
+  bool newdel = false, debug = false, lockFree = false, lazy = false, affine = false, bitmap = false;
+  unsigned objectsPerPage = 1024, maxPages = 0, padBytes = 0, alignment = 0, sampleRate = 0;
+  unsigned rounds = 10;
+  OAConfig::HBLOCK_TYPE header = OAConfig::hbNone;
+  const char *headerName = "none";
+
+  for (int i = 2; i < argc; i++)
+  {
+    const char *option = argv[i];
+    const char *value = 0;
+    if (!std::strcmp(option, "-n"))
+      newdel = true;
+    else if (!std::strcmp(option, "-d"))
+      debug = true;
+    else if (!std::strcmp(option, "-x"))
+      lockFree = true;
+    else if (!std::strcmp(option, "-l"))
+      lazy = true;
+    else if (!std::strcmp(option, "-f"))
+      affine = true;
+    else if (!std::strcmp(option, "-b"))
+      bitmap = true;
+    else if ((value = OptionValue(argc, argv, i)) == 0)
+    {
+      printf("%s needs a value\n", option);
+      return 1;
+    }
+    else if (!std::strcmp(option, "-h"))
+    {
+      const char *names[] = {"none", "basic", "extended", "external"};
+      const OAConfig::HBLOCK_TYPE types[] = {OAConfig::hbNone, OAConfig::hbBasic,
+                                             OAConfig::hbExtended, OAConfig::hbExternal};
+      for (unsigned h = 0; h < 4; h++)
+        if (!std::strcmp(value, names[h]))
+        {
+          header = types[h];
+          headerName = names[h];
+        }
+    }
+    else
+    {
+      unsigned number = static_cast<unsigned>(std::atoi(value));
+      switch (option[1])
+      {
+        case 'o': objectsPerPage = number; break;
+        case 'm': maxPages = number; break;
+        case 'p': padBytes = number; break;
+        case 'a': alignment = number; break;
+        case 's': sampleRate = number; break;
+        case 'r': rounds = number ? number : 1; break;
+        default:
+          printf("unknown option %s\n", option);
+          return 1;
+      }
+    }
+  }
+
+  OATraceReader reader(argv[1]);
+  if (!reader.IsOpen())
+  {
+    printf("%s is not a trace\n", argv[1]);
+    return 1;
+  }
+
+    // decoded up front so the timing is only the allocator
+  std::vector<OATraceEvent> events;
+  OATraceEvent event;
+  unsigned allocations = 0;
+  while (reader.Next(event))
+  {
+    events.push_back(event);
+    allocations += event.type == teAllocate;
+  }
+
+  OAConfig config(newdel, objectsPerPage, maxPages, debug, padBytes,
+                  OAConfig::HeaderBlockInfo(header, header == OAConfig::hbExtended ? 4 : 0),
+                  alignment, lockFree, 0, OAConfig::GrowthPolicy(), lazy, sampleRate, affine, bitmap);
+  size_t size = reader.ObjectSize();
+
+  printf("trace: %s, %u events (%u allocations), object size %u\n", argv[1],
+         static_cast<unsigned>(events.size()), allocations, static_cast<unsigned>(size));
+  printf("config: %s, header %s, %u per page, debug %s%s%s%s%s\n", newdel ? "new/delete" : "oa",
+         headerName, objectsPerPage, debug ? "on" : "off", lockFree ? ", lock-free" : "",
+         lazy ? ", lazy" : "", affine ? ", page-affine" : "", bitmap ? ", bitmap" : "");
+
+  try
+  {
+    RoundResult result = Replay(events, reader.IdCount(), size, config);
+
+    CacheCounter references(ctReferences), misses(ctMisses), l1Misses(ctL1Misses);
+    CacheCounter *counters[] = {&references, &misses, &l1Misses};
+
+    for (unsigned c = 0; c < 3; c++)
+      counters[c]->start();
+    Clock::time_point start = Clock::now();
+    for (unsigned round = 0; round < rounds; round++)
+      Replay(events, reader.IdCount(), size, config);
+    double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+    for (unsigned c = 0; c < 3; c++)
+      counters[c]->stop();
+
+    double calls = static_cast<double>(events.size()) * rounds;
+    printf("throughput: %.2f Mops/s over %u rounds\n", calls / seconds / 1e6, rounds);
+    printf("peak: %u pages, %u blocks in use\n", result.pages, result.mostInUse);
+
+    const char *names[] = {"cache references", "cache misses", "L1D read misses"};
+    for (unsigned c = 0; c < 3; c++)
+    {
+      long long count = counters[c]->value();
+      if (count < 0)
+        printf("%s: n/a\n", names[c]);
+      else
+        printf("%s: %lld (%.3f per call)\n", names[c], count, static_cast<double>(count) / calls);
+    }
+  }
+  catch (const OAException &e)
+  {
+    printf("replay failed: %s\n", e.what());
+    return 1;
+  }
+  return 0;
+}